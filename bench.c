@@ -0,0 +1,308 @@
+// Scenario benchmarks for the update and draw hot paths.
+//
+// Builds natively against headless/orca.h, sets up specific board states and
+// times solitaire_update (one SIM_STEP via solitaire_simulate_step) and
+// solitaire_draw separately for many frames. Results are written as one JSON
+// object per scenario per line so runs from two builds can be diffed.
+//
+// usage: bench [frames] [output.jsonl]
+
+#include "solitaire.c"
+
+#define BENCH_DEFAULT_FRAMES 2000
+#define BENCH_CACHE_LINE 64
+
+typedef struct {
+	const char *name;
+	void (*setup)(GameState *game);
+	void (*before_frame)(GameState *game, i32 frame); // feeds input, may be NULL
+} BenchScenario;
+
+typedef struct {
+	f64 mean, p50, p90, p99, max;
+} BenchTimes;
+
+static GameState bench_snapshot;
+
+static f64 bench_now(void) {
+	return oc_clock_time(OC_CLOCK_MONOTONIC) * 1e6; // microseconds
+}
+
+static int bench_compare_f64(const void *a, const void *b) {
+	f64 x = *(const f64*)a;
+	f64 y = *(const f64*)b;
+	return (x > y) - (x < y);
+}
+
+static BenchTimes bench_summarize(f64 *samples, i32 count) {
+	BenchTimes result = {0};
+	if (count == 0) return result;
+	f64 total = 0;
+	for (i32 i=0; i<count; ++i) total += samples[i];
+	qsort(samples, count, sizeof(f64), bench_compare_f64);
+	result.mean = total / count;
+	result.p50 = samples[(i32)(0.50 * (count - 1))];
+	result.p90 = samples[(i32)(0.90 * (count - 1))];
+	result.p99 = samples[(i32)(0.99 * (count - 1))];
+	result.max = samples[count - 1];
+	return result;
+}
+
+// number of cache lines of GameState written since the snapshot was taken
+static u64 bench_dirty_lines(GameState *game) {
+	u8 *before = (u8*)&bench_snapshot;
+	u8 *after = (u8*)game;
+	u64 dirty = 0;
+	for (u64 offset=0; offset<sizeof(GameState); offset+=BENCH_CACHE_LINE) {
+		u64 size = sizeof(GameState) - offset;
+		if (size > BENCH_CACHE_LINE) size = BENCH_CACHE_LINE;
+		if (memcmp(before + offset, after + offset, size) != 0) {
+			++dirty;
+		}
+	}
+	return dirty;
+}
+
+//------------------------------------------------------------------------------
+// board setups
+//------------------------------------------------------------------------------
+static void bench_clear_board(GameState *game) {
+	game_reset(game);
+	oc_list_init(&game->stock.cards);
+	oc_list_init(&game->waste.cards);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		oc_list_init(&game->foundations[i].cards);
+	}
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		oc_list_init(&game->tableau[i].cards);
+	}
+	game->card_dragging = NULL;
+	game->state = STATE_PLAY;
+}
+
+static void bench_settle(GameState *game) {
+	for (i32 i=0; i<10000 && game->state == STATE_DEALING; ++i) {
+		solitaire_simulate_step(game);
+	}
+	for (i32 i=0; i<600; ++i) {
+		solitaire_simulate_step(game);
+	}
+}
+
+static void bench_fill_foundations(GameState *game) {
+	bench_clear_board(game);
+	for (i32 suit=0; suit < SUIT_COUNT; ++suit)
+	for (i32 kind=0; kind < CARD_KIND_COUNT; ++kind) {
+		Card *card = &game->cards[suit * CARD_KIND_COUNT + kind];
+		memset(card, 0, sizeof(*card));
+		card->suit = suit;
+		card->kind = kind;
+		card->face_up = true;
+		pile_push(game, &game->foundations[suit], card, true);
+	}
+}
+
+static void setup_fresh_deal(GameState *game) {
+	game_reset(game);
+	bench_settle(game);
+}
+
+static void setup_drag_run(GameState *game) {
+	bench_clear_board(game);
+	test_deal_for_autocomplete(game, game->cards, ARRAY_COUNT(game->cards));
+	game->state = STATE_PLAY;
+	bench_settle(game);
+
+	// grab the king at the bottom of the 13 card run on tableau[0]
+	Card *king = oc_list_last_entry(game->tableau[0].cards, Card, node);
+	f32 x = king->pos.x + 0.5f * game->card_width;
+	f32 y = king->pos.y + 5;
+	oc_on_mouse_move(x, y, 0, 0);
+	oc_on_mouse_down(OC_MOUSE_LEFT);
+	solitaire_simulate_step(game);
+}
+
+static void frame_drag_run(GameState *game, i32 frame) {
+	// sweep the run back and forth across the whole board
+	f32 t = (f32)frame / 120.0f;
+	f32 x = 0.5f * game->frame_size.x + 0.4f * game->frame_size.x * sinf(t * 3.0f);
+	f32 y = 0.4f * game->frame_size.y + 0.2f * game->frame_size.y * cosf(t * 2.0f);
+	oc_on_mouse_move(x, y, 0, 0);
+}
+
+static void setup_waste_draw_three(GameState *game) {
+	game->draw_three_mode = true;
+	game_reset(game);
+	bench_settle(game);
+	while (!oc_list_empty(game->stock.cards)) {
+		Card *card = pile_peek_top(&game->stock);
+		card->face_up = true;
+		pile_transfer(game, &game->waste, card, true);
+	}
+	bench_settle(game);
+	oc_on_mouse_move(game->waste.pos.x + 10, game->waste.pos.y + 10, 0, 0);
+}
+
+static void setup_full_foundations(GameState *game) {
+	bench_fill_foundations(game);
+	bench_settle(game);
+}
+
+static void setup_autocomplete(GameState *game) {
+	bench_clear_board(game);
+	test_deal_for_autocomplete(game, game->cards, ARRAY_COUNT(game->cards));
+	start_autocomplete_sequence(game, false);
+}
+
+static void frame_autocomplete(GameState *game, i32 frame) {
+	if (game->state != STATE_AUTOCOMPLETE) {
+		setup_autocomplete(game);
+	}
+}
+
+static void setup_win_animation(GameState *game) {
+	bench_fill_foundations(game);
+	game->state = STATE_WIN;
+	while (game->win_card_path.count < 4000) {
+		solitaire_simulate_step(game);
+	}
+}
+
+static BenchScenario bench_scenarios[] = {
+	{ "fresh_deal",        setup_fresh_deal,       NULL },
+	{ "drag_13_card_run",  setup_drag_run,         frame_drag_run },
+	{ "draw3_waste_24",    setup_waste_draw_three, NULL },
+	{ "full_foundations",  setup_full_foundations, NULL },
+	{ "autocomplete",      setup_autocomplete,     frame_autocomplete },
+	{ "win_animation",     setup_win_animation,    NULL },
+};
+
+//------------------------------------------------------------------------------
+// runner
+//------------------------------------------------------------------------------
+static void bench_write_times(FILE *out, const char *name, BenchTimes t) {
+	fprintf(out, "\"%s\":{\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+		name, t.mean, t.p50, t.p90, t.p99, t.max);
+}
+
+static void bench_run(GameState *game, BenchScenario *scenario, i32 frames, FILE *out) {
+	// setups may switch the draw mode, it is put back once the scenario is done
+	bool draw_three = game->draw_three_mode;
+	pcg32_seed(&game->rng, 0x5eed);
+	scenario->setup(game);
+	game->latency_count = 0;
+	game->latency_pending_time = 0;
+	memset(game->latency_histogram, 0, sizeof(game->latency_histogram));
+
+	f64 *update_us = malloc(frames * sizeof(f64));
+	f64 *draw_us = malloc(frames * sizeof(f64));
+	u64 dirty_lines_total = 0, dirty_lines_max = 0;
+	HeadlessStats stats_before = headless.stats;
+	DrawStats draw_stats_total = {0};
+	DrawRecordStats record_total = {0};
+
+	for (i32 frame=0; frame<frames; ++frame) {
+		if (scenario->before_frame) {
+			scenario->before_frame(game, frame);
+		}
+
+		memcpy(&bench_snapshot, game, sizeof(GameState));
+
+		f64 start = bench_now();
+		solitaire_simulate_step(game);
+		f64 mid = bench_now();
+		solitaire_draw(game);
+		f64 end = bench_now();
+
+		update_us[frame] = mid - start;
+		draw_us[frame] = end - mid;
+
+		u64 dirty = bench_dirty_lines(game);
+		dirty_lines_total += dirty;
+		if (dirty > dirty_lines_max) dirty_lines_max = dirty;
+
+		draw_stats_total.items += game->draw_stats.items;
+		draw_stats_total.batches += game->draw_stats.batches;
+		draw_stats_total.image_switches += game->draw_stats.image_switches;
+		draw_stats_total.image_switches_unbatched += game->draw_stats.image_switches_unbatched;
+
+		DrawRecordStats record = draw_record_stats(game);
+		record_total.commands += record.commands;
+		record_total.image_switches += record.image_switches;
+		record_total.covered_area += record.covered_area;
+		record_total.union_area += record.union_area;
+		for (i32 i=0; i<DRAW_COMMAND_KIND_COUNT; ++i) {
+			record_total.by_kind[i] += record.by_kind[i];
+		}
+	}
+
+	HeadlessStats s = headless.stats;
+	f64 n = frames;
+	fprintf(out, "{\"scenario\":\"%s\",\"frames\":%d,", scenario->name, frames);
+	bench_write_times(out, "update_us", bench_summarize(update_us, frames));
+	fputc(',', out);
+	bench_write_times(out, "draw_us", bench_summarize(draw_us, frames));
+	fprintf(out, ",\"draw_calls\":{\"image\":%.2f,\"image_region\":%.2f,\"stroke\":%.2f,\"fill\":%.2f,\"text\":%.2f,\"image_switches\":%.2f}",
+		(s.image_draws - stats_before.image_draws) / n,
+		(s.image_region_draws - stats_before.image_region_draws) / n,
+		(s.strokes - stats_before.strokes) / n,
+		(s.fills - stats_before.fills) / n,
+		(s.texts - stats_before.texts) / n,
+		(s.image_switches - stats_before.image_switches) / n);
+	fprintf(out, ",\"draw_list\":{\"items\":%.2f,\"batches\":%.2f,\"image_switches\":%.2f,\"image_switches_unbatched\":%.2f}",
+		draw_stats_total.items / n,
+		draw_stats_total.batches / n,
+		draw_stats_total.image_switches / n,
+		draw_stats_total.image_switches_unbatched / n);
+	fprintf(out, ",\"draw_record\":{\"commands\":%.2f,\"image_switches\":%.2f,\"covered_px\":%.0f,\"touched_px\":%.0f,\"overdraw\":%.2f",
+		record_total.commands / n, record_total.image_switches / n, record_total.covered_area / n, record_total.union_area / n,
+		record_total.union_area > 0 ? record_total.covered_area / record_total.union_area : 0.0);
+	for (i32 i=0; i<DRAW_COMMAND_KIND_COUNT; ++i) {
+		fprintf(out, ",\"%s\":%.2f", draw_command_keys[i], record_total.by_kind[i] / n);
+	}
+	fputc('}', out);
+	fprintf(out, ",\"input_latency_us\":{\"samples\":%u,\"p50\":%.0f,\"p99\":%.0f}",
+		game->latency_count, latency_percentile(game, 0.50), latency_percentile(game, 0.99));
+	fprintf(out, ",\"memory\":{\"state_bytes\":%llu,\"ui_context_bytes\":%llu,\"card_bytes\":%llu,\"card_array_lines\":%llu,\"dirty_bytes_mean\":%.1f,\"dirty_bytes_max\":%llu",
+		(u64)sizeof(GameState),
+		(u64)sizeof(ui_context),
+		(u64)sizeof(Card),
+		(u64)(sizeof(game->cards) + BENCH_CACHE_LINE - 1) / BENCH_CACHE_LINE,
+		(f64)(dirty_lines_total * BENCH_CACHE_LINE) / n,
+		dirty_lines_max * BENCH_CACHE_LINE);
+	for (i32 i=0; i<MEM_SUBSYSTEM_COUNT; ++i) {
+		fprintf(out, ",\"%s\":{\"live\":%llu,\"peak\":%llu}",
+			mem_subsystem_key(i), game->memory[i].live, game->memory[i].peak);
+	}
+	fprintf(out, "}}\n");
+	fflush(out);
+
+	free(update_us);
+	free(draw_us);
+	game->draw_three_mode = draw_three;
+}
+
+int main(int argc, char **argv) {
+	i32 frames = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_FRAMES;
+	if (frames <= 0) frames = BENCH_DEFAULT_FRAMES;
+	FILE *out = stdout;
+	if (argc > 2) {
+		out = fopen(argv[2], "w");
+		if (!out) {
+			fprintf(stderr, "could not open %s\n", argv[2]);
+			return 1;
+		}
+	}
+
+	headless.log_info = false;
+	oc_on_init();
+	GameState *game = &orca_game;
+	game->telemetry_enabled = false;
+
+	for (i32 i=0; i<ARRAY_COUNT(bench_scenarios); ++i) {
+		bench_run(game, &bench_scenarios[i], frames, out);
+	}
+
+	if (out != stdout) fclose(out);
+	return 0;
+}
@@ -7,6 +7,16 @@ set STDLIB_DIR=%ORCA_DIR%\src\libc-shim
 set "src_dir=%~dp0"
 set "src_dir=!src_dir:~0,-1!"
 
+if /I "%~1"=="bench" goto bench
+if /I "%~1"=="verify" goto verify
+if /I "%~1"=="dealgen" goto dealgen
+if /I "%~1"=="psolve" goto psolve
+if /I "%~1"=="rate" goto rate
+if /I "%~1"=="parfind" goto parfind
+if /I "%~1"=="sim" goto sim
+if /I "%~1"=="soak" goto soak
+if /I "%~1"=="render" goto render
+
 set wasm_flags=--target=wasm32^
    --no-standard-libraries ^
    -mbulk-memory ^
@@ -31,4 +41,67 @@ IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
 
 orca bundle --orca-dir %ORCA_DIR% --name Solitaire --icon icon.png --resource-dir "%src_dir%\data" module.wasm
 popd
+exit /B 0
+
+:bench
+rem native benchmark against the headless Orca stand-in, no runtime needed
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\bench.exe "%src_dir%\bench.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:verify
+rem native batch verifier for game records, same headless stand-in as bench
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\verify.exe "%src_dir%\verify.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
 
+:dealgen
+rem native solver run that writes the solvable deal tables in data
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\dealgen.exe "%src_dir%\dealgen.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:psolve
+rem native multithreaded solver for offline analysis
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\psolve.exe "%src_dir%\psolve.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:rate
+rem native deal difficulty rater that writes the easy, medium and hard tables in data
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\rate.exe "%src_dir%\rate.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:parfind
+rem native run of the par search with its statistics
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\parfind.exe "%src_dir%\parfind.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:sim
+rem native simulation of many boards on every core
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\sim.exe "%src_dir%\sim.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:soak
+rem native soak test, a bot plays through the input entry points at accelerated time
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\soak.exe "%src_dir%\soak.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
+
+:render
+rem native software rendering of board states to PNG, golden images and render timings
+if not exist build\ mkdir build
+clang -O2 -g -D_CRT_SECURE_NO_WARNINGS -I"%src_dir%\headless" -o build\render.exe "%src_dir%\render.c"
+IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
+exit /B 0
@@ -1,8 +1,65 @@
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(*(array)))
 #define CARD_ASPECT (560.0f/780.0f)
+#define GAME_DEFAULT_WIDTH 1000
+#define GAME_DEFAULT_HEIGHT 775
 #define STOCK_OFFSET_BETWEEN_CARDS 0.5
 #define MAX_DIST_CONSIDERED_CLICK 2.0f 
 #define GRAVITY 2000.0f
+#define SIM_STEP (1.0/60.0)
+#define SIM_MAX_STEPS_PER_FRAME 8
+#define SIM_MAX_FRAME_TIME 0.25
+#define DEAL_DELAY 0.1f
+#define DEAL_DURATION 0.4f
+#define CARD_ANIMATE_SPEED 25.0f
+#define DRAW_LIST_MAX 80 // 52 cards, 12 empty pile frames and the reload icon
+#define DRAW_RECORD_BLOCK 1024 // the win animation's card trail can be thousands of draws
+#define PILE_COUNT 13 // stock, waste, 4 foundations, 7 tableau
+#define WIN_MAX_FLYING_CARDS 16
+#define WIN_CARD_PATH_MAX 10000
+#define WIN_CARD_PATH_BLOCK 512
+#define UNDO_STACK_MAX 16384
+#define UNDO_STACK_BLOCK 512
+#define UNDO_NO_CARD 0xff
+#define BLOCK_ARRAY_MAX_BLOCKS 32
+#define INPUT_QUEUE_MAX 32
+#define NOTATION_BLOCK 256
+#define NOTATION_MAX_MOVE_TEXT 12 // " t7:13>t1" plus room to spare
+#define NOTATION_MIN_MOVE_TIME 0.1 // seconds, no player keeps up ten moves a second
+#define NOTATION_MAX_TIMER_STEPS ((100ull*60*60 - 1) * 60) // 99:59:59 in SIM_STEPs, the longest timer_string shows
+#define LATENCY_BUCKETS 24
+#define TRACE_EVENT_MAX (1 << 17) // 3MB, the last several seconds of frames
+#define TRACE_MAX_DEPTH 32
+#define TRACE_WRITE_CHUNK (64 << 10)
+#define TRACE_EVENT_TEXT_MAX 192 // one event as json, names are short literals
+#define DRAG_PREDICTION_HORIZON (1.0f/60.0f)
+#define TELEMETRY_THINK_BLOCK 256
+#define TELEMETRY_SCAN_CHUNK 1024
+#define TELEMETRY_MEDIAN_MAX_SECONDS 3600
+#define SOLVER_TABLEAU_MAX 19 // 6 face down cards under a king to ace run
+#define SOLVER_MAX_MOVES 128
+#define SOLVER_MAX_DEPTH 1024
+#define SOLVER_MAX_PATH 4096
+#define PAR_MAX_MOVES 512
+#define PAR_MEMORY_CAP (8 << 20)
+#define PAR_SEED_NODES 20000
+#define PAR_NODE_LIMIT 500000
+#define PAR_SLICE_SECONDS 0.002
+#define DEAL_TABLE_BLOCK 64
+#define TIMELINE_BLOCK 512
+#define TIMELINE_EPSILON 1e-4 // seconds, so items planned on a step boundary start on that step
+#define HISTORY_KEYFRAME_INTERVAL 16 // positions between full keyframes
+#define HISTORY_PILE_MAX 24 // the stock right after the deal
+#define HISTORY_POSITION_BLOCK 512
+#define HISTORY_CHANGE_BLOCK 2048
+#define HISTORY_KEYFRAME_BLOCK 64
+#define HISTORY_FACE_UP 0x80
+#define HISTORY_CARD_MASK 0x3f
+#define HISTORY_SET_COUNT 0xff
+#define HISTORY_BAR_HEIGHT 20
+#define AUTOCOMPLETE_PROOF_NODES 20000
+#define AUTOCOMPLETE_PROOF_SECONDS 0.002
+#define WIN_PHYSICS_STEP ((f32)SIM_STEP)
+#define WIN_CARD_MAX_LIFETIME 5.0f
 
 typedef enum {
 	PILE_NONE,
@@ -16,6 +73,7 @@ typedef struct {
 	PileKind kind;
 	oc_vec2 pos;
 	oc_list cards;
+	u32 version; // bumped whenever the cards on the pile or their layout change
 } Pile;
 
 typedef enum {
@@ -44,24 +102,31 @@ typedef enum {
 } Suit;
 
 typedef struct {
-	Suit suit;
-	CardKind kind;
 	oc_vec2 pos;
+	u8 suit;
+	u8 kind;
 } CardPath;
 
+// only the fields every frame's update, draw and hit testing read. state
+// that matters to a single interaction lives in side tables indexed the same
+// way as game.cards, see CardDrag
 typedef struct {
-	Suit suit;
-	CardKind kind;
 	Pile *pile;
 	oc_vec2 pos;
-	oc_vec2 vel; // for win animation
+	oc_vec2 prev_pos; // pos at the previous simulation step, for interpolation
 	oc_vec2 target_pos;
-	oc_vec2 drag_offset; // offset from mouse to top left corner of card
-	oc_vec2 pos_before_drag;
-	bool face_up;
 	oc_list_elt node;
+	u8 suit;  // Suit
+	u8 kind;  // CardKind
+	bool face_up;
 } Card;
 
+typedef struct {
+	oc_vec2 offset; // offset from mouse to top left corner of card
+	oc_vec2 pos_before_drag;
+	oc_vec2 target_before_drag; // where it goes back to if the drop fails
+} CardDrag;
+
 typedef struct {
 	bool down, was_down;
 } DigitalInput;
@@ -75,10 +140,29 @@ typedef struct {
 } MouseInput;
 
 typedef struct {
-	DigitalInput r, u;
+	DigitalInput r, u, m, l, t, d;
+	DigitalInput arrow_left, arrow_right;
 	DigitalInput num1, num2, num3, num4, num5, num6, num7, num8, num9, num0;
 } Input;
 
+typedef enum {
+	INPUT_EVENT_MOUSE_MOVE,
+	INPUT_EVENT_MOUSE_DOWN,
+	INPUT_EVENT_MOUSE_UP,
+	INPUT_EVENT_KEY_DOWN,
+	INPUT_EVENT_KEY_UP,
+} InputEventKind;
+
+// an input callback, queued until the simulation handles it. button events
+// carry the mouse position at the time they happened
+typedef struct {
+	f64 time;
+	f32 x, y;
+	f32 dx, dy;
+	i32 code; // mouse button or key code
+	InputEventKind kind;
+} InputEvent;
+
 typedef enum {
 	UNDO_NONE,
 	UNDO_SCORE_CHANGE,
@@ -86,18 +170,60 @@ typedef enum {
 	UNDO_COMMIT_MARKER,
 } UndoKind;
 
+typedef enum {
+	UNDO_WAS_FACE_UP        = 1 << 0,
+	UNDO_WAS_PARENT_FACE_UP = 1 << 1,
+} UndoFlags;
+
+// cards and piles are stored as indices into game.cards and board_pile() so
+// an entry is 6 bytes instead of three pointers
 typedef struct {
-	UndoKind kind;
+	u8 kind;  // UndoKind
+	u8 flags; // UndoFlags
 	union {
 		struct {
-			Pile *prev_pile;
-			Card *card, *parent;
-			bool was_face_up, was_parent_face_up;
+			u8 prev_pile;
+			u8 pile; // the pile the card moved to
+			u8 card;
+			u8 parent; // UNDO_NO_CARD if the card had nothing under it
 		};
-		i32 score_change;
+		i16 score_change;
 	};
 } UndoInfo;
 
+typedef enum {
+	MEM_UNDO_STACK,
+	MEM_WIN_CARD_PATH,
+	MEM_TELEMETRY,
+	MEM_NOTATION,
+	MEM_DEAL_TABLE,
+	MEM_SOLVER,
+	MEM_PAR,
+	MEM_TIMELINE,
+	MEM_HISTORY,
+	MEM_TRACE,
+	MEM_DRAW_RECORD,
+	MEM_SUBSYSTEM_COUNT,
+} MemSubsystem;
+
+typedef struct {
+	u64 live;
+	u64 peak;
+} MemUsage;
+
+// growable array made of fixed size blocks pushed on its own arena, so
+// growing never copies and all of it is given back at once on release
+typedef struct {
+	MemUsage *usage; // where its blocks are counted, one of GameState.memory
+	u32 item_size;
+	u32 block_items;
+	i32 count;
+	i32 block_count;
+	bool arena_initialized;
+	oc_arena arena;
+	void *blocks[BLOCK_ARRAY_MAX_BLOCKS];
+} BlockArray;
+
 typedef enum {
 	SCORE_NONE,
 	SCORE_RESET,
@@ -119,59 +245,466 @@ typedef struct {
 	};
 } UpdateScoreParams;
 
+typedef enum {
+	DRAW_IMAGE_SPRITESHEET,
+	DRAW_IMAGE_CARD_BACK,
+	DRAW_IMAGE_EMPTY_PILE,
+	DRAW_IMAGE_EMPTY_FOUNDATION,
+	DRAW_IMAGE_RELOAD,
+} DrawImage;
+
+// a card sized image draw waiting in the draw list, see draw_list_flush
+typedef struct {
+	f32 x, y;
+	i16 depth;  // painter's order layer, computed at flush time
+	i16 order;  // submission order
+	u8 image;   // DrawImage
+	u8 sprite;  // suit * CARD_KIND_COUNT + kind, for DRAW_IMAGE_SPRITESHEET
+} DrawItem;
+
+typedef enum {
+	LAYER_STATIC, // piles at rest, cached between frames
+	LAYER_MOVING, // piles with a card in motion, drawn every frame
+} DrawLayer;
+
+typedef struct {
+	i32 items;
+	i32 batches;                  // runs of draws sharing a source image
+	i32 image_switches;           // after sorting
+	i32 image_switches_unbatched; // if drawn in submission order
+	i32 static_layer_items;       // replayed from the cached static layer
+	bool static_layer_rebuilt;
+} DrawStats;
+
+typedef enum {
+	DRAW_COMMAND_CLEAR,
+	DRAW_COMMAND_IMAGE,
+	DRAW_COMMAND_IMAGE_REGION,
+	DRAW_COMMAND_RECT_FILL,
+	DRAW_COMMAND_RECT_STROKE,
+	DRAW_COMMAND_ROUNDED_RECT_FILL,
+	DRAW_COMMAND_ROUNDED_RECT_STROKE,
+	DRAW_COMMAND_TEXT,
+	DRAW_COMMAND_UI, // oc_ui_draw, its contents aren't recorded
+	DRAW_COMMAND_KIND_COUNT,
+} DrawCommandKind;
+
+// one canvas call with the state it drew with, see draw_record.c
+typedef struct {
+	oc_rect dest;    // what it covers, the ink box for text
+	oc_rect src;     // the image region, or for text the baseline origin in x, y
+	oc_color color;  // fill, stroke or text color
+	oc_image image;
+	oc_str8 text;    // the caller's string, only valid during the frame
+	f32 width;       // stroke width
+	f32 radius;      // rounded rectangles
+	f32 font_size;
+	u8 kind;         // DrawCommandKind
+} DrawCommand;
+
+typedef struct {
+	i32 commands;
+	i32 by_kind[DRAW_COMMAND_KIND_COUNT];
+	i32 image_switches;
+	f64 covered_area; // pixels drawn, summed over every command clipped to the frame
+	f64 union_area;   // pixels drawn at least once
+	f32 overdraw;     // covered_area / union_area, how many times a touched pixel is drawn
+} DrawRecordStats;
+
+typedef enum {
+	NOTATION_STOCK,    // s
+	NOTATION_RECYCLE,  // r
+	NOTATION_UNDO,     // u
+	NOTATION_TRANSFER, // <from>[:<count>]><to>, e.g. t5:4>t1 or w>f2
+} NotationKind;
+
+// one committed move or undo, piles are board_pile() indices
+typedef struct {
+	u8 kind; // NotationKind
+	u8 from;
+	u8 to;
+	u8 count;
+} NotationMove;
+
+// NOTE(shaw): the solver works on its own copy of the board so it can run
+// without touching game. piles use the board_pile() numbering, except that
+// foundation 2 + s holds suit s
+typedef struct {
+	u8 tableau[7][SOLVER_TABLEAU_MAX]; // card ids suit * CARD_KIND_COUNT + kind, bottom first
+	u8 tableau_count[7];
+	u8 tableau_hidden[7];              // face down cards at the bottom
+	u8 talon[24];                      // waste then stock, see solver_apply
+	u8 talon_count;
+	u8 waste_count;
+	u8 foundation[SUIT_COUNT];         // cards on each suit's foundation
+	bool draw_three;
+} SolverState;
+
+typedef struct {
+	u8 from;
+	u8 to;
+	u8 count;
+	u8 priority;
+} SolverMove;
+
+typedef enum {
+	SOLVER_UNKNOWN, // gave up at the node limit
+	SOLVER_WON,
+	SOLVER_LOST,
+	SOLVER_SEARCHING, // solver_continue ran out of its slice, call it again
+} SolverResult;
+
+typedef struct {
+	SolverState state;
+	SolverMove moves[SOLVER_MAX_MOVES];
+	u8 move_count;
+	u8 next_move;
+	u16 path_start; // path length once this frame's safe moves are played
+	bool on_path;   // something below was cut off for being on the path
+	u32 table_slot;
+} SolverFrame;
+
+// dead states shared between searches running at once, see solver_visit
+typedef struct {
+	u64 *slots;
+	u32 mask;
+} SolverSharedTable;
+
+typedef struct {
+	u32 node_limit;
+	f64 time_limit;    // seconds, zero for none
+	u32 nodes;
+	u32 max_depth;     // deepest frame the last search reached
+	bool hit_limit;
+	u64 *table;        // hashes of visited states, open addressing
+	u32 table_mask;
+	u32 table_count;
+	SolverFrame *frames;
+	SolverMove *path;  // the solution once solver_solve returns SOLVER_WON
+	u32 path_length;
+	f64 deadline;      // from time_limit, zero for none
+	i32 depth;         // where solver_continue picks up
+	bool entering;
+	u64 bytes;
+	SolverSharedTable *shared;       // may be NULL
+	bool (*should_stop)(void *user); // polled every 256 nodes, may be NULL
+	void *user;
+} Solver;
+
+typedef enum {
+	PAR_IDLE,
+	PAR_SEARCHING,
+	PAR_DONE,
+} ParStatus;
+
+// an iterative deepening search for the fewest moves that win, see par.c
+typedef struct {
+	ParStatus status;
+	SolverState start;
+	u32 par;           // moves in the shortest win known, zero for none
+	bool proven;       // no win is shorter than par
+	u32 seed_par;      // the plain solver's win the search started from
+	u32 lower_bound;   // no win is shorter than this
+	u32 first_bound;   // par_lower_bound of the start
+	bool seeding;      // the plain solver still looking for a first win
+	bool shortening;   // improving the seed win, before IDA*
+	u32 bound;         // most moves a line may take this pass
+	u32 next_bound;
+	u32 iterations;
+	u64 nodes;         // seed solve and every iteration
+	u64 node_limit;
+	f64 seconds;       // spent in par_run
+	Solver seed;
+	SolverFrame *frames;
+	i32 depth;
+	bool entering;     // frames[depth] hasn't been expanded yet
+	SolverMove *path;
+	u32 path_length;
+	SolverMove *best_path; // par moves long
+	u64 *table;        // state hash and fewest moves to reach it
+	u32 table_mask;
+	u32 table_count;
+	u32 table_peak;
+	u64 bytes;
+	oc_arena arena;
+} ParSearch;
+
+// sorted deal numbers, stored as the first number of every DEAL_TABLE_BLOCK
+// entries followed by varint deltas for the rest of the block
+typedef struct {
+	bool load_attempted;
+	u32 count;
+	u32 block_count;
+	u32 *block_first;  // deal number that starts each block
+	u32 *block_offset; // where each block's deltas start in deltas
+	u8 *deltas;
+	u64 deltas_size;
+	u64 bytes;         // file size, all of it stays loaded
+	oc_arena arena;
+} DealTable;
+
+// which deals New Game picks from, every filter but DEAL_FILTER_ANY reads a
+// deal table per draw mode
+typedef enum {
+	DEAL_FILTER_ANY,
+	DEAL_FILTER_SOLVABLE,
+	DEAL_FILTER_EASY,
+	DEAL_FILTER_MEDIUM,
+	DEAL_FILTER_HARD,
+	DEAL_FILTER_COUNT,
+} DealFilter;
+
+// how fast cards move, ANIMATION_OFF lands every card on the next step
+typedef enum {
+	ANIMATION_NORMAL,
+	ANIMATION_FAST,
+	ANIMATION_OFF,
+	ANIMATION_SPEED_COUNT,
+} AnimationSpeed;
+
+typedef enum {
+	EASE_LINEAR,
+	EASE_OUT_CUBIC,
+	EASE_IN_OUT_CUBIC,
+} Ease;
+
+typedef enum {
+	TIMELINE_MOVE,   // tweens a card from wherever it is when the item starts
+	TIMELINE_FLIP,   // turns a card face up or down
+	TIMELINE_LAUNCH, // throws a card off its foundation for the win animation
+} TimelineItemKind;
+
+typedef struct {
+	f32 start, duration; // seconds from the start of the sequence
+	oc_vec2 from;        // taken when a move starts, so it can pick a card up mid flight
+	oc_vec2 to;          // where a move ends, a launch's velocity
+	u8 kind;             // TimelineItemKind
+	u8 ease;             // Ease
+	u8 card;             // index into game.cards
+	bool face_up;        // what a flip turns the card to
+	bool done;
+} TimelineItem;
+
+typedef enum {
+	SEQUENCE_NONE,
+	SEQUENCE_DEAL,
+	SEQUENCE_AUTOCOMPLETE,
+	SEQUENCE_WIN,
+} TimelineSequence;
+
+// one planned sequence of card animations, see timeline.c
+typedef struct {
+	TimelineSequence sequence;
+	BlockArray items;  // TimelineItem, in order of start
+	i32 first_running; // every item before it is done
+	i32 next_start;    // items from here on haven't started
+	f64 time;
+	f32 end_time;
+	i32 card_move[SUIT_COUNT*CARD_KIND_COUNT]; // latest move started on each card, -1 if none
+} Timeline;
+
+// what a sequence has planned so far, only lives while it is being planned
+typedef struct {
+	oc_vec2 pos[SUIT_COUNT*CARD_KIND_COUNT];   // where each card's last move ends
+	bool face_up[SUIT_COUNT*CARD_KIND_COUNT];  // each card's face after its last flip
+	bool start_face_up[SUIT_COUNT*CARD_KIND_COUNT];
+} TimelinePlan;
+
+// a compact board: each pile's cards from the bottom up as game.cards
+// indices, HISTORY_FACE_UP set on the face up ones. piles use the
+// board_pile() numbering
+typedef struct {
+	u8 count[PILE_COUNT];
+	u8 cards[PILE_COUNT][HISTORY_PILE_MAX];
+} HistoryLayout;
+
+typedef struct {
+	u8 cards[SUIT_COUNT*CARD_KIND_COUNT]; // pile by pile, bottom up
+	u8 count[PILE_COUNT];
+} HistoryKeyframe;
+
+// sets one slot of a pile, or the pile's card count when index is
+// HISTORY_SET_COUNT
+typedef struct {
+	u8 pile;
+	u8 index;
+	u8 value;
+} HistoryChange;
+
+typedef struct {
+	i32 first_change; // into History.changes, the changes from the position before
+	i32 change_count;
+	i32 score;
+} HistoryPosition;
+
+// every position of the current line of play, see history.c
+typedef struct {
+	BlockArray positions; // HistoryPosition, position 0 is the deal
+	BlockArray changes;   // HistoryChange
+	BlockArray keyframes; // HistoryKeyframe, one every HISTORY_KEYFRAME_INTERVAL positions
+	HistoryLayout layout; // the last position
+	u32 pile_version[PILE_COUNT]; // each pile's version when layout was read
+	i32 cursor;           // the position on the board, the last one unless reviewing
+	bool scrubbing;       // the history bar is being dragged
+	bool enabled;         // off in tools that only replay records
+} History;
+
+// chrome trace event phases
+typedef enum {
+	TRACE_BEGIN,
+	TRACE_END,
+	TRACE_INSTANT,
+} TracePhase;
+
+typedef struct {
+	f64 time;         // monotonic clock seconds
+	const char *name; // a string literal, never copied
+	i32 value;        // shown in the viewer for instant events
+	u8 phase;         // TracePhase
+} TraceEvent;
+
+typedef struct {
+	bool enabled;
+	TraceEvent *events; // ring of TRACE_EVENT_MAX, allocated the first time tracing starts
+	u64 count;          // events since tracing started, the ring keeps the last TRACE_EVENT_MAX
+	f64 start_time;
+	oc_arena arena;
+} Trace;
+
+typedef enum {
+	TELEMETRY_WON,
+	TELEMETRY_ABANDONED,
+} TelemetryOutcome;
+
+// one finished or abandoned game. each field is stored in its own column
+// file, see telemetry_columns
+typedef struct {
+	u32 deal_number;
+	u8 draw_three;
+	u8 outcome; // TelemetryOutcome
+	u16 move_count;
+	u16 undo_count;
+	u16 think_count; // think times stored for this game
+	i32 score;
+	f32 time;
+	f32 first_move_time;
+	u32 think_offset; // index of the first think time in the think column
+} TelemetryRecord;
+
+typedef enum {
+	TELEMETRY_COLUMN_DEAL,
+	TELEMETRY_COLUMN_DRAW_THREE,
+	TELEMETRY_COLUMN_OUTCOME,
+	TELEMETRY_COLUMN_MOVE_COUNT,
+	TELEMETRY_COLUMN_UNDO_COUNT,
+	TELEMETRY_COLUMN_THINK_COUNT,
+	TELEMETRY_COLUMN_SCORE,
+	TELEMETRY_COLUMN_TIME,
+	TELEMETRY_COLUMN_FIRST_MOVE_TIME,
+	TELEMETRY_COLUMN_THINK_OFFSET,
+	TELEMETRY_COLUMN_COUNT,
+} TelemetryColumnId;
+
 typedef enum {
 	STATE_NONE,
 	STATE_DEALING,
 	STATE_PLAY,
 	STATE_SHOW_RULES,
 	STATE_SELECT_CARD_BACK,
+	STATE_SHOW_STATISTICS,
 	STATE_AUTOCOMPLETE,
 	STATE_WIN,
 } StateKind;
 
+// NOTE(shaw): one board. every function that touches a board takes it, so a
+// native process can run any number side by side, see sim.c. the orca entry
+// points drive a single one, orca_game
 typedef struct {
 	StateKind state, restore_state;
 	bool draw_three_mode;
+	Pcg32 rng;
 	oc_surface surface;
 	oc_canvas canvas;
-	oc_ui_context ui;
 	oc_font font;
 	oc_color bg_color;
 
 	MouseInput mouse_input;
 	Input input;
+	InputEvent input_queue[INPUT_QUEUE_MAX]; // ring buffer, oldest at input_queue_head
+	i32 input_queue_head, input_queue_count;
+	oc_vec2 input_mouse_pos; // latest position reported by oc_on_mouse_move
+	bool input_swallow_click; // the ui used the queued click, see swallow_ui_click
+	f64 input_last_move_time;
+
+	f32 drag_prediction;   // seconds to extrapolate the dragged stack ahead, 0 is off
+	oc_vec2 drag_velocity; // pixels per second, smoothed from mouse deltas
+
+	f64 latency_pending_time; // oldest handled input not yet presented, 0 if none
+	u32 latency_count;
+	u32 latency_histogram[LATENCY_BUCKETS];
+	Trace trace; // off until the T key starts it
 	oc_vec2 mouse_pos_on_mouse_right_down;
 
 	f64 dt, last_timestamp, timer;
+	f64 sim_accumulator;
+	f32 sim_alpha; // how far between the last two simulation steps to draw
 	char timer_string[9]; // 00:00:00
-	f32 deal_speed;
-	f32 card_animate_speed;
+	f32 card_animate_speed; // 0 is no animation
+	AnimationSpeed animation_speed; // sets card_animate_speed, deal_delay and deal_duration
 
-	f64 deal_countdown, deal_delay;
-	i32 deal_tableau_index;     // used for calculating 
-	i32 deal_tableau_remaining; // where to deal cards
-	i32 deal_cards_remaining;
+	f32 deal_delay;    // seconds between dealt cards, and between autocomplete moves
+	f32 deal_duration; // seconds a dealt or autocompleted card takes to land
+	u32 deal_number; // seeds the shuffle, so a deal can be replayed from it
 
 	oc_color menu_bg_color;
 	bool menu_opened;
 	i32 menu_card_backs_margin;
 	oc_ui_box *menu_card_backs_draw_box;
 
-	i32 win_foundation_index;
-	Card *win_moving_card;
-	i32 win_card_path_index;
+	Timeline timeline; // dealing, autocomplete or the win animation
+
+	BlockArray win_card_path; // CardPath, only allocated during STATE_WIN
+	f32 win_launch_interval; // seconds between card launches
+	i32 win_max_flying;      // how many cards may be in the air at once
+
+	// cards currently flying in the win animation, stored as separate arrays
+	// so the physics step is a straight loop over floats
+	i32 win_flying_count;
+	Card *win_flying_cards[WIN_MAX_FLYING_CARDS];
+	f32 win_pos_x[WIN_MAX_FLYING_CARDS];
+	f32 win_pos_y[WIN_MAX_FLYING_CARDS];
+	f32 win_vel_x[WIN_MAX_FLYING_CARDS];
+	f32 win_vel_y[WIN_MAX_FLYING_CARDS];
 
 	i32 temp_undo_stack_index;
-	i32 undo_stack_index;
+	UndoInfo temp_undo_stack[64];
+	BlockArray undo_stack; // UndoInfo
 	i32 move_count;
 	i32 undo_count;
-	char moves_string[12]; // Moves: 0000
+	char moves_string[40]; // Moves: %d (best %u) at full width
+	BlockArray notation; // NotationMove, every move and undo of this game
+	History history;
+	Solver autocomplete_solver;  // proves wins once every card is face up
+	oc_arena autocomplete_solver_arena;
+	u32 autocomplete_next_move; // into autocomplete_solver.path
+	ParSearch par;              // runs a slice a frame once the game is won
+	DealFilter deal_filter;
+	DealTable deal_tables[DEAL_FILTER_COUNT][2]; // turn 1 and turn 3, loaded on first use
+	bool replaying;      // applying a move record, see notation_replay
 
 	i32 score;
 	char score_string[14]; // Score: 000000
 	i32 highscore;
+	bool interactive; // the board a player sees, only it saves the highscore and searches for the par
 	char highscore_string[19]; // High Score: 000000
 
+	bool telemetry_enabled;
+	bool telemetry_game_open;    // a move was made and the game isn't logged yet
+	f64 telemetry_last_move_time;
+	f32 telemetry_first_move_time;
+	BlockArray telemetry_think_times; // f32 seconds before each move
+	char statistics_strings[5][40];
+
 	oc_vec2 frame_size;
 	oc_vec2 board_margin;
 	u32 card_width, card_height;
@@ -185,18 +718,45 @@ typedef struct {
 	Card *card_dragging;
 	
 	oc_image spritesheet, reload_icon, rules_images[2], card_backs[10];
+	oc_image empty_pile_image, empty_foundation_image; // baked per card size
+	u32 empty_pile_image_width, empty_pile_image_height;
 	u32 selected_card_back;
 
 	oc_rect card_sprite_rects[SUIT_COUNT][CARD_KIND_COUNT]; 
-	Card cards[SUIT_COUNT*CARD_KIND_COUNT];
 
-	CardPath win_card_path[10000];
+	i32 draw_list_count;
+	DrawItem draw_list[DRAW_LIST_MAX];
+	DrawStats draw_stats;
+
+	// every canvas call of the last frame, see draw_record.c
+	BlockArray draw_record; // DrawCommand
+	u32 draw_record_frame;
+	oc_color draw_record_color;
+	f32 draw_record_width;
+	f32 draw_record_font_size;
+	DrawCommand draw_record_overflow; // filled in and thrown away once the record is full
+
+	// draws for every pile with no card in motion, sorted once and replayed
+	// until board_version, the set of static piles or the card back changes
+	u32 board_version;
+	bool static_layer_valid;
+	u32 static_layer_board_version;
+	u32 static_layer_pile_mask;
+	u32 static_layer_card_back;
+	Card *static_layer_card_dragging;
+	i32 static_layer_count;
+	i32 static_layer_switches_unbatched;
+	DrawItem static_layer[DRAW_LIST_MAX];
+	Card cards[SUIT_COUNT*CARD_KIND_COUNT];
+	CardDrag card_drag[SUIT_COUNT*CARD_KIND_COUNT];
 
-	UndoInfo temp_undo_stack[64];
-	UndoInfo undo_stack[4096];
+	MemUsage memory[MEM_SUBSYSTEM_COUNT];
 } GameState;
 
-GameState game;
+// owned by the orca ui, kept outside GameState since the game never
+// touches its contents. it was moved here, not removed, so it is still static
+// memory for the whole session, sizeof(GameState) just no longer counts it.
+oc_ui_context ui_context;
 
 static oc_ui_sig oc_ui_menu_button_fixed_width(const char* name, f32 width) {
     oc_ui_context* ui = oc_ui_get_context();
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+// deal tables
+//------------------------------------------------------------------------------
+// NOTE(shaw): a deal table is a sorted list of deal numbers, shipped in data/
+// and written by dealgen.c (solvable) and rate.c (easy, medium, hard). the
+// file is
+//
+//     u32 magic, count, block_size, block_count
+//     u64 deltas_size
+//     u32 block_first[block_count]
+//     u32 block_offset[block_count]
+//     u8  deltas[deltas_size]
+//
+// all little endian. each block of block_size numbers stores its first number
+// in block_first and the gaps to the rest as LEB128 varints, so dense tables
+// cost about a byte a deal. nothing is read until the first pick, and a pick
+// decodes at most one block.
+
+#define DEAL_TABLE_MAGIC 0x3154444b // "KDT1"
+
+typedef struct {
+	u32 magic;
+	u32 count;
+	u32 block_size;
+	u32 block_count;
+	u64 deltas_size;
+} DealTableHeader;
+
+static const char *deal_table_paths[DEAL_FILTER_COUNT][2] = {
+	[DEAL_FILTER_SOLVABLE] = { "solvable_draw1.dat", "solvable_draw3.dat" },
+	[DEAL_FILTER_EASY]     = { "easy_draw1.dat",     "easy_draw3.dat" },
+	[DEAL_FILTER_MEDIUM]   = { "medium_draw1.dat",   "medium_draw3.dat" },
+	[DEAL_FILTER_HARD]     = { "hard_draw1.dat",     "hard_draw3.dat" },
+};
+
+static const char *deal_filter_names[DEAL_FILTER_COUNT] = {
+	[DEAL_FILTER_ANY]      = "New Game: Any Deal",
+	[DEAL_FILTER_SOLVABLE] = "New Game: Solvable",
+	[DEAL_FILTER_EASY]     = "New Game: Easy",
+	[DEAL_FILTER_MEDIUM]   = "New Game: Medium",
+	[DEAL_FILTER_HARD]     = "New Game: Hard",
+};
+
+static bool deal_table_load(GameState *game, DealTable *table, const char *path) {
+	table->load_attempted = true;
+
+	oc_file file = oc_file_open(OC_STR8(path), OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_error("Could not open file %s\n", path);
+		return false;
+	}
+
+	DealTableHeader header = {0};
+	u64 size = oc_file_size(file);
+	bool ok = size >= sizeof(header) &&
+	          oc_file_read(file, sizeof(header), (char*)&header) == sizeof(header) &&
+	          header.magic == DEAL_TABLE_MAGIC &&
+	          header.block_size == DEAL_TABLE_BLOCK &&
+	          header.count > 0 &&
+	          header.block_count == (header.count + DEAL_TABLE_BLOCK - 1) / DEAL_TABLE_BLOCK &&
+	          size == sizeof(header) + 2ull * header.block_count * sizeof(u32) + header.deltas_size;
+
+	if (ok) {
+		u64 bytes = size - sizeof(header);
+		oc_arena_init(&table->arena);
+		u8 *data = oc_arena_push(&table->arena, bytes);
+		ok = oc_file_read(file, bytes, (char*)data) == bytes;
+		if (ok) {
+			table->count = header.count;
+			table->block_count = header.block_count;
+			table->block_first = (u32*)data;
+			table->block_offset = table->block_first + header.block_count;
+			table->deltas = (u8*)(table->block_offset + header.block_count);
+			table->deltas_size = header.deltas_size;
+			table->bytes = bytes;
+			mem_track(&game->memory[MEM_DEAL_TABLE], bytes);
+			for (u32 i=0; i<table->block_count; ++i) {
+				ok = ok && table->block_offset[i] <= table->deltas_size;
+			}
+		}
+		if (!ok) {
+			oc_arena_cleanup(&table->arena);
+		}
+	}
+	oc_file_close(file);
+
+	if (!ok) {
+		oc_log_error("%s is not a valid deal table\n", path);
+		table->count = 0;
+		if (table->bytes) {
+			mem_track(&game->memory[MEM_DEAL_TABLE], -(i64)table->bytes);
+			table->bytes = 0;
+		}
+	}
+	return ok;
+}
+
+// the index-th deal number in the table, walks at most one block of deltas
+static u32 deal_table_get(DealTable *table, u32 index) {
+	assert(index < table->count);
+	u32 block = index / DEAL_TABLE_BLOCK;
+	u32 deal_number = table->block_first[block];
+	u8 *at = table->deltas + table->block_offset[block];
+	u8 *end = table->deltas + table->deltas_size;
+	for (u32 i = block * DEAL_TABLE_BLOCK; i < index; ++i) {
+		u32 delta = 0;
+		for (u32 shift=0; at < end; shift += 7) {
+			u8 byte = *at++;
+			delta |= (u32)(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) break;
+		}
+		deal_number += delta;
+	}
+	return deal_number;
+}
+
+// picks a random deal from the filter's table for the draw mode, false if
+// there is no usable table
+static bool deal_table_pick(GameState *game, DealFilter filter, bool draw_three, u32 *deal_number) {
+	if (filter == DEAL_FILTER_ANY) {
+		return false;
+	}
+	DealTable *table = &game->deal_tables[filter][draw_three ? 1 : 0];
+	if (!table->load_attempted) {
+		deal_table_load(game, table, deal_table_paths[filter][draw_three ? 1 : 0]);
+	}
+	if (table->count == 0) {
+		return false;
+	}
+	*deal_number = deal_table_get(table, rand_range_u32(&game->rng, 0, table->count - 1));
+	return true;
+}
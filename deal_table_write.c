@@ -0,0 +1,52 @@
+// Writes deal tables for the native tools (dealgen.c, rate.c), see
+// deal_table.c for the format. deals must be sorted and free of repeats.
+
+static void deal_table_put_varint(u8 **at, u32 value) {
+	while (value >= 0x80) {
+		*(*at)++ = (u8)(value | 0x80);
+		value >>= 7;
+	}
+	*(*at)++ = (u8)value;
+}
+
+static bool deal_table_write(const char *path, u32 *deals, u32 count) {
+	u32 block_count = (count + DEAL_TABLE_BLOCK - 1) / DEAL_TABLE_BLOCK;
+	u32 *block_first = malloc(block_count * sizeof(u32));
+	u32 *block_offset = malloc(block_count * sizeof(u32));
+	u8 *deltas = malloc((u64)count * 5);
+	u8 *at = deltas;
+
+	for (u32 i=0; i<count; ++i) {
+		if (i % DEAL_TABLE_BLOCK == 0) {
+			block_first[i / DEAL_TABLE_BLOCK] = deals[i];
+			block_offset[i / DEAL_TABLE_BLOCK] = (u32)(at - deltas);
+		} else {
+			deal_table_put_varint(&at, deals[i] - deals[i - 1]);
+		}
+	}
+
+	DealTableHeader header = {
+		.magic = DEAL_TABLE_MAGIC,
+		.count = count,
+		.block_size = DEAL_TABLE_BLOCK,
+		.block_count = block_count,
+		.deltas_size = (u64)(at - deltas),
+	};
+
+	bool ok = false;
+	FILE *out = fopen(path, "wb");
+	if (out) {
+		ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+		     fwrite(block_first, sizeof(u32), block_count, out) == block_count &&
+		     fwrite(block_offset, sizeof(u32), block_count, out) == block_count &&
+		     fwrite(deltas, 1, header.deltas_size, out) == header.deltas_size;
+		fclose(out);
+	}
+	fprintf(stderr, "%s: %u deals in %llu bytes\n", path, count,
+		(u64)(sizeof(header) + 2ull * block_count * sizeof(u32) + header.deltas_size));
+
+	free(block_first);
+	free(block_offset);
+	free(deltas);
+	return ok;
+}
@@ -0,0 +1,56 @@
+// Builds the solvable deal tables in data/.
+//
+// Builds natively against headless/orca.h like bench.c. Runs the solver over
+// a range of deal numbers for one draw mode and writes the ones it wins to a
+// deal table, see deal_table.c for the format. Deals the solver gives up on
+// are left out, so every deal in a table has a known solution. Progress and a
+// summary go to stderr.
+//
+// usage: dealgen <1|3> first_deal count [node_limit] output.dat
+
+#include "solitaire.c"
+#include "deal_table_write.c"
+
+#define DEALGEN_DEFAULT_NODE_LIMIT 200000
+
+int main(int argc, char **argv) {
+	if (argc < 5) {
+		fprintf(stderr, "usage: dealgen <1|3> first_deal count [node_limit] output.dat\n");
+		return 1;
+	}
+	bool draw_three = atoi(argv[1]) == 3;
+	u32 first = (u32)strtoul(argv[2], NULL, 10);
+	u32 count = (u32)strtoul(argv[3], NULL, 10);
+	u32 node_limit = argc > 5 ? (u32)strtoul(argv[4], NULL, 10) : DEALGEN_DEFAULT_NODE_LIMIT;
+	const char *path = argv[argc - 1];
+
+	headless.log_info = false;
+
+	oc_arena arena;
+	oc_arena_init(&arena);
+	Solver solver;
+	solver_init(&solver, &arena, node_limit);
+
+	u32 *deals = malloc((u64)count * sizeof(u32));
+	u32 won = 0, lost = 0, unknown = 0;
+	f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+	for (u32 i=0; i<count; ++i) {
+		SolverState state;
+		solver_deal(&state, first + i, draw_three);
+		switch (solver_solve(&solver, &state)) {
+		case SOLVER_WON:  deals[won++] = first + i; break;
+		case SOLVER_LOST: ++lost; break;
+		default:          ++unknown; break;
+		}
+		if ((i + 1) % 1000 == 0) {
+			fprintf(stderr, "%u/%u\n", i + 1, count);
+		}
+	}
+	f64 seconds = oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+	fprintf(stderr, "turn %d: %u won, %u lost, %u unknown in %.1fs\n",
+		draw_three ? 3 : 1, won, lost, unknown, seconds);
+
+	bool ok = deal_table_write(path, deals, won);
+	free(deals);
+	return ok ? 0 : 1;
+}
@@ -1,100 +1,367 @@
-static void draw_card(Card *card) {
-	oc_rect dest = { card->pos.x, card->pos.y, game.card_width, game.card_height };
+// position to draw a card at, interpolated between the last two simulation
+// steps so motion stays smooth when the frame rate and SIM_STEP differ
+static oc_vec2 card_draw_pos(GameState *game, Card *card) {
+	f32 t = game->sim_alpha;
+	return (oc_vec2){
+		card->prev_pos.x + (card->pos.x - card->prev_pos.x) * t,
+		card->prev_pos.y + (card->pos.y - card->prev_pos.y) * t,
+	};
+}
+
+// every queued draw is card sized, so only the position is stored
+static void draw_list_push(GameState *game, DrawImage image, u8 sprite, oc_vec2 pos) {
+	if (game->draw_list_count >= ARRAY_COUNT(game->draw_list)) {
+		oc_log_error("draw list full, dropping draw\n");
+		return;
+	}
+	game->draw_list[game->draw_list_count] = (DrawItem){
+		.x = pos.x,
+		.y = pos.y,
+		.order = (i16)game->draw_list_count,
+		.image = image,
+		.sprite = sprite,
+	};
+	++game->draw_list_count;
+}
+
+static oc_image draw_image_get(GameState *game, DrawImage image) {
+	switch (image) {
+	case DRAW_IMAGE_SPRITESHEET:       return game->spritesheet;
+	case DRAW_IMAGE_CARD_BACK:         return game->card_backs[game->selected_card_back];
+	case DRAW_IMAGE_EMPTY_PILE:        return game->empty_pile_image;
+	case DRAW_IMAGE_EMPTY_FOUNDATION:  return game->empty_foundation_image;
+	case DRAW_IMAGE_RELOAD:            return game->reload_icon;
+	}
+	return oc_image_nil();
+}
+
+static inline bool draw_items_overlap(GameState *game, DrawItem *a, DrawItem *b) {
+	return fabsf(a->x - b->x) < game->card_width && fabsf(a->y - b->y) < game->card_height;
+}
+
+static inline bool draw_item_before(DrawItem *a, DrawItem *b) {
+	if (a->depth != b->depth) return a->depth < b->depth;
+	if (a->image != b->image) return a->image < b->image;
+	return a->order < b->order;
+}
+
+// sorts the queued draws so draws from the same source image are adjacent.
+// an item's depth is one more than the deepest earlier item it overlaps, so
+// items sharing a depth never overlap and can be reordered freely, while
+// anything drawn on top of something else still comes after it.
+// returns how many image switches submission order would have caused
+static i32 draw_list_sort(GameState *game, DrawItem *items, i32 count) {
+	i32 switches_unbatched = 0;
+
+	for (i32 i=0; i<count; ++i) {
+		i32 depth = 0;
+		for (i32 j=0; j<i; ++j) {
+			if (items[j].depth >= depth && draw_items_overlap(game, &items[i], &items[j])) {
+				depth = items[j].depth + 1;
+			}
+		}
+		items[i].depth = depth;
+		if (i > 0 && items[i].image != items[i-1].image) {
+			++switches_unbatched;
+		}
+	}
+
+	// insertion sort, the list is small and mostly in order already
+	for (i32 i=1; i<count; ++i) {
+		DrawItem item = items[i];
+		i32 j = i - 1;
+		while (j >= 0 && draw_item_before(&item, &items[j])) {
+			items[j + 1] = items[j];
+			--j;
+		}
+		items[j + 1] = item;
+	}
+
+	return switches_unbatched;
+}
+
+static void draw_list_issue(GameState *game, DrawItem *items, i32 count) {
+	trace_begin(game, "draw_list_issue");
+	DrawStats *stats = &game->draw_stats;
+	for (i32 i=0; i<count; ++i) {
+		DrawItem *item = &items[i];
+		if (i == 0 || item->image != items[i-1].image) {
+			++stats->batches;
+			if (i > 0) ++stats->image_switches;
+		}
+		oc_image image = draw_image_get(game, item->image);
+		oc_rect dest = { item->x, item->y, game->card_width, game->card_height };
+		if (item->image == DRAW_IMAGE_SPRITESHEET) {
+			oc_rect src = game->card_sprite_rects[item->sprite / CARD_KIND_COUNT][item->sprite % CARD_KIND_COUNT];
+			canvas_image_draw_region(game, image, src, dest);
+		} else {
+			canvas_image_draw(game, image, dest);
+		}
+	}
+	stats->items += count;
+	trace_end(game, "draw_list_issue");
+}
+
+static void draw_list_flush(GameState *game) {
+	trace_begin(game, "draw_list_flush");
+	game->draw_stats.image_switches_unbatched += draw_list_sort(game, game->draw_list, game->draw_list_count);
+	draw_list_issue(game, game->draw_list, game->draw_list_count);
+	game->draw_list_count = 0;
+	trace_end(game, "draw_list_flush");
+}
+
+static void draw_card(GameState *game, Card *card) {
+	oc_vec2 pos = card_draw_pos(game, card);
 	if (card->face_up) {
-		oc_image_draw_region(game.spritesheet, game.card_sprite_rects[card->suit][card->kind], dest);
+		draw_list_push(game, DRAW_IMAGE_SPRITESHEET, card->suit * CARD_KIND_COUNT + card->kind, pos);
 	} else {
-		oc_image_draw(game.card_backs[game.selected_card_back], dest);
-	}
-	// draw outline around card
-	oc_set_color_rgba(0.1, 0.1, 0.1, 0.69);
-	oc_set_width(1);
-	oc_rectangle_stroke(dest.x, dest.y, game.card_width, game.card_height);
-}
-
-static void draw_stock(void) {
-	u32 border_width = 2;
-	oc_set_width(border_width);
-	oc_set_color_rgba(0.42, 0.42, 0.42, 0.69); // empty pile outline color
-	oc_rounded_rectangle_stroke(
-		game.stock.pos.x + (0.5f * border_width), 
-		game.stock.pos.y + (0.5f * border_width), 
-		game.card_width - border_width, 
-		game.card_height - border_width,
-		5);
-
-	if (oc_list_empty(game.stock.cards)) {
-		oc_rect dest = { game.stock.pos.x, game.stock.pos.y, game.card_width, game.card_height };
-		oc_image_draw(game.reload_icon, dest);
-	} else {
-		oc_list_for_reverse(game.stock.cards, card, Card, node) {
-			draw_card(card);
+		draw_list_push(game, DRAW_IMAGE_CARD_BACK, 0, pos);
+	}
+	// NOTE(shaw): the outline around each card is baked into the card images
+	// (see tools/bake_card_outlines.py) so this is a single image draw
+}
+
+// rasterizes a rounded rectangle outline the size of a card, matching what
+// oc_rounded_rectangle_stroke used to draw for empty piles. this runs only
+// when the card size changes, every frame after that is a plain image draw.
+static oc_image bake_empty_pile_image(GameState *game, u32 width, u32 height, oc_color color) {
+	f32 border_width = 2;
+	f32 radius = 5;
+	f32 half_w = 0.5f * (width - border_width);
+	f32 half_h = 0.5f * (height - border_width);
+	f32 center_x = 0.5f * width;
+	f32 center_y = 0.5f * height;
+
+	oc_arena_scope scratch = oc_scratch_begin();
+	u8 *pixels = oc_arena_push_array(scratch.arena, u8, width * height * 4);
+
+	for (u32 y=0; y<height; ++y)
+	for (u32 x=0; x<width; ++x) {
+		// signed distance from the pixel center to the outline's center line
+		f32 qx = fabsf(x + 0.5f - center_x) - (half_w - radius);
+		f32 qy = fabsf(y + 0.5f - center_y) - (half_h - radius);
+		f32 outside_x = qx > 0 ? qx : 0;
+		f32 outside_y = qy > 0 ? qy : 0;
+		f32 inside = qx > qy ? qx : qy;
+		if (inside > 0) inside = 0;
+		f32 dist = sqrtf(outside_x*outside_x + outside_y*outside_y) + inside - radius;
+
+		f32 coverage = 0.5f * border_width + 0.5f - fabsf(dist);
+		if (coverage < 0) coverage = 0;
+		if (coverage > 1) coverage = 1;
+
+		u8 *pixel = pixels + 4 * (y * width + x);
+		pixel[0] = (u8)(color.r * 255.0f);
+		pixel[1] = (u8)(color.g * 255.0f);
+		pixel[2] = (u8)(color.b * 255.0f);
+		pixel[3] = (u8)(color.a * coverage * 255.0f);
+	}
+
+	oc_image image = oc_image_create_from_rgba8(game->surface, width, height, pixels);
+	oc_scratch_end(scratch);
+	return image;
+}
+
+// (re)creates the cached empty pile outlines if the card size changed
+static void update_empty_pile_images(GameState *game) {
+	if (game->empty_pile_image_width == game->card_width &&
+	    game->empty_pile_image_height == game->card_height)
+	{
+		return;
+	}
+
+	if (!oc_image_is_nil(game->empty_pile_image)) {
+		oc_image_destroy(game->empty_pile_image);
+	}
+	if (!oc_image_is_nil(game->empty_foundation_image)) {
+		oc_image_destroy(game->empty_foundation_image);
+	}
+
+	game->empty_pile_image = bake_empty_pile_image(game, game->card_width, game->card_height,
+		(oc_color){ 0.42, 0.42, 0.42, 0.69 });
+	game->empty_foundation_image = bake_empty_pile_image(game, game->card_width, game->card_height,
+		(oc_color){ 0.69, 0.69, 0.69, 0.69 });
+	game->empty_pile_image_width = game->card_width;
+	game->empty_pile_image_height = game->card_height;
+}
+
+static inline void draw_empty_pile(GameState *game, DrawImage image, Pile *pile) {
+	draw_list_push(game, image, 0, pile->pos);
+}
+
+static Pile *board_pile(GameState *game, i32 index) {
+	if (index == 0) return &game->stock;
+	if (index == 1) return &game->waste;
+	if (index < 6)  return &game->foundations[index - 2];
+	return &game->tableau[index - 6];
+}
+
+static i32 board_pile_index(GameState *game, Pile *pile) {
+	if (pile == &game->stock) return 0;
+	if (pile == &game->waste) return 1;
+	if (pile >= game->foundations && pile < game->foundations + ARRAY_COUNT(game->foundations)) {
+		return 2 + (i32)(pile - game->foundations);
+	}
+	return 6 + (i32)(pile - game->tableau);
+}
+
+// a pile is static when none of its cards, apart from a stack being dragged
+// off of it, are moving
+static bool pile_is_static(GameState *game, Pile *pile) {
+	oc_list_for_reverse(pile->cards, card, Card, node) {
+		if (game->card_dragging == card) break;
+		if (card->pos.x != card->target_pos.x || card->pos.y != card->target_pos.y ||
+		    card->prev_pos.x != card->pos.x || card->prev_pos.y != card->pos.y)
+		{
+			return false;
 		}
 	}
+	return true;
 }
 
-static void draw_waste(void) {
-	oc_list_for_reverse(game.waste.cards, card, Card, node) {
-		if (game.card_dragging == card) break;
-		draw_card(card);
+static inline bool pile_in_layer(GameState *game, Pile *pile, DrawLayer layer) {
+	bool is_static = game->static_layer_pile_mask & (1u << board_pile_index(game, pile));
+	return is_static == (layer == LAYER_STATIC);
+}
+
+static void draw_stock(GameState *game, DrawLayer layer) {
+	trace_begin(game, "draw_stock");
+	if (layer == LAYER_STATIC) {
+		draw_empty_pile(game, DRAW_IMAGE_EMPTY_PILE, &game->stock);
 	}
+
+	if (oc_list_empty(game->stock.cards)) {
+		if (layer == LAYER_STATIC) {
+			draw_list_push(game, DRAW_IMAGE_RELOAD, 0, game->stock.pos);
+		}
+	} else if (pile_in_layer(game, &game->stock, layer)) {
+		oc_list_for_reverse(game->stock.cards, card, Card, node) {
+			draw_card(game, card);
+		}
+	}
+	trace_end(game, "draw_stock");
 }
 
-static void draw_foundations(void) {
+static void draw_waste(GameState *game, DrawLayer layer) {
+	if (!pile_in_layer(game, &game->waste, layer)) return;
+	trace_begin(game, "draw_waste");
+	oc_list_for_reverse(game->waste.cards, card, Card, node) {
+		if (game->card_dragging == card) break;
+		draw_card(game, card);
+	}
+	trace_end(game, "draw_waste");
+}
+
+static void draw_foundations(GameState *game, DrawLayer layer) {
+	trace_begin(game, "draw_foundations");
 	// draw empty pile outlines
-	u32 border_width = 2;
-	oc_set_width(border_width);
-	oc_set_color_rgba(0.69, 0.69, 0.69, 0.69);
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		oc_rounded_rectangle_stroke(
-			game.foundations[i].pos.x + (0.5f * border_width), 
-			game.foundations[i].pos.y + (0.5f * border_width), 
-			game.card_width - border_width, 
-			game.card_height - border_width,  
-			5);
+	if (layer == LAYER_STATIC) {
+		for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+			draw_empty_pile(game, DRAW_IMAGE_EMPTY_FOUNDATION, &game->foundations[i]);
+		}
 	}
 
 	// draw cards
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		oc_list_for_reverse(game.foundations[i].cards, card, Card, node) {
-			if (game.card_dragging == card) break;
-			draw_card(card);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		if (!pile_in_layer(game, &game->foundations[i], layer)) continue;
+		oc_list_for_reverse(game->foundations[i].cards, card, Card, node) {
+			if (game->card_dragging == card) break;
+			draw_card(game, card);
 		}
 	}
+	trace_end(game, "draw_foundations");
 }
 
-static void draw_tableau(void) {
+static void draw_tableau(GameState *game, DrawLayer layer) {
+	trace_begin(game, "draw_tableau");
 	// draw empty pile outlines
-	u32 border_width = 2;
-	oc_set_width(border_width);
-	oc_set_color_rgba(0.42, 0.42, 0.42, 0.69);
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		oc_rounded_rectangle_stroke(
-			game.tableau[i].pos.x + (0.5f * border_width), 
-			game.tableau[i].pos.y + (0.5f * border_width), 
-			game.card_width - border_width, 
-			game.card_height - border_width, 
-			5);
+	if (layer == LAYER_STATIC) {
+		for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+			draw_empty_pile(game, DRAW_IMAGE_EMPTY_PILE, &game->tableau[i]);
+		}
 	}
 
 	// draw cards
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		oc_list_for_reverse(game.tableau[i].cards, card, Card, node) {
-			if (game.card_dragging == card) break;
-			draw_card(card);
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		if (!pile_in_layer(game, &game->tableau[i], layer)) continue;
+		oc_list_for_reverse(game->tableau[i].cards, card, Card, node) {
+			if (game->card_dragging == card) break;
+			draw_card(game, card);
 		}
 	}
+	trace_end(game, "draw_tableau");
 }
 
-static void draw_dragging(void) {
-	if (!game.card_dragging) return;
+static void draw_dragging(GameState *game) {
+	if (!game->card_dragging) return;
 
-	for (oc_list_elt *node = &game.card_dragging->node; node; node = oc_list_prev(node)) {
+	trace_begin(game, "draw_dragging");
+	for (oc_list_elt *node = &game->card_dragging->node; node; node = oc_list_prev(node)) {
 		Card *card = oc_list_entry(node, Card, node);
-		draw_card(card);
+		draw_card(game, card);
 	}
+	trace_end(game, "draw_dragging");
 }
 
-static void draw_test_deck(Card *cards, i32 num_cards) {
+// draws the piles in two layers. piles at rest make up the static layer,
+// which is only rebuilt when a pile's version changes, a pile starts or stops
+// moving, dragging starts or stops, or the card back changes. otherwise its
+// sorted draws are replayed as is, and only moving piles and the dragged
+// stack go through the draw list.
+// NOTE(shaw): the orca canvas can't render into an offscreen image, so the
+// static layer is a cached list of draws and not a texture. replaying it still
+// issues one image draw per resting card every frame, what the cache saves is
+// collecting, overlap testing and sorting them.
+static void draw_board(GameState *game) {
+	trace_begin(game, "draw_board");
+	u32 pile_mask = 0;
+	for (i32 i=0; i<PILE_COUNT; ++i) {
+		if (pile_is_static(game, board_pile(game, i))) {
+			pile_mask |= 1u << i;
+		}
+	}
+
+	bool rebuild = !game->static_layer_valid
+		|| game->static_layer_board_version != game->board_version
+		|| game->static_layer_pile_mask != pile_mask
+		|| game->static_layer_card_back != game->selected_card_back
+		|| game->static_layer_card_dragging != game->card_dragging;
+
+	game->static_layer_pile_mask = pile_mask;
+
+	if (rebuild) {
+		assert(game->draw_list_count == 0);
+		draw_stock(game, LAYER_STATIC);
+		draw_waste(game, LAYER_STATIC);
+		draw_tableau(game, LAYER_STATIC);
+		draw_foundations(game, LAYER_STATIC);
+		game->static_layer_switches_unbatched = draw_list_sort(game, game->draw_list, game->draw_list_count);
+		memcpy(game->static_layer, game->draw_list, game->draw_list_count * sizeof(DrawItem));
+		game->static_layer_count = game->draw_list_count;
+		game->draw_list_count = 0;
+
+		game->static_layer_valid = true;
+		game->static_layer_board_version = game->board_version;
+		game->static_layer_card_back = game->selected_card_back;
+		game->static_layer_card_dragging = game->card_dragging;
+		game->draw_stats.static_layer_rebuilt = true;
+	}
+
+	draw_list_issue(game, game->static_layer, game->static_layer_count);
+	game->draw_stats.static_layer_items = game->static_layer_count;
+	game->draw_stats.image_switches_unbatched += game->static_layer_switches_unbatched;
+
+	draw_stock(game, LAYER_MOVING);
+	draw_waste(game, LAYER_MOVING);
+	draw_tableau(game, LAYER_MOVING);
+	draw_foundations(game, LAYER_MOVING);
+	draw_dragging(game);
+	draw_list_flush(game);
+	trace_end(game, "draw_board");
+}
+
+static void draw_test_deck(GameState *game, Card *cards, i32 num_cards) {
+	trace_begin(game, "draw_test_deck");
 	assert(SUIT_COUNT * CARD_KIND_COUNT == num_cards);
 	u32 card_width = 56;
 	u32 card_height = 78;
@@ -105,133 +372,168 @@ static void draw_test_deck(Card *cards, i32 num_cards) {
 			.y = suit * card_height,
 			.w = card_width, 
 			.h = card_height };
-		oc_image_draw_region(game.spritesheet, game.card_sprite_rects[suit][kind], dest);
+		canvas_image_draw_region(game, game->spritesheet, game->card_sprite_rects[suit][kind], dest);
 	}
 
-	for (i32 i=0; i<ARRAY_COUNT(game.card_backs); ++i) {
+	for (i32 i=0; i<ARRAY_COUNT(game->card_backs); ++i) {
 		oc_rect dest = {
 			.x = i * card_width,
 			.y = SUIT_COUNT * card_height,
 			.w = card_width, 
 			.h = card_height };
-		oc_image_draw(game.card_backs[i], dest);
+		canvas_image_draw(game, game->card_backs[i], dest);
 	}
+	trace_end(game, "draw_test_deck");
 }
 
 oc_str8 WIN_TEXT = OC_STR8_LIT("YOU WIN!");
 
-static void draw_win_text(void) {
+static void draw_win_text(GameState *game) {
+	trace_begin(game, "draw_win_text");
 	f32 font_size = 64;
 	f32 padding = 50;
-	oc_set_font(game.font);
-	oc_set_font_size(font_size);
-	oc_text_metrics metrics = oc_font_text_metrics(game.font, font_size, WIN_TEXT);
-	f32 x = 0.5f * (game.frame_size.x - metrics.ink.w);
-	f32 y = 0.5f * (game.frame_size.y + metrics.ink.h);
-
-	oc_set_color_rgba(0, 0, 0, 0.75); 
-	oc_rectangle_fill(
+	oc_set_font(game->font);
+	canvas_set_font_size(game, font_size);
+	oc_text_metrics metrics = oc_font_text_metrics(game->font, font_size, WIN_TEXT);
+	f32 x = 0.5f * (game->frame_size.x - metrics.ink.w);
+	f32 y = 0.5f * (game->frame_size.y + metrics.ink.h);
+
+	canvas_set_color_rgba(game, 0, 0, 0, 0.75); 
+	canvas_rectangle_fill(game,
 		x - padding, 
 		y - metrics.ink.h - padding, 
 		metrics.ink.w + 2.0f * padding, 
 		metrics.ink.h + 2.0f * padding);
 
-	oc_set_color_rgba(1, 1, 1, 1);
-	oc_text_fill(x, y, WIN_TEXT);
+	canvas_set_color_rgba(game, 1, 1, 1, 1);
+	canvas_text_fill(game, game->font, x, y, WIN_TEXT);
+	trace_end(game, "draw_win_text");
 }
 
-static void draw_select_card_back(void) {
-	if (!game.menu_card_backs_draw_box) {
+static void draw_select_card_back(GameState *game) {
+	if (!game->menu_card_backs_draw_box) {
 		return;
 	}
 
-	oc_rect draw_box = game.menu_card_backs_draw_box->rect;
-	i32 count_first_row = ARRAY_COUNT(game.card_backs) / 2;
+	trace_begin(game, "draw_select_card_back");
+	oc_rect draw_box = game->menu_card_backs_draw_box->rect;
+	i32 count_first_row = ARRAY_COUNT(game->card_backs) / 2;
 
-	for (i32 i=0; i<ARRAY_COUNT(game.card_backs); ++i) {
+	for (i32 i=0; i<ARRAY_COUNT(game->card_backs); ++i) {
 		f32 x = 0, y = 0;
 		if (i < count_first_row) {
-			x = draw_box.x + (i * (game.card_width + game.card_margin_x));
+			x = draw_box.x + (i * (game->card_width + game->card_margin_x));
 			y = draw_box.y;
 		} else {
-			x = draw_box.x + ((i - count_first_row) * (game.card_width + game.card_margin_x));
-			y = draw_box.y + game.card_height + game.card_margin_x;
+			x = draw_box.x + ((i - count_first_row) * (game->card_width + game->card_margin_x));
+			y = draw_box.y + game->card_height + game->card_margin_x;
 		}
 
-		oc_rect dest = { x, y, game.card_width, game.card_height };
-		oc_image_draw(game.card_backs[i], dest);
+		oc_rect dest = { x, y, game->card_width, game->card_height };
+		canvas_image_draw(game, game->card_backs[i], dest);
 
 		// draw outline around selected card back
-		if (i == game.selected_card_back) {
+		if (i == game->selected_card_back) {
 			u32 border_width = 2;
-			oc_set_width(border_width);
-			oc_set_color_rgba(0.12, 0.81, 0.22, 1);
-			oc_rectangle_stroke(
+			canvas_set_width(game, border_width);
+			canvas_set_color_rgba(game, 0.12, 0.81, 0.22, 1);
+			canvas_rectangle_stroke(game,
 				dest.x - (0.5f * border_width), 
 				dest.y - (0.5f * border_width), 
-				game.card_width + border_width, 
-				game.card_height + border_width);
+				game->card_width + border_width, 
+				game->card_height + border_width);
 		}
 	}	
+	trace_end(game, "draw_select_card_back");
 }
 
-static void draw_win_card_path(void) {
-	for (i32 i=0; i<game.win_card_path_index; ++i) {
-		CardPath path = game.win_card_path[i];
-		oc_rect dest = { path.pos.x, path.pos.y, game.card_width, game.card_height };
-		oc_image_draw_region(game.spritesheet, game.card_sprite_rects[path.suit][path.kind], dest);
+static void draw_win_card_path(GameState *game) {
+	trace_begin(game, "draw_win_card_path");
+	BlockArray *array = &game->win_card_path;
+	f32 w = game->card_width;
+	f32 h = game->card_height;
+	for (i32 block=0, first=0; first < array->count; ++block, first += array->block_items) {
+		CardPath *paths = array->blocks[block];
+		i32 count = array->count - first;
+		if (count > (i32)array->block_items) count = array->block_items;
+		for (i32 i=0; i<count; ++i) {
+			CardPath path = paths[i];
+			oc_rect dest = { path.pos.x, path.pos.y, w, h };
+			canvas_image_draw_region(game, game->spritesheet, game->card_sprite_rects[path.suit][path.kind], dest);
+		}
 	}
+	trace_end(game, "draw_win_card_path");
 }
 
-static void solitaire_draw(void) {
-    oc_canvas_select(game.canvas);
-	oc_surface_select(game.surface);
-	oc_set_color(game.bg_color);
-	oc_clear();
+// a track across the bottom of the board with a thumb at the position shown
+static void draw_history_bar(GameState *game) {
+	trace_begin(game, "draw_history_bar");
+	oc_rect rect = history_bar_rect(game);
+	f32 mid_y = rect.y + 0.5f * rect.h;
+	canvas_set_color_rgba(game, 1, 1, 1, 0.15f);
+	canvas_rounded_rectangle_fill(game, rect.x, mid_y - 2, rect.w, 4, 2);
 
-	switch (game.state) {
+	i32 last = game->history.positions.count - 1;
+	f32 x = rect.x + rect.w * game->history.cursor / last;
+	f32 alpha = history_reviewing(game) ? 0.9f : 0.5f;
+	canvas_set_color_rgba(game, 1, 1, 1, alpha);
+	canvas_rounded_rectangle_fill(game, x - 5, rect.y + 2, 10, rect.h - 4, 3);
+	trace_end(game, "draw_history_bar");
+}
+
+static void solitaire_draw(GameState *game) {
+	trace_begin(game, "solitaire_draw");
+    oc_canvas_select(game->canvas);
+	oc_surface_select(game->surface);
+	draw_record_begin(game);
+	canvas_set_color(game, game->bg_color);
+	canvas_clear(game);
+	game->draw_stats = (DrawStats){0};
+
+	switch (game->state) {
 	case STATE_SHOW_RULES: {
-		oc_rect dest = {0, 0, game.frame_size.x, game.frame_size.y};
-		oc_image rules_image = game.draw_three_mode ? game.rules_images[1] : game.rules_images[0];
-		oc_image_draw(rules_image, dest);
-		oc_ui_draw();
+		oc_rect dest = {0, 0, game->frame_size.x, game->frame_size.y};
+		oc_image rules_image = game->draw_three_mode ? game->rules_images[1] : game->rules_images[0];
+		canvas_image_draw(game, rules_image, dest);
+		canvas_ui_draw(game);
 		break;
 	}
 
 	case STATE_SELECT_CARD_BACK:
-		draw_stock();
-		draw_waste();
-		draw_tableau();
-		draw_foundations();
-		oc_ui_draw();
-		draw_select_card_back();
+		draw_board(game);
+		canvas_ui_draw(game);
+		draw_select_card_back(game);
 		break;
 
 	case STATE_WIN: {
-		draw_stock();
-		draw_tableau();
-		draw_foundations();
-		draw_win_card_path();
-		Card *card = game.win_moving_card;
-		if (card) {
-			oc_rect dest = { card->pos.x, card->pos.y, game.card_width, game.card_height };
-			oc_image_draw_region(game.spritesheet, game.card_sprite_rects[card->suit][card->kind], dest);
-		}
-		oc_ui_draw();
+		draw_board(game);
+		draw_win_card_path(game);
+		for (i32 i=0; i<game->win_flying_count; ++i) {
+			Card *card = game->win_flying_cards[i];
+			oc_vec2 pos = card_draw_pos(game, card);
+			oc_rect dest = { pos.x, pos.y, game->card_width, game->card_height };
+			canvas_image_draw_region(game, game->spritesheet, game->card_sprite_rects[card->suit][card->kind], dest);
+		}
+		canvas_ui_draw(game);
 		break;
 	}
 		
 	default:
-		draw_stock();
-		draw_waste();
-		draw_tableau();
-		draw_foundations();
-		draw_dragging();
-		oc_ui_draw();
+		draw_board(game);
+		if (history_bar_visible(game)) {
+			draw_history_bar(game);
+		}
+		canvas_ui_draw(game);
 		break;
 	}
 
-    oc_render(game.canvas);
-    oc_surface_present(game.surface);
+	trace_begin(game, "oc_render");
+    oc_render(game->canvas);
+	trace_end(game, "oc_render");
+	trace_begin(game, "oc_surface_present");
+    oc_surface_present(game->surface);
+	trace_end(game, "oc_surface_present");
+	latency_note_present(game);
+	trace_end(game, "solitaire_draw");
 }
 
@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------
+// draw record: every canvas call of a frame
+//------------------------------------------------------------------------------
+// NOTE(shaw): draw.c makes its canvas calls through the canvas_* wrappers
+// below. each one appends a DrawCommand to game->draw_record, with the color,
+// width and font size it draws with, then passes the call on. the record is
+// cleared when a frame starts drawing, so after solitaire_draw it holds the
+// whole frame. draw_record_stats and draw_record_dump read it back. the menu
+// is drawn by oc_ui_draw and only shows up as a single DRAW_COMMAND_UI.
+
+static const char *draw_command_keys[DRAW_COMMAND_KIND_COUNT] = {
+	[DRAW_COMMAND_CLEAR]               = "clear",
+	[DRAW_COMMAND_IMAGE]               = "image",
+	[DRAW_COMMAND_IMAGE_REGION]        = "image_region",
+	[DRAW_COMMAND_RECT_FILL]           = "rect_fill",
+	[DRAW_COMMAND_RECT_STROKE]         = "rect_stroke",
+	[DRAW_COMMAND_ROUNDED_RECT_FILL]   = "rounded_rect_fill",
+	[DRAW_COMMAND_ROUNDED_RECT_STROKE] = "rounded_rect_stroke",
+	[DRAW_COMMAND_TEXT]                = "text",
+	[DRAW_COMMAND_UI]                  = "ui",
+};
+
+static void draw_record_begin(GameState *game) {
+	game->draw_record.count = 0;
+	++game->draw_record_frame;
+}
+
+// blocks already allocated are indexed directly, with the block size known
+// here that is a shift and a mask. the record stops growing once the block
+// array is full, the canvas calls still go through and write their command to
+// the board's overflow slot
+static DrawCommand *draw_record_push(GameState *game, DrawCommandKind kind, oc_rect dest) {
+	BlockArray *record = &game->draw_record;
+	i32 index = record->count;
+	DrawCommand *command = index < record->block_count * DRAW_RECORD_BLOCK
+		? (DrawCommand*)record->blocks[index / DRAW_RECORD_BLOCK] + index % DRAW_RECORD_BLOCK
+		: block_array_get(record, index);
+	if (command) {
+		++record->count;
+	} else {
+		command = &game->draw_record_overflow;
+	}
+	command->dest = dest;
+	command->src = (oc_rect){0};
+	command->color = game->draw_record_color;
+	command->image = (oc_image){0};
+	command->text = (oc_str8){0};
+	command->width = game->draw_record_width;
+	command->radius = 0;
+	command->font_size = game->draw_record_font_size;
+	command->kind = (u8)kind;
+	return command;
+}
+
+//------------------------------------------------------------------------------
+// canvas wrappers
+//------------------------------------------------------------------------------
+static void canvas_set_color(GameState *game, oc_color color) {
+	game->draw_record_color = color;
+	oc_set_color(color);
+}
+
+static void canvas_set_color_rgba(GameState *game, f32 r, f32 g, f32 b, f32 a) {
+	canvas_set_color(game, (oc_color){ r, g, b, a });
+}
+
+static void canvas_set_width(GameState *game, f32 width) {
+	game->draw_record_width = width;
+	oc_set_width(width);
+}
+
+static void canvas_set_font_size(GameState *game, f32 size) {
+	game->draw_record_font_size = size;
+	oc_set_font_size(size);
+}
+
+static void canvas_clear(GameState *game) {
+	draw_record_push(game, DRAW_COMMAND_CLEAR, (oc_rect){ 0, 0, game->frame_size.x, game->frame_size.y });
+	oc_clear();
+}
+
+static void canvas_image_draw(GameState *game, oc_image image, oc_rect dest) {
+	draw_record_push(game, DRAW_COMMAND_IMAGE, dest)->image = image;
+	oc_image_draw(image, dest);
+}
+
+static void canvas_image_draw_region(GameState *game, oc_image image, oc_rect src, oc_rect dest) {
+	DrawCommand *command = draw_record_push(game, DRAW_COMMAND_IMAGE_REGION, dest);
+	command->image = image;
+	command->src = src;
+	oc_image_draw_region(image, src, dest);
+}
+
+static void canvas_rectangle_fill(GameState *game, f32 x, f32 y, f32 w, f32 h) {
+	draw_record_push(game, DRAW_COMMAND_RECT_FILL, (oc_rect){ x, y, w, h });
+	oc_rectangle_fill(x, y, w, h);
+}
+
+static void canvas_rectangle_stroke(GameState *game, f32 x, f32 y, f32 w, f32 h) {
+	draw_record_push(game, DRAW_COMMAND_RECT_STROKE, (oc_rect){ x, y, w, h });
+	oc_rectangle_stroke(x, y, w, h);
+}
+
+static void canvas_rounded_rectangle_fill(GameState *game, f32 x, f32 y, f32 w, f32 h, f32 r) {
+	draw_record_push(game, DRAW_COMMAND_ROUNDED_RECT_FILL, (oc_rect){ x, y, w, h })->radius = r;
+	oc_rounded_rectangle_fill(x, y, w, h, r);
+}
+
+// the text is measured with font so the command covers its ink box
+static void canvas_text_fill(GameState *game, oc_font font, f32 x, f32 y, oc_str8 text) {
+	oc_text_metrics metrics = oc_font_text_metrics(font, game->draw_record_font_size, text);
+	oc_rect ink = { x + metrics.ink.x, y + metrics.ink.y, metrics.ink.w, metrics.ink.h };
+	DrawCommand *command = draw_record_push(game, DRAW_COMMAND_TEXT, ink);
+	command->src = (oc_rect){ x, y, 0, 0 };
+	command->text = text;
+	oc_text_fill(x, y, text);
+}
+
+static void canvas_ui_draw(GameState *game) {
+	draw_record_push(game, DRAW_COMMAND_UI, (oc_rect){0});
+	oc_ui_draw();
+}
+
+//------------------------------------------------------------------------------
+// reading the record
+//------------------------------------------------------------------------------
+static oc_rect rect_clip(oc_rect r, oc_rect clip) {
+	f32 x0 = r.x > clip.x ? r.x : clip.x;
+	f32 y0 = r.y > clip.y ? r.y : clip.y;
+	f32 x1 = r.x + r.w < clip.x + clip.w ? r.x + r.w : clip.x + clip.w;
+	f32 y1 = r.y + r.h < clip.y + clip.h ? r.y + r.h : clip.y + clip.h;
+	if (x1 < x0) x1 = x0;
+	if (y1 < y0) y1 = y0;
+	return (oc_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+static inline f64 rect_area(oc_rect r) {
+	return (f64)r.w * r.h;
+}
+
+static inline bool draw_command_is_stroke(DrawCommand *command) {
+	return command->kind == DRAW_COMMAND_RECT_STROKE || command->kind == DRAW_COMMAND_ROUNDED_RECT_STROKE;
+}
+
+// the box a command can touch, strokes straddle their rect by half the width
+static oc_rect draw_command_bounds(DrawCommand *command) {
+	oc_rect r = command->dest;
+	if (draw_command_is_stroke(command)) {
+		f32 half = 0.5f * command->width;
+		r = (oc_rect){ r.x - half, r.y - half, r.w + command->width, r.h + command->width };
+	}
+	return r;
+}
+
+// pixels a command writes inside the frame. a stroke is the band between its
+// bounds and the rect shrunk by half the width, rounded corners are ignored
+static f64 draw_command_area(DrawCommand *command, oc_rect frame) {
+	f64 area = rect_area(rect_clip(draw_command_bounds(command), frame));
+	if (draw_command_is_stroke(command)) {
+		f32 half = 0.5f * command->width;
+		oc_rect r = command->dest;
+		oc_rect inner = { r.x + half, r.y + half, r.w - command->width, r.h - command->width };
+		if (inner.w > 0 && inner.h > 0) {
+			area -= rect_area(rect_clip(inner, frame));
+		}
+	}
+	return area;
+}
+
+// pixels inside at least one rect. each rect, snapped to whole pixels, adds
+// one at its top left corner and takes one off past its other corners, so a
+// running sum over rows and columns gives every pixel's depth. that is one
+// pass over the frame whatever the number of rects
+static f64 rect_union_area(oc_rect *rects, i32 count, i32 width, i32 height) {
+	if (count == 0 || width <= 0 || height <= 0) return 0;
+	i32 stride = width + 1;
+	oc_arena_scope scratch = oc_scratch_begin();
+	i32 *depth = oc_arena_push_array(scratch.arena, i32, stride * (height + 1));
+	memset(depth, 0, stride * (height + 1) * sizeof(i32));
+
+	for (i32 i=0; i<count; ++i) {
+		i32 x0 = (i32)(rects[i].x + 0.5f), x1 = (i32)(rects[i].x + rects[i].w + 0.5f);
+		i32 y0 = (i32)(rects[i].y + 0.5f), y1 = (i32)(rects[i].y + rects[i].h + 0.5f);
+		if (x1 <= x0 || y1 <= y0) continue;
+		depth[y0 * stride + x0] += 1;
+		depth[y0 * stride + x1] -= 1;
+		depth[y1 * stride + x0] -= 1;
+		depth[y1 * stride + x1] += 1;
+	}
+
+	u64 touched = 0;
+	for (i32 y=0; y<height; ++y) {
+		i32 *row = depth + y * stride;
+		i32 *above = row - stride;
+		i32 run = 0;
+		for (i32 x=0; x<width; ++x) {
+			run += row[x];
+			row[x] = run + (y > 0 ? above[x] : 0);
+			touched += row[x] > 0;
+		}
+	}
+	oc_scratch_end(scratch);
+	return (f64)touched;
+}
+
+static DrawRecordStats draw_record_stats(GameState *game) {
+	DrawRecordStats stats = {0};
+	BlockArray *record = &game->draw_record;
+	oc_rect frame = { 0, 0, game->frame_size.x, game->frame_size.y };
+
+	oc_arena_scope scratch = oc_scratch_begin();
+	oc_rect *touched = oc_arena_push_array(scratch.arena, oc_rect, record->count + 1);
+	i32 touched_count = 0;
+	u64 last_image = 0;
+	bool any_image = false;
+
+	for (i32 i=0; i<record->count; ++i) {
+		DrawCommand *command = block_array_get(record, i);
+		++stats.commands;
+		++stats.by_kind[command->kind];
+		if (command->kind == DRAW_COMMAND_UI) continue;
+
+		if (command->kind == DRAW_COMMAND_IMAGE || command->kind == DRAW_COMMAND_IMAGE_REGION) {
+			if (any_image && command->image.h != last_image) ++stats.image_switches;
+			last_image = command->image.h;
+			any_image = true;
+		}
+
+		stats.covered_area += draw_command_area(command, frame);
+		oc_rect bounds = rect_clip(draw_command_bounds(command), frame);
+		if (bounds.w > 0 && bounds.h > 0) {
+			touched[touched_count++] = bounds;
+		}
+	}
+	stats.union_area = rect_union_area(touched, touched_count, (i32)frame.w, (i32)frame.h);
+	stats.overdraw = stats.union_area > 0 ? (f32)(stats.covered_area / stats.union_area) : 0;
+
+	oc_scratch_end(scratch);
+	return stats;
+}
+
+static void draw_record_log_stats(GameState *game) {
+	DrawRecordStats stats = draw_record_stats(game);
+	oc_log_info("frame %u: %d draw commands, %d image switches, %.0f pixels drawn, %.0f touched, overdraw %.2f\n",
+		game->draw_record_frame, stats.commands, stats.image_switches, stats.covered_area, stats.union_area, stats.overdraw);
+	for (i32 i=0; i<DRAW_COMMAND_KIND_COUNT; ++i) {
+		if (stats.by_kind[i]) {
+			oc_log_info("  %s: %d\n", draw_command_keys[i], stats.by_kind[i]);
+		}
+	}
+}
+
+// writes the last frame as a json line per command
+static bool draw_record_dump(GameState *game, const char *path) {
+	oc_file file = oc_file_open(OC_STR8(path), OC_FILE_ACCESS_WRITE, OC_FILE_OPEN_CREATE | OC_FILE_OPEN_TRUNCATE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_error("Could not open file %s\n", path);
+		return false;
+	}
+
+	bool ok = true;
+	BlockArray *record = &game->draw_record;
+	for (i32 i=0; i<record->count && ok; ++i) {
+		DrawCommand *c = block_array_get(record, i);
+		char line[512];
+		i32 len = snprintf(line, sizeof(line),
+			"{\"frame\":%u,\"index\":%d,\"kind\":\"%s\",\"dest\":[%.1f,%.1f,%.1f,%.1f],\"color\":[%.3f,%.3f,%.3f,%.3f]",
+			game->draw_record_frame, i, draw_command_keys[c->kind],
+			c->dest.x, c->dest.y, c->dest.w, c->dest.h, c->color.r, c->color.g, c->color.b, c->color.a);
+		switch (c->kind) {
+		case DRAW_COMMAND_IMAGE:
+			len += snprintf(line + len, sizeof(line) - len, ",\"image\":%llu", c->image.h);
+			break;
+		case DRAW_COMMAND_IMAGE_REGION:
+			len += snprintf(line + len, sizeof(line) - len, ",\"image\":%llu,\"src\":[%.1f,%.1f,%.1f,%.1f]",
+				c->image.h, c->src.x, c->src.y, c->src.w, c->src.h);
+			break;
+		case DRAW_COMMAND_RECT_STROKE:
+			len += snprintf(line + len, sizeof(line) - len, ",\"width\":%.1f", c->width);
+			break;
+		case DRAW_COMMAND_ROUNDED_RECT_FILL:
+			len += snprintf(line + len, sizeof(line) - len, ",\"radius\":%.1f", c->radius);
+			break;
+		case DRAW_COMMAND_ROUNDED_RECT_STROKE:
+			len += snprintf(line + len, sizeof(line) - len, ",\"width\":%.1f,\"radius\":%.1f", c->width, c->radius);
+			break;
+		case DRAW_COMMAND_TEXT:
+			len += snprintf(line + len, sizeof(line) - len, ",\"origin\":[%.1f,%.1f],\"font_size\":%.1f,\"text\":\"%.*s\"",
+				c->src.x, c->src.y, c->font_size, oc_str8_ip(c->text));
+			break;
+		default:
+			break;
+		}
+		len += snprintf(line + len, sizeof(line) - len, "}\n");
+		if (len >= (i32)sizeof(line)) len = sizeof(line) - 1;
+		ok = oc_file_write(file, len, line) == (u64)len;
+	}
+	oc_file_close(file);
+	if (!ok) {
+		oc_log_error("Failed to write draw record to %s\n", path);
+	}
+	return ok;
+}
@@ -0,0 +1,706 @@
+// Native stand-in for the parts of the Orca API the game uses, so solitaire.c
+// can be compiled and driven outside the Orca runtime (benchmarks, tools).
+// Build with this directory on the include path instead of Orca's src dir.
+//
+// Canvas calls are not rendered, they only bump the counters in
+// headless.stats, raster.h draws a frame's recorded calls in software.
+// Files are plain stdio files relative to headless.file_root.
+// With headless.manual_clock set the monotonic clock reads headless.clock_time,
+// so a tool can run the game's frames faster than real time.
+// The ui calls are inert: no menus are shown and no buttons are ever pressed.
+
+#ifndef HEADLESS_ORCA_H
+#define HEADLESS_ORCA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#define ORCA_EXPORT
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef unsigned long long u64; // matches wasm32, so %llu formats work
+typedef int8_t   i8;
+typedef int16_t  i16;
+typedef int32_t  i32;
+typedef long long i64;
+typedef float    f32;
+typedef double   f64;
+
+//------------------------------------------------------------------------------
+// basic types
+//------------------------------------------------------------------------------
+typedef struct { f32 x, y; } oc_vec2;
+typedef union { struct { f32 x, y, w, h; }; f32 c[4]; } oc_rect;
+typedef union { struct { f32 r, g, b, a; }; f32 c[4]; } oc_color;
+
+typedef struct { u64 h; } oc_image;
+typedef struct { u64 h; } oc_surface;
+typedef struct { u64 h; } oc_canvas;
+typedef struct { u64 h; } oc_font;
+typedef struct { u64 h; } oc_file;
+
+typedef struct { char *ptr; size_t len; } oc_str8;
+
+#define OC_STR8(s) ((oc_str8){ (char*)(s), strlen(s) })
+#define OC_STR8_LIT(s) { (char*)(s), sizeof(s) - 1 }
+#define oc_str8_ip(s) (int)(s).len, (s).ptr
+
+//------------------------------------------------------------------------------
+// headless host state
+//------------------------------------------------------------------------------
+typedef struct {
+	u64 image_draws;
+	u64 image_region_draws;
+	u64 strokes;
+	u64 fills;
+	u64 texts;
+	u64 clears;
+	u64 renders;
+	u64 image_switches;
+} HeadlessStats;
+
+typedef struct {
+	HeadlessStats stats;
+	u64 last_image;
+	u64 next_handle;
+	bool log_info;
+	const char *file_root;
+	oc_vec2 window_size;
+	bool manual_clock;
+	f64 clock_time; // seconds, what the monotonic clock reads with manual_clock set
+} HeadlessState;
+
+static HeadlessState headless = { .log_info = true, .file_root = ".", .next_handle = 1 };
+
+//------------------------------------------------------------------------------
+// logging
+//------------------------------------------------------------------------------
+static void headless_log(FILE *stream, bool enabled, const char *fmt, ...) {
+	if (!enabled) return;
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stream, fmt, args);
+	va_end(args);
+	fputc('\n', stream);
+}
+
+#define oc_log_info(...)    headless_log(stdout, headless.log_info, __VA_ARGS__)
+#define oc_log_warning(...) headless_log(stderr, true, __VA_ARGS__)
+#define oc_log_error(...)   headless_log(stderr, true, __VA_ARGS__)
+
+//------------------------------------------------------------------------------
+// lists, same layout and semantics as Orca's intrusive lists
+//------------------------------------------------------------------------------
+#define oc_container_of(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+
+typedef struct oc_list_elt {
+	struct oc_list_elt *prev;
+	struct oc_list_elt *next;
+} oc_list_elt;
+
+typedef struct oc_list {
+	oc_list_elt *first;
+	oc_list_elt *last;
+} oc_list;
+
+#define oc_list_begin(l) (l).first
+#define oc_list_end(l) ((oc_list_elt*)0)
+#define oc_list_last(l) (l).last
+#define oc_list_next(elt) (elt)->next
+#define oc_list_prev(elt) (elt)->prev
+#define oc_list_entry(ptr, type, member) oc_container_of(ptr, type, member)
+#define oc_list_next_entry(list, elt, type, member) \
+	((elt->member.next != oc_list_end(list)) ? oc_list_entry(elt->member.next, type, member) : 0)
+#define oc_list_prev_entry(list, elt, type, member) \
+	((elt->member.prev != oc_list_end(list)) ? oc_list_entry(elt->member.prev, type, member) : 0)
+#define oc_list_checked_entry(elt, type, member) (((elt) != 0) ? oc_list_entry(elt, type, member) : 0)
+#define oc_list_first_entry(list, type, member) (oc_list_checked_entry(oc_list_begin(list), type, member))
+#define oc_list_last_entry(list, type, member) (oc_list_checked_entry(oc_list_last(list), type, member))
+#define oc_list_for(list, elt, type, member) \
+	for(type *elt = oc_list_checked_entry(oc_list_begin(list), type, member); elt != 0; \
+	    elt = oc_list_checked_entry(elt->member.next, type, member))
+#define oc_list_for_reverse(list, elt, type, member) \
+	for(type *elt = oc_list_checked_entry(oc_list_last(list), type, member); elt != 0; \
+	    elt = oc_list_checked_entry(elt->member.prev, type, member))
+
+static inline void oc_list_init(oc_list *list) {
+	list->first = list->last = 0;
+}
+
+static inline bool oc_list_empty(oc_list list) {
+	return list.first == 0 || list.last == 0;
+}
+
+static inline void oc_list_push(oc_list *list, oc_list_elt *elt) {
+	elt->next = list->first;
+	elt->prev = 0;
+	if (list->first) {
+		list->first->prev = elt;
+	} else {
+		list->last = elt;
+	}
+	list->first = elt;
+}
+
+static inline oc_list_elt *oc_list_pop(oc_list *list) {
+	oc_list_elt *elt = list->first;
+	if (elt) {
+		list->first = elt->next;
+		if (list->first) {
+			list->first->prev = 0;
+		} else {
+			list->last = 0;
+		}
+		elt->next = elt->prev = 0;
+	}
+	return elt;
+}
+
+#define oc_list_pop_entry(list, type, member) (oc_list_empty(*list) ? 0 : oc_list_entry(oc_list_pop(list), type, member))
+
+//------------------------------------------------------------------------------
+// memory arenas, one fixed block each is enough for the game's use
+//------------------------------------------------------------------------------
+typedef struct {
+	char *ptr;
+	u64 offset;
+	u64 cap;
+} oc_arena;
+
+typedef struct {
+	oc_arena *arena;
+	u64 offset;
+} oc_arena_scope;
+
+static void oc_arena_init(oc_arena *arena) {
+	memset(arena, 0, sizeof(*arena));
+}
+
+static void oc_arena_cleanup(oc_arena *arena) {
+	free(arena->ptr);
+	memset(arena, 0, sizeof(*arena));
+}
+
+#define HEADLESS_ARENA_SIZE (64ull << 20)
+
+// arenas get one fixed block on first use, so pointers stay valid
+static void *oc_arena_push(oc_arena *arena, u64 size) {
+	if (!arena->ptr) {
+		arena->cap = HEADLESS_ARENA_SIZE;
+		arena->ptr = malloc(arena->cap);
+	}
+	u64 offset = (arena->offset + 15) & ~(u64)15;
+	if (offset + size > arena->cap) {
+		fprintf(stderr, "headless arena out of memory (%llu bytes)\n", (unsigned long long)(offset + size));
+		abort();
+	}
+	arena->offset = offset + size;
+	return arena->ptr + offset;
+}
+
+static inline void oc_arena_clear(oc_arena *arena) {
+	arena->offset = 0;
+}
+
+#define oc_arena_push_type(arena, type) ((type*)oc_arena_push(arena, sizeof(type)))
+#define oc_arena_push_array(arena, type, count) ((type*)oc_arena_push(arena, sizeof(type) * (count)))
+
+static oc_arena_scope oc_arena_scope_begin(oc_arena *arena) {
+	return (oc_arena_scope){ arena, arena->offset };
+}
+
+static void oc_arena_scope_end(oc_arena_scope scope) {
+	scope.arena->offset = scope.offset;
+}
+
+static _Thread_local oc_arena headless_scratch_arena; // one per thread, sim.c steps boards on several
+
+static oc_arena_scope oc_scratch_begin(void) {
+	return oc_arena_scope_begin(&headless_scratch_arena);
+}
+
+static void oc_scratch_end(oc_arena_scope scope) {
+	oc_arena_scope_end(scope);
+}
+
+//------------------------------------------------------------------------------
+// clock
+//------------------------------------------------------------------------------
+typedef enum {
+	OC_CLOCK_MONOTONIC,
+	OC_CLOCK_UPTIME,
+	OC_CLOCK_DATE,
+} oc_clock_kind;
+
+// the real monotonic clock, whatever manual_clock says
+static f64 headless_wall_time(void) {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (f64)counter.QuadPart / (f64)frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static f64 oc_clock_time(oc_clock_kind clock) {
+	if (clock == OC_CLOCK_DATE) {
+		struct timespec ts;
+		timespec_get(&ts, TIME_UTC);
+		return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+	}
+	if (headless.manual_clock) {
+		return headless.clock_time;
+	}
+	return headless_wall_time();
+}
+
+//------------------------------------------------------------------------------
+// window, surface, canvas
+//------------------------------------------------------------------------------
+static inline u64 headless_handle(void) {
+	return headless.next_handle++;
+}
+
+static void oc_window_set_title(oc_str8 title) {}
+static void oc_window_set_size(oc_vec2 size) { headless.window_size = size; }
+static oc_surface oc_surface_canvas(void) { return (oc_surface){ headless_handle() }; }
+static oc_canvas oc_canvas_create(void) { return (oc_canvas){ headless_handle() }; }
+static void oc_canvas_select(oc_canvas canvas) {}
+static void oc_surface_select(oc_surface surface) {}
+static void oc_surface_present(oc_surface surface) {}
+
+static void oc_render(oc_canvas canvas) {
+	++headless.stats.renders;
+	headless.last_image = 0;
+}
+
+static void oc_set_color(oc_color color) {}
+static inline void oc_set_color_rgba(f32 r, f32 g, f32 b, f32 a) {}
+static void oc_set_width(f32 width) {}
+
+static void oc_clear(void) {
+	++headless.stats.clears;
+}
+
+//------------------------------------------------------------------------------
+// images
+//------------------------------------------------------------------------------
+static inline oc_image oc_image_nil(void) { return (oc_image){ 0 }; }
+static inline bool oc_image_is_nil(oc_image image) { return image.h == 0; }
+
+// images remember where their pixels came from, a path under file_root or a
+// copy of the rgba8 pixels, so a software renderer (raster.h) can draw them
+typedef struct {
+	u64 handle;
+	char path[256];
+	u32 width, height;
+	u8 *pixels;
+} HeadlessImage;
+
+#define HEADLESS_MAX_IMAGES 64
+static HeadlessImage headless_images[HEADLESS_MAX_IMAGES];
+
+static HeadlessImage *headless_image(oc_image image) {
+	for (i32 i=0; i<HEADLESS_MAX_IMAGES; ++i) {
+		if (image.h && headless_images[i].handle == image.h) return &headless_images[i];
+	}
+	return NULL;
+}
+
+static HeadlessImage *headless_image_slot(oc_image image) {
+	HeadlessImage *slot = NULL;
+	for (i32 i=0; i<HEADLESS_MAX_IMAGES && !slot; ++i) {
+		if (headless_images[i].handle == 0) slot = &headless_images[i];
+	}
+	if (slot) {
+		memset(slot, 0, sizeof(*slot));
+		slot->handle = image.h;
+	}
+	return slot;
+}
+
+static oc_image oc_image_create_from_path(oc_surface surface, oc_str8 path, bool flip) {
+	oc_image image = { headless_handle() };
+	HeadlessImage *slot = headless_image_slot(image);
+	if (slot) {
+		snprintf(slot->path, sizeof(slot->path), "%s/%.*s", headless.file_root, oc_str8_ip(path));
+	}
+	return image;
+}
+
+static oc_image oc_image_create_from_rgba8(oc_surface surface, u32 width, u32 height, u8 *pixels) {
+	oc_image image = { headless_handle() };
+	HeadlessImage *slot = headless_image_slot(image);
+	if (slot) {
+		slot->width = width;
+		slot->height = height;
+		slot->pixels = malloc((size_t)width * height * 4);
+		if (slot->pixels) memcpy(slot->pixels, pixels, (size_t)width * height * 4);
+	}
+	return image;
+}
+
+static void oc_image_destroy(oc_image image) {
+	HeadlessImage *slot = headless_image(image);
+	if (slot) {
+		free(slot->pixels);
+		memset(slot, 0, sizeof(*slot));
+	}
+}
+
+static inline void headless_use_image(oc_image image) {
+	if (image.h != headless.last_image) {
+		++headless.stats.image_switches;
+		headless.last_image = image.h;
+	}
+}
+
+static void oc_image_draw(oc_image image, oc_rect rect) {
+	headless_use_image(image);
+	++headless.stats.image_draws;
+}
+
+static void oc_image_draw_region(oc_image image, oc_rect src, oc_rect dst) {
+	headless_use_image(image);
+	++headless.stats.image_region_draws;
+}
+
+//------------------------------------------------------------------------------
+// paths and text
+//------------------------------------------------------------------------------
+static void oc_rectangle_stroke(f32 x, f32 y, f32 w, f32 h) { ++headless.stats.strokes; }
+static inline void oc_rounded_rectangle_stroke(f32 x, f32 y, f32 w, f32 h, f32 r) { ++headless.stats.strokes; }
+static void oc_rectangle_fill(f32 x, f32 y, f32 w, f32 h) { ++headless.stats.fills; }
+static void oc_rounded_rectangle_fill(f32 x, f32 y, f32 w, f32 h, f32 r) { ++headless.stats.fills; }
+
+typedef struct { u32 firstCodePoint; u32 count; } oc_unicode_range;
+
+#define OC_UNICODE_BASIC_LATIN                        ((oc_unicode_range){ 0x0000, 127 })
+#define OC_UNICODE_C1_CONTROLS_AND_LATIN_1_SUPPLEMENT ((oc_unicode_range){ 0x0080, 127 })
+#define OC_UNICODE_LATIN_EXTENDED_A                   ((oc_unicode_range){ 0x0100, 127 })
+#define OC_UNICODE_LATIN_EXTENDED_B                   ((oc_unicode_range){ 0x0180, 207 })
+#define OC_UNICODE_SPECIALS                           ((oc_unicode_range){ 0xfff0, 15 })
+
+typedef struct {
+	oc_rect ink;
+	oc_rect logical;
+	oc_vec2 advance;
+} oc_text_metrics;
+
+static oc_font oc_font_create_from_path(oc_str8 path, u32 count, oc_unicode_range *ranges) {
+	return (oc_font){ headless_handle() };
+}
+
+static void oc_set_font(oc_font font) {}
+static void oc_set_font_size(f32 size) {}
+
+// rough metrics so layout code gets sensible numbers
+static oc_text_metrics oc_font_text_metrics(oc_font font, f32 size, oc_str8 text) {
+	f32 w = 0.55f * size * (f32)text.len;
+	return (oc_text_metrics){
+		.ink = { 0, -0.7f * size, w, 0.7f * size },
+		.logical = { 0, -0.8f * size, w, size },
+		.advance = { w, 0 },
+	};
+}
+
+static void oc_text_fill(f32 x, f32 y, oc_str8 text) { ++headless.stats.texts; }
+
+//------------------------------------------------------------------------------
+// files, backed by stdio
+//------------------------------------------------------------------------------
+typedef u16 oc_file_access;
+enum {
+	OC_FILE_ACCESS_NONE  = 0,
+	OC_FILE_ACCESS_READ  = 1 << 1,
+	OC_FILE_ACCESS_WRITE = 1 << 2,
+};
+
+typedef u16 oc_file_open_flags;
+enum {
+	OC_FILE_OPEN_NONE     = 0,
+	OC_FILE_OPEN_APPEND   = 1 << 1,
+	OC_FILE_OPEN_TRUNCATE = 1 << 2,
+	OC_FILE_OPEN_CREATE   = 1 << 3,
+};
+
+typedef enum {
+	OC_IO_OK = 0,
+	OC_IO_ERR_UNKNOWN,
+	OC_IO_ERR_NO_ENTRY,
+} oc_io_error;
+
+typedef enum {
+	OC_FILE_SEEK_SET,
+	OC_FILE_SEEK_END,
+	OC_FILE_SEEK_CURRENT,
+} oc_file_whence;
+
+typedef enum {
+	OC_FILE_UNKNOWN,
+	OC_FILE_REGULAR,
+} oc_file_type;
+
+typedef struct { i64 seconds; u64 fraction; } oc_datestamp;
+
+typedef struct {
+	u64 uid;
+	oc_file_type type;
+	u16 perm;
+	u64 size;
+	oc_datestamp creationDate;
+	oc_datestamp accessDate;
+	oc_datestamp modificationDate;
+} oc_file_status;
+
+#define HEADLESS_MAX_FILES 64
+static FILE *headless_files[HEADLESS_MAX_FILES];
+static oc_io_error headless_file_errors[HEADLESS_MAX_FILES];
+
+static oc_file oc_file_open(oc_str8 path, oc_file_access rights, oc_file_open_flags flags) {
+	u64 slot = 1;
+	while (slot < HEADLESS_MAX_FILES && headless_files[slot]) ++slot;
+	if (slot == HEADLESS_MAX_FILES) return (oc_file){ 0 };
+
+	char full_path[1024];
+	snprintf(full_path, sizeof(full_path), "%s/%.*s", headless.file_root, oc_str8_ip(path));
+
+	const char *mode = "rb";
+	if (rights & OC_FILE_ACCESS_WRITE) {
+		if (flags & OC_FILE_OPEN_APPEND) {
+			mode = (rights & OC_FILE_ACCESS_READ) ? "a+b" : "ab";
+		} else if (flags & OC_FILE_OPEN_TRUNCATE) {
+			mode = (rights & OC_FILE_ACCESS_READ) ? "w+b" : "wb";
+		} else {
+			// open for writing without truncating, creating it if allowed
+			FILE *existing = fopen(full_path, "r+b");
+			if (existing) {
+				headless_files[slot] = existing;
+				headless_file_errors[slot] = OC_IO_OK;
+				return (oc_file){ slot };
+			}
+			mode = (flags & OC_FILE_OPEN_CREATE) ? "w+b" : "r+b";
+		}
+	}
+
+	FILE *file = fopen(full_path, mode);
+	if (!file) {
+		// the nil handle reports OC_IO_ERR_NO_ENTRY
+		return (oc_file){ 0 };
+	}
+	headless_files[slot] = file;
+	headless_file_errors[slot] = OC_IO_OK;
+	return (oc_file){ slot };
+}
+
+static oc_io_error oc_file_last_error(oc_file file) {
+	if (file.h == 0 || file.h >= HEADLESS_MAX_FILES) return OC_IO_ERR_NO_ENTRY;
+	return headless_file_errors[file.h];
+}
+
+static u64 oc_file_read(oc_file file, u64 size, char *buffer) {
+	if (file.h == 0 || !headless_files[file.h]) return 0;
+	return fread(buffer, 1, size, headless_files[file.h]);
+}
+
+static u64 oc_file_write(oc_file file, u64 size, char *buffer) {
+	if (file.h == 0 || !headless_files[file.h]) return 0;
+	return fwrite(buffer, 1, size, headless_files[file.h]);
+}
+
+static inline i64 oc_file_seek(oc_file file, i64 offset, oc_file_whence whence) {
+	if (file.h == 0 || !headless_files[file.h]) return -1;
+	int origin = whence == OC_FILE_SEEK_SET ? SEEK_SET : (whence == OC_FILE_SEEK_END ? SEEK_END : SEEK_CUR);
+	if (fseek(headless_files[file.h], (long)offset, origin) != 0) return -1;
+	return ftell(headless_files[file.h]);
+}
+
+static inline i64 oc_file_pos(oc_file file) {
+	if (file.h == 0 || !headless_files[file.h]) return -1;
+	return ftell(headless_files[file.h]);
+}
+
+static u64 oc_file_size(oc_file file) {
+	if (file.h == 0 || !headless_files[file.h]) return 0;
+	FILE *f = headless_files[file.h];
+	long pos = ftell(f);
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, pos, SEEK_SET);
+	return size < 0 ? 0 : (u64)size;
+}
+
+static oc_file_status oc_file_get_status(oc_file file) {
+	return (oc_file_status){ .type = OC_FILE_REGULAR, .size = oc_file_size(file) };
+}
+
+static void oc_file_close(oc_file file) {
+	if (file.h == 0 || file.h >= HEADLESS_MAX_FILES || !headless_files[file.h]) return;
+	fclose(headless_files[file.h]);
+	headless_files[file.h] = NULL;
+}
+
+//------------------------------------------------------------------------------
+// input
+//------------------------------------------------------------------------------
+typedef enum {
+	OC_MOUSE_LEFT   = 0x00,
+	OC_MOUSE_RIGHT  = 0x01,
+	OC_MOUSE_MIDDLE = 0x02,
+} oc_mouse_button;
+
+typedef int oc_scan_code;
+
+typedef enum {
+	OC_KEY_SPACE = 32,
+	OC_KEY_0 = 48, OC_KEY_1, OC_KEY_2, OC_KEY_3, OC_KEY_4,
+	OC_KEY_5, OC_KEY_6, OC_KEY_7, OC_KEY_8, OC_KEY_9,
+	OC_KEY_A = 65, OC_KEY_B, OC_KEY_C, OC_KEY_D, OC_KEY_E, OC_KEY_F, OC_KEY_G,
+	OC_KEY_H, OC_KEY_I, OC_KEY_J, OC_KEY_K, OC_KEY_L, OC_KEY_M, OC_KEY_N,
+	OC_KEY_O, OC_KEY_P, OC_KEY_Q, OC_KEY_R, OC_KEY_S, OC_KEY_T, OC_KEY_U,
+	OC_KEY_V, OC_KEY_W, OC_KEY_X, OC_KEY_Y, OC_KEY_Z,
+	OC_KEY_ESCAPE = 256,
+	OC_KEY_ENTER = 257,
+	OC_KEY_RIGHT = 262,
+	OC_KEY_LEFT = 263,
+	OC_KEY_LEFT_SHIFT = 340,
+	OC_KEY_LEFT_CONTROL = 341,
+	OC_KEY_LEFT_ALT = 342,
+} oc_key_code;
+
+typedef struct oc_event oc_event;
+
+//------------------------------------------------------------------------------
+// ui, inert
+//------------------------------------------------------------------------------
+typedef struct {
+	oc_color white, fill0, fill2, bg1, border;
+	f32 roundnessSmall;
+} oc_ui_theme;
+
+typedef struct {
+	oc_arena frameArena;
+	oc_ui_theme *theme;
+} oc_ui_context;
+
+typedef enum {
+	OC_UI_SIZE_TEXT,
+	OC_UI_SIZE_PIXELS,
+	OC_UI_SIZE_CHILDREN,
+	OC_UI_SIZE_PARENT,
+} oc_ui_size_kind;
+
+typedef struct {
+	oc_ui_size_kind kind;
+	f32 value;
+	f32 relax;
+} oc_ui_size;
+
+typedef enum { OC_UI_AXIS_X, OC_UI_AXIS_Y } oc_ui_axis;
+typedef enum { OC_UI_ALIGN_START, OC_UI_ALIGN_END, OC_UI_ALIGN_CENTER } oc_ui_align;
+
+typedef struct {
+	struct { oc_ui_size width, height; } size;
+	struct {
+		oc_ui_axis axis;
+		struct { oc_ui_align x, y; } align;
+		struct { f32 x, y; } margin;
+		f32 spacing;
+	} layout;
+	oc_color color, bgColor, borderColor;
+	oc_font font;
+	f32 fontSize, borderSize, roundness;
+} oc_ui_style;
+
+typedef u64 oc_ui_style_mask;
+enum {
+	OC_UI_STYLE_SIZE_WIDTH      = 1 << 1,
+	OC_UI_STYLE_SIZE_HEIGHT     = 1 << 2,
+	OC_UI_STYLE_LAYOUT_AXIS     = 1 << 3,
+	OC_UI_STYLE_LAYOUT_ALIGN_X  = 1 << 4,
+	OC_UI_STYLE_LAYOUT_ALIGN_Y  = 1 << 5,
+	OC_UI_STYLE_LAYOUT_SPACING  = 1 << 6,
+	OC_UI_STYLE_LAYOUT_MARGIN_X = 1 << 7,
+	OC_UI_STYLE_LAYOUT_MARGIN_Y = 1 << 8,
+	OC_UI_STYLE_COLOR           = 1 << 12,
+	OC_UI_STYLE_BG_COLOR        = 1 << 13,
+	OC_UI_STYLE_BORDER_COLOR    = 1 << 14,
+	OC_UI_STYLE_BORDER_SIZE     = 1 << 15,
+	OC_UI_STYLE_ROUNDNESS       = 1 << 16,
+	OC_UI_STYLE_FONT            = 1 << 17,
+	OC_UI_STYLE_FONT_SIZE       = 1 << 18,
+	OC_UI_STYLE_SIZE            = OC_UI_STYLE_SIZE_WIDTH | OC_UI_STYLE_SIZE_HEIGHT,
+	OC_UI_STYLE_LAYOUT_MARGINS  = OC_UI_STYLE_LAYOUT_MARGIN_X | OC_UI_STYLE_LAYOUT_MARGIN_Y,
+};
+
+typedef u32 oc_ui_flags;
+enum {
+	OC_UI_FLAG_NONE            = 0,
+	OC_UI_FLAG_CLICKABLE       = 1 << 0,
+	OC_UI_FLAG_CLIP            = 1 << 8,
+	OC_UI_FLAG_DRAW_BACKGROUND = 1 << 9,
+	OC_UI_FLAG_DRAW_BORDER     = 1 << 11,
+	OC_UI_FLAG_DRAW_TEXT       = 1 << 12,
+};
+
+typedef struct { oc_rect rect; } oc_ui_box;
+
+typedef struct {
+	oc_ui_box *box;
+	bool pressed, released, clicked, doubleClicked, rightPressed, dragging, hovering;
+} oc_ui_sig;
+
+typedef struct { int unused; } oc_ui_pattern;
+typedef enum { OC_UI_SEL_STATUS = 7 } oc_ui_selector_kind;
+typedef enum { OC_UI_HOVER = 1 << 1, OC_UI_ACTIVE = 1 << 3 } oc_ui_status;
+typedef struct { oc_ui_selector_kind kind; oc_ui_status status; } oc_ui_selector;
+
+static oc_ui_theme headless_ui_theme;
+static oc_ui_context headless_ui_context = { .theme = &headless_ui_theme };
+static oc_ui_box headless_ui_box;
+
+static void oc_ui_init(oc_ui_context *context) { context->theme = &headless_ui_theme; }
+static oc_ui_context *oc_ui_get_context(void) { return &headless_ui_context; }
+static void oc_ui_process_event(oc_event *event) {}
+static void oc_ui_draw(void) {}
+static void oc_ui_style_next(oc_ui_style *style, oc_ui_style_mask mask) {}
+static void oc_ui_pattern_push(oc_arena *arena, oc_ui_pattern *pattern, oc_ui_selector selector) {}
+static void oc_ui_style_match_before(oc_ui_pattern pattern, oc_ui_style *style, oc_ui_style_mask mask) {}
+static oc_ui_box *oc_ui_box_make(const char *name, oc_ui_flags flags) { return &headless_ui_box; }
+static oc_ui_box *oc_ui_box_begin(const char *name, oc_ui_flags flags) { return &headless_ui_box; }
+static oc_ui_box *oc_ui_box_end(void) { return &headless_ui_box; }
+static oc_ui_box *oc_ui_box_top(void) { return &headless_ui_box; }
+static bool oc_ui_box_closed(oc_ui_box *box) { return true; }
+static oc_ui_sig oc_ui_box_sig(oc_ui_box *box) { return (oc_ui_sig){ .box = box }; }
+static void oc_ui_label(const char *label) {}
+static oc_ui_sig oc_ui_button(const char *label) { return (oc_ui_sig){ .box = &headless_ui_box }; }
+static oc_ui_box *oc_ui_menu_begin(const char *label) { return &headless_ui_box; }
+static void oc_ui_menu_end(void) {}
+static void oc_ui_begin_frame(oc_vec2 size, oc_ui_style *style, oc_ui_style_mask mask) {}
+static void oc_ui_end_frame(void) {}
+
+#define headless_ui_scope(begin, end) for (int __scope = ((begin), 0); __scope < 1; ++__scope, (end))
+#define oc_ui_frame(size, style, mask) headless_ui_scope(oc_ui_begin_frame(size, style, mask), oc_ui_end_frame())
+#define oc_ui_menu_bar(name)           headless_ui_scope(oc_ui_box_begin(name, 0), oc_ui_box_end())
+#define oc_ui_panel(name, flags)       headless_ui_scope(oc_ui_box_begin(name, flags), oc_ui_box_end())
+#define oc_ui_container(name, flags)   headless_ui_scope(oc_ui_box_begin(name, flags), oc_ui_box_end())
+
+#endif // HEADLESS_ORCA_H
@@ -0,0 +1,1391 @@
+// Software rasterizer for the canvas calls of a recorded frame, so board states
+// can be rendered to PNG natively, without the Orca runtime or a GPU (golden
+// images and render benchmarks, see render.c). Include it after solitaire.c,
+// raster_draw_record draws game->draw_record (draw_record.c) as it stands
+// after solitaire_draw.
+//
+// Pixels are premultiplied RGBA8, one u32 each with red in the low byte.
+// Images are decoded from their PNG (or the rgba8 pixels they were created
+// from) the first time they are drawn and resampled once per destination size,
+// so drawing a card afterwards is a row copy where it is opaque and an SSE2
+// blend along its rounded corners. Destination rects are rounded to whole
+// pixels. Fills and strokes are blended with their area coverage. There is no
+// TrueType rasterizer here, text is drawn in a 5x7 bitmap font laid out in the
+// headless font metrics. The menu (DRAW_COMMAND_UI) is not drawn, the headless
+// ui is inert.
+
+#ifndef HEADLESS_RASTER_H
+#define HEADLESS_RASTER_H
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTER_SSE2 1
+#endif
+
+#define RASTER_MAX_SOURCES 64
+#define RASTER_SCALED_SLOTS 1024 // power of two, open addressing
+#define RASTER_LZ_WINDOW 32768
+#define RASTER_LZ_HASH_BITS 15
+#define RASTER_LZ_CHAIN 32
+#define RASTER_HUFFMAN_BITS 15
+#define RASTER_COVER_SPANS 8
+
+// a decoded image, premultiplied
+typedef struct {
+	u64 handle;
+	u32 width, height;
+	u32 *pixels;
+	bool failed;
+} RasterSource;
+
+// per row of a scaled image: pixels in [x0, x1) have any alpha, the ones in
+// [opaque0, opaque1) are the longest run that is fully opaque
+typedef struct {
+	u16 x0, x1;
+	u16 opaque0, opaque1;
+} RasterRow;
+
+// an image region resampled to the size it is drawn at
+typedef struct {
+	u64 handle;
+	i32 src_x, src_y, src_w, src_h;
+	i32 width, height;
+	u32 *pixels;
+	RasterRow *rows;
+} RasterScaled;
+
+// the columns of a frame row that commands later in the frame cover with
+// opaque pixels, as up to RASTER_COVER_SPANS disjoint [x0, x1) spans
+typedef struct {
+	u16 x0[RASTER_COVER_SPANS];
+	u16 x1[RASTER_COVER_SPANS];
+	u32 count;
+} RasterCover;
+
+// an image command placed in the frame, and the rows of it left to draw
+typedef struct {
+	RasterScaled *scaled;
+	i32 x, y;
+	i32 row0, row1;
+} RasterDraw;
+
+typedef struct {
+	u32 width, height;
+	u32 *pixels;
+	RasterSource sources[RASTER_MAX_SOURCES];
+	i32 source_count;
+	RasterScaled *scaled;
+	i32 scaled_count;
+	RasterCover *cover; // one per row
+	RasterDraw *draws;  // one per command
+	i32 draw_capacity;
+} Raster;
+
+//------------------------------------------------------------------------------
+// pixels
+//------------------------------------------------------------------------------
+static inline i32 raster_round(f32 value) {
+	return (i32)floorf(value + 0.5f);
+}
+
+static inline u32 raster_unit(f32 value) {
+	if (value <= 0) return 0;
+	if (value >= 1) return 255;
+	return (u32)(value * 255.0f + 0.5f);
+}
+
+static u32 raster_color(oc_color color) {
+	f32 a = color.a < 0 ? 0 : color.a > 1 ? 1 : color.a;
+	return raster_unit(color.r * a) | raster_unit(color.g * a) << 8 | raster_unit(color.b * a) << 16 | raster_unit(a) << 24;
+}
+
+// every channel times scale/255, rounded
+static inline u32 raster_scale(u32 color, u32 scale) {
+	u32 rb = (color & 0x00ff00ff) * scale + 0x00800080;
+	rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+	u32 ag = ((color >> 8) & 0x00ff00ff) * scale + 0x00800080;
+	ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+	return rb | ag;
+}
+
+// premultiplied source over destination
+static inline u32 raster_over(u32 src, u32 dst) {
+	return src + raster_scale(dst, 255 - (src >> 24));
+}
+
+#if RASTER_SSE2
+// raster_over on four pixels, with the same rounding so both paths match
+static inline __m128i raster_over4(__m128i src, __m128i dst) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i bias = _mm_set1_epi16(128);
+	__m128i full = _mm_set1_epi16(255);
+	__m128i src_lo = _mm_unpacklo_epi8(src, zero);
+	__m128i src_hi = _mm_unpackhi_epi8(src, zero);
+	__m128i inv_lo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_lo, 0xff), 0xff));
+	__m128i inv_hi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_hi, 0xff), 0xff));
+	__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv_lo), bias);
+	__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv_hi), bias);
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+	return _mm_add_epi8(src, _mm_packus_epi16(lo, hi));
+}
+#endif
+
+static void raster_fill_span(u32 *dst, u32 color, i32 count) {
+	i32 i = 0;
+#if RASTER_SSE2
+	__m128i s = _mm_set1_epi32((int)color);
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_si128((__m128i*)(dst + i), s);
+	}
+#endif
+	for (; i < count; ++i) dst[i] = color;
+}
+
+// four fully transparent source pixels are skipped, they leave dst as it is
+static void raster_blend_span(u32 *dst, const u32 *src, i32 count) {
+	i32 i = 0;
+#if RASTER_SSE2
+	__m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff) continue;
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), raster_over4(s, d));
+	}
+#endif
+	for (; i < count; ++i) dst[i] = raster_over(src[i], dst[i]);
+}
+
+static void raster_blend_color(u32 *dst, u32 color, i32 count) {
+	if ((color >> 24) == 255) {
+		raster_fill_span(dst, color, count);
+		return;
+	}
+	i32 i = 0;
+#if RASTER_SSE2
+	__m128i s = _mm_set1_epi32((int)color);
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), raster_over4(s, d));
+	}
+#endif
+	for (; i < count; ++i) dst[i] = raster_over(color, dst[i]);
+}
+
+static inline void raster_blend_pixel(Raster *raster, i32 x, i32 y, u32 color, f32 coverage) {
+	u32 scale = raster_unit(coverage);
+	if (scale == 0) return;
+	u32 *dst = raster->pixels + (u64)y * raster->width + x;
+	*dst = raster_over(raster_scale(color, scale), *dst);
+}
+
+//------------------------------------------------------------------------------
+// inflate, for reading PNGs
+//------------------------------------------------------------------------------
+static const u16 raster_length_base[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const u8 raster_length_extra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const u16 raster_dist_base[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const u8 raster_dist_extra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+// indexed by the next RASTER_HUFFMAN_BITS input bits, symbol | code length << 16
+typedef struct {
+	u32 table[1 << RASTER_HUFFMAN_BITS];
+} RasterHuffman;
+
+typedef struct {
+	const u8 *data;
+	u64 size, pos;
+	u64 bits;
+	i32 bit_count;
+	u8 *out;
+	u64 out_size, out_pos;
+	RasterHuffman literals, distances, lengths;
+} RasterInflate;
+
+static inline void raster_inflate_refill(RasterInflate *z) {
+	while (z->bit_count <= 56) {
+		u64 byte = z->pos < z->size ? z->data[z->pos] : 0;
+		++z->pos;
+		z->bits |= byte << z->bit_count;
+		z->bit_count += 8;
+	}
+}
+
+static inline u32 raster_inflate_bits(RasterInflate *z, i32 count) {
+	if (count == 0) return 0;
+	raster_inflate_refill(z);
+	u32 value = (u32)(z->bits & ((1ull << count) - 1));
+	z->bits >>= count;
+	z->bit_count -= count;
+	return value;
+}
+
+static inline u32 raster_reverse_bits(u32 code, i32 count) {
+	u32 result = 0;
+	for (i32 i=0; i<count; ++i) {
+		result = (result << 1) | (code & 1);
+		code >>= 1;
+	}
+	return result;
+}
+
+static bool raster_huffman_build(RasterHuffman *huffman, const u8 *lengths, i32 count) {
+	u32 length_counts[16] = {0};
+	u32 next_code[16] = {0};
+	for (i32 i=0; i<count; ++i) ++length_counts[lengths[i]];
+	length_counts[0] = 0;
+	u32 code = 0;
+	for (i32 bits=1; bits<16; ++bits) {
+		code = (code + length_counts[bits - 1]) << 1;
+		next_code[bits] = code;
+	}
+
+	memset(huffman->table, 0, sizeof(huffman->table));
+	for (i32 symbol=0; symbol<count; ++symbol) {
+		i32 length = lengths[symbol];
+		if (length == 0) continue;
+		u32 reversed = raster_reverse_bits(next_code[length]++, length);
+		if (reversed >= (1u << length)) return false;
+		for (u32 fill=reversed; fill < (1u << RASTER_HUFFMAN_BITS); fill += 1u << length) {
+			huffman->table[fill] = (u32)symbol | (u32)length << 16;
+		}
+	}
+	return true;
+}
+
+static inline i32 raster_huffman_decode(RasterInflate *z, RasterHuffman *huffman) {
+	raster_inflate_refill(z);
+	u32 entry = huffman->table[z->bits & ((1u << RASTER_HUFFMAN_BITS) - 1)];
+	i32 length = entry >> 16;
+	if (length == 0) return -1;
+	z->bits >>= length;
+	z->bit_count -= length;
+	return entry & 0xffff;
+}
+
+static bool raster_inflate_block(RasterInflate *z) {
+	for (;;) {
+		i32 symbol = raster_huffman_decode(z, &z->literals);
+		if (symbol < 0) return false;
+		if (symbol < 256) {
+			if (z->out_pos >= z->out_size) return false;
+			z->out[z->out_pos++] = (u8)symbol;
+			continue;
+		}
+		if (symbol == 256) return true;
+
+		symbol -= 257;
+		if (symbol >= 29) return false;
+		u32 length = raster_length_base[symbol] + raster_inflate_bits(z, raster_length_extra[symbol]);
+		i32 dist_symbol = raster_huffman_decode(z, &z->distances);
+		if (dist_symbol < 0 || dist_symbol >= 30) return false;
+		u32 dist = raster_dist_base[dist_symbol] + raster_inflate_bits(z, raster_dist_extra[dist_symbol]);
+		if (dist > z->out_pos || length > z->out_size - z->out_pos) return false;
+
+		u8 *to = z->out + z->out_pos;
+		const u8 *from = to - dist;
+		for (u32 i=0; i<length; ++i) to[i] = from[i];
+		z->out_pos += length;
+	}
+}
+
+static bool raster_inflate_dynamic_tables(RasterInflate *z) {
+	static const u8 order[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+	i32 literal_count = raster_inflate_bits(z, 5) + 257;
+	i32 dist_count = raster_inflate_bits(z, 5) + 1;
+	i32 length_count = raster_inflate_bits(z, 4) + 4;
+
+	u8 code_lengths[19] = {0};
+	for (i32 i=0; i<length_count; ++i) code_lengths[order[i]] = (u8)raster_inflate_bits(z, 3);
+	if (!raster_huffman_build(&z->lengths, code_lengths, 19)) return false;
+
+	u8 lengths[286 + 30] = {0};
+	i32 total = literal_count + dist_count;
+	for (i32 i=0; i<total; ) {
+		i32 symbol = raster_huffman_decode(z, &z->lengths);
+		i32 repeat = 0;
+		u8 value = 0;
+		if (symbol < 0) return false;
+		if (symbol < 16) {
+			lengths[i++] = (u8)symbol;
+			continue;
+		} else if (symbol == 16) {
+			if (i == 0) return false;
+			value = lengths[i - 1];
+			repeat = 3 + raster_inflate_bits(z, 2);
+		} else if (symbol == 17) {
+			repeat = 3 + raster_inflate_bits(z, 3);
+		} else {
+			repeat = 11 + raster_inflate_bits(z, 7);
+		}
+		if (i + repeat > total) return false;
+		while (repeat--) lengths[i++] = value;
+	}
+	return raster_huffman_build(&z->literals, lengths, literal_count)
+		&& raster_huffman_build(&z->distances, lengths + literal_count, dist_count);
+}
+
+// inflates a zlib stream into out, which must be exactly the inflated size
+static bool raster_inflate(const u8 *data, u64 size, u8 *out, u64 out_size) {
+	if (size < 2 || (data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+		return false;
+	}
+	RasterInflate *z = malloc(sizeof(RasterInflate));
+	if (!z) return false;
+	z->data = data;
+	z->size = size;
+	z->pos = 2;
+	z->bits = 0;
+	z->bit_count = 0;
+	z->out = out;
+	z->out_size = out_size;
+	z->out_pos = 0;
+
+	bool ok = true;
+	bool final = false;
+	while (ok && !final) {
+		final = raster_inflate_bits(z, 1);
+		u32 type = raster_inflate_bits(z, 2);
+		if (type == 0) {
+			raster_inflate_bits(z, z->bit_count & 7);
+			u32 length = raster_inflate_bits(z, 16);
+			u32 check = raster_inflate_bits(z, 16);
+			if ((length ^ 0xffff) != check || length > out_size - z->out_pos) {
+				ok = false;
+				break;
+			}
+			for (u32 i=0; i<length; ++i) z->out[z->out_pos++] = (u8)raster_inflate_bits(z, 8);
+		} else if (type == 1) {
+			u8 lengths[288 + 30];
+			for (i32 i=0; i<288; ++i) lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+			for (i32 i=0; i<30; ++i) lengths[288 + i] = 5;
+			ok = raster_huffman_build(&z->literals, lengths, 288)
+				&& raster_huffman_build(&z->distances, lengths + 288, 30)
+				&& raster_inflate_block(z);
+		} else if (type == 2) {
+			ok = raster_inflate_dynamic_tables(z) && raster_inflate_block(z);
+		} else {
+			ok = false;
+		}
+		// bytes still in the bit buffer were read ahead, past the stream is corrupt
+		if (z->pos - z->bit_count / 8 > z->size) ok = false;
+	}
+	ok = ok && z->out_pos == out_size;
+	free(z);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// PNG files
+//------------------------------------------------------------------------------
+static u32 raster_crc_table[256];
+
+static u32 raster_crc32(u32 crc, const u8 *data, u64 size) {
+	if (raster_crc_table[1] == 0) {
+		for (u32 i=0; i<256; ++i) {
+			u32 c = i;
+			for (i32 k=0; k<8; ++k) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			raster_crc_table[i] = c;
+		}
+	}
+	crc = ~crc;
+	for (u64 i=0; i<size; ++i) crc = raster_crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+static u32 raster_adler32(const u8 *data, u64 size) {
+	u32 a = 1, b = 0;
+	while (size) {
+		u64 chunk = size < 5552 ? size : 5552;
+		for (u64 i=0; i<chunk; ++i) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += chunk;
+		size -= chunk;
+	}
+	return (b << 16) | a;
+}
+
+static inline u32 raster_read_u32(const u8 *p) {
+	return (u32)p[0] << 24 | (u32)p[1] << 16 | (u32)p[2] << 8 | p[3];
+}
+
+static inline void raster_write_u32(u8 *p, u32 value) {
+	p[0] = (u8)(value >> 24);
+	p[1] = (u8)(value >> 16);
+	p[2] = (u8)(value >> 8);
+	p[3] = (u8)value;
+}
+
+static u8 *raster_read_file(const char *path, u64 *size) {
+	FILE *file = fopen(path, "rb");
+	if (!file) return NULL;
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	u8 *data = length > 0 ? malloc(length) : NULL;
+	if (data && fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	*size = data ? (u64)length : 0;
+	return data;
+}
+
+static inline u8 raster_paeth(u8 a, u8 b, u8 c) {
+	i32 p = (i32)a + b - c;
+	i32 pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	if (pa <= pb && pa <= pc) return a;
+	return pb <= pc ? b : c;
+}
+
+// undoes the per row filters in place, rows are 1 filter byte + stride bytes
+static bool raster_png_unfilter(u8 *raw, u32 height, u64 stride, u32 bpp) {
+	u8 *prev = NULL;
+	for (u32 y=0; y<height; ++y) {
+		u8 *row = raw + y * (stride + 1);
+		u8 filter = row[0];
+		u8 *p = row + 1;
+		for (u64 i=0; i<stride; ++i) {
+			u8 a = i >= bpp ? p[i - bpp] : 0;
+			u8 b = prev ? prev[i] : 0;
+			u8 c = prev && i >= bpp ? prev[i - bpp] : 0;
+			switch (filter) {
+			case 0: break;
+			case 1: p[i] += a; break;
+			case 2: p[i] += b; break;
+			case 3: p[i] += (u8)(((u32)a + b) >> 1); break;
+			case 4: p[i] += raster_paeth(a, b, c); break;
+			default: return false;
+			}
+		}
+		prev = p;
+	}
+	return true;
+}
+
+// 8 bit sample x of a row, sub byte depths are scaled up unless they index
+// a palette, 16 bit depths keep their high byte
+static inline u32 raster_png_sample(const u8 *row, u64 index, u32 depth, bool palette) {
+	if (depth == 8) return row[index];
+	if (depth == 16) return row[2 * index];
+	u32 per_byte = 8 / depth;
+	u32 shift = 8 - depth * (1 + index % per_byte);
+	u32 value = (row[index / per_byte] >> shift) & ((1u << depth) - 1);
+	return palette ? value : value * 255 / ((1u << depth) - 1);
+}
+
+// decodes a non interlaced PNG to premultiplied pixels, NULL if it can't
+static u32 *raster_png_decode(const u8 *file, u64 size, u32 *width, u32 *height) {
+	static const u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	if (size < 8 || memcmp(file, signature, 8) != 0) return NULL;
+
+	u32 w = 0, h = 0, depth = 0, color_type = 0, interlace = 0;
+	u8 palette[256][4];
+	u32 palette_count = 0;
+	memset(palette, 0, sizeof(palette));
+	for (i32 i=0; i<256; ++i) palette[i][3] = 255;
+	u8 *idat = NULL;
+	u64 idat_size = 0;
+	bool ok = true;
+
+	for (u64 pos=8; ok && pos + 12 <= size; ) {
+		u32 length = raster_read_u32(file + pos);
+		const u8 *type = file + pos + 4;
+		const u8 *data = file + pos + 8;
+		if (length > size - pos - 12) {
+			ok = false;
+			break;
+		}
+		if (memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+			w = raster_read_u32(data);
+			h = raster_read_u32(data + 4);
+			depth = data[8];
+			color_type = data[9];
+			interlace = data[12];
+		} else if (memcmp(type, "PLTE", 4) == 0) {
+			palette_count = length / 3 < 256 ? length / 3 : 256;
+			for (u32 i=0; i<palette_count; ++i) {
+				palette[i][0] = data[3*i];
+				palette[i][1] = data[3*i + 1];
+				palette[i][2] = data[3*i + 2];
+			}
+		} else if (memcmp(type, "tRNS", 4) == 0 && color_type == 3) {
+			for (u32 i=0; i<length && i<256; ++i) palette[i][3] = data[i];
+		} else if (memcmp(type, "IDAT", 4) == 0) {
+			u8 *grown = realloc(idat, idat_size + length);
+			if (!grown) {
+				ok = false;
+				break;
+			}
+			idat = grown;
+			memcpy(idat + idat_size, data, length);
+			idat_size += length;
+		} else if (memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		pos += 12 + (u64)length;
+	}
+
+	u32 channels = color_type == 0 ? 1 : color_type == 2 ? 3 : color_type == 3 ? 1 : color_type == 4 ? 2 : color_type == 6 ? 4 : 0;
+	bool depth_ok = depth == 8 || (depth == 16 && color_type != 3) || ((depth == 1 || depth == 2 || depth == 4) && (color_type == 0 || color_type == 3));
+	ok = ok && idat && w && h && channels && depth_ok && interlace == 0 && (color_type != 3 || palette_count);
+
+	u32 *pixels = NULL;
+	u8 *raw = NULL;
+	u64 stride = ((u64)w * channels * depth + 7) / 8;
+	if (ok) {
+		raw = malloc((stride + 1) * h);
+		pixels = malloc((u64)w * h * sizeof(u32));
+		ok = raw && pixels
+			&& raster_inflate(idat, idat_size, raw, (stride + 1) * h)
+			&& raster_png_unfilter(raw, h, stride, (channels * depth + 7) / 8);
+	}
+
+	for (u32 y=0; ok && y<h; ++y) {
+		const u8 *row = raw + y * (stride + 1) + 1;
+		u32 *out = pixels + (u64)y * w;
+		for (u32 x=0; x<w; ++x) {
+			u32 r, g, b, a = 255;
+			switch (color_type) {
+			case 0: r = g = b = raster_png_sample(row, x, depth, false); break;
+			case 2:
+				r = raster_png_sample(row, 3*x, depth, false);
+				g = raster_png_sample(row, 3*x + 1, depth, false);
+				b = raster_png_sample(row, 3*x + 2, depth, false);
+				break;
+			case 3: {
+				u8 *entry = palette[raster_png_sample(row, x, depth, true)];
+				r = entry[0]; g = entry[1]; b = entry[2]; a = entry[3];
+				break;
+			}
+			case 4:
+				r = g = b = raster_png_sample(row, 2*x, depth, false);
+				a = raster_png_sample(row, 2*x + 1, depth, false);
+				break;
+			default:
+				r = raster_png_sample(row, 4*x, depth, false);
+				g = raster_png_sample(row, 4*x + 1, depth, false);
+				b = raster_png_sample(row, 4*x + 2, depth, false);
+				a = raster_png_sample(row, 4*x + 3, depth, false);
+				break;
+			}
+			out[x] = raster_scale(r | g << 8 | b << 16, a) | a << 24;
+		}
+	}
+
+	free(idat);
+	free(raw);
+	if (!ok) {
+		free(pixels);
+		return NULL;
+	}
+	*width = w;
+	*height = h;
+	return pixels;
+}
+
+static u32 *raster_read_png(const char *path, u32 *width, u32 *height) {
+	u64 size = 0;
+	u8 *file = raster_read_file(path, &size);
+	if (!file) return NULL;
+	u32 *pixels = raster_png_decode(file, size, width, height);
+	free(file);
+	return pixels;
+}
+
+//------------------------------------------------------------------------------
+// deflate, for writing PNGs: greedy LZ77 matches in one fixed huffman block
+//------------------------------------------------------------------------------
+typedef struct {
+	u8 *data;
+	u64 size, capacity;
+	u64 bits;
+	i32 bit_count;
+	bool failed;
+} RasterWriter;
+
+static void raster_put_bytes(RasterWriter *writer, const void *bytes, u64 count) {
+	if (writer->size + count > writer->capacity) {
+		u64 capacity = writer->capacity ? writer->capacity : 1 << 16;
+		while (capacity < writer->size + count) capacity *= 2;
+		u8 *grown = realloc(writer->data, capacity);
+		if (!grown) {
+			writer->failed = true;
+			return;
+		}
+		writer->data = grown;
+		writer->capacity = capacity;
+	}
+	memcpy(writer->data + writer->size, bytes, count);
+	writer->size += count;
+}
+
+static inline void raster_put_bits(RasterWriter *writer, u32 value, i32 count) {
+	writer->bits |= (u64)value << writer->bit_count;
+	writer->bit_count += count;
+	while (writer->bit_count >= 8) {
+		u8 byte = (u8)writer->bits;
+		raster_put_bytes(writer, &byte, 1);
+		writer->bits >>= 8;
+		writer->bit_count -= 8;
+	}
+}
+
+// huffman codes go most significant bit first
+static inline void raster_put_code(RasterWriter *writer, u32 code, i32 count) {
+	raster_put_bits(writer, raster_reverse_bits(code, count), count);
+}
+
+static void raster_put_literal(RasterWriter *writer, u32 symbol) {
+	if (symbol < 144)      raster_put_code(writer, 0x30 + symbol, 8);
+	else if (symbol < 256) raster_put_code(writer, 0x190 + symbol - 144, 9);
+	else if (symbol < 280) raster_put_code(writer, symbol - 256, 7);
+	else                   raster_put_code(writer, 0xc0 + symbol - 280, 8);
+}
+
+static void raster_put_match(RasterWriter *writer, u32 length, u32 dist) {
+	i32 code = 28;
+	while (raster_length_base[code] > length) --code;
+	raster_put_literal(writer, 257 + code);
+	raster_put_bits(writer, length - raster_length_base[code], raster_length_extra[code]);
+	code = 29;
+	while (raster_dist_base[code] > dist) --code;
+	raster_put_code(writer, code, 5);
+	raster_put_bits(writer, dist - raster_dist_base[code], raster_dist_extra[code]);
+}
+
+static inline u32 raster_lz_hash(const u8 *p) {
+	u32 v = (u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16;
+	return (v * 2654435761u) >> (32 - RASTER_LZ_HASH_BITS);
+}
+
+static void raster_deflate(RasterWriter *writer, const u8 *data, u64 size) {
+	i32 *head = malloc(sizeof(i32) << RASTER_LZ_HASH_BITS);
+	i32 *prev = malloc(sizeof(i32) * RASTER_LZ_WINDOW);
+	if (!head || !prev) {
+		free(head);
+		free(prev);
+		writer->failed = true;
+		return;
+	}
+	for (i32 i=0; i<(1 << RASTER_LZ_HASH_BITS); ++i) head[i] = -1;
+
+	raster_put_bits(writer, 1, 1); // final
+	raster_put_bits(writer, 1, 2); // fixed huffman
+	for (i64 pos=0; pos<(i64)size; ) {
+		u32 best_length = 0, best_dist = 0;
+		if (pos + 3 <= (i64)size) {
+			i64 max_length = (i64)size - pos < 258 ? (i64)size - pos : 258;
+			u32 hash = raster_lz_hash(data + pos);
+			i64 candidate = head[hash];
+			for (i32 chain=0; chain<RASTER_LZ_CHAIN && candidate >= 0 && pos - candidate < RASTER_LZ_WINDOW; ++chain) {
+				u32 length = 0;
+				while (length < max_length && data[candidate + length] == data[pos + length]) ++length;
+				if (length > best_length) {
+					best_length = length;
+					best_dist = (u32)(pos - candidate);
+					if (length == max_length) break;
+				}
+				i64 next = prev[candidate & (RASTER_LZ_WINDOW - 1)];
+				if (next >= candidate) break;
+				candidate = next;
+			}
+		}
+
+		u32 advance = best_length >= 3 ? best_length : 1;
+		if (best_length >= 3) {
+			raster_put_match(writer, best_length, best_dist);
+		} else {
+			raster_put_literal(writer, data[pos]);
+		}
+		for (u32 i=0; i<advance; ++i, ++pos) {
+			if (pos + 3 > (i64)size) continue;
+			u32 hash = raster_lz_hash(data + pos);
+			prev[pos & (RASTER_LZ_WINDOW - 1)] = head[hash];
+			head[hash] = (i32)pos;
+		}
+	}
+	raster_put_literal(writer, 256);
+	if (writer->bit_count) raster_put_bits(writer, 0, 8 - writer->bit_count);
+
+	free(head);
+	free(prev);
+}
+
+static void raster_put_chunk(RasterWriter *writer, const char *type, const u8 *data, u32 size) {
+	u8 header[8];
+	raster_write_u32(header, size);
+	memcpy(header + 4, type, 4);
+	raster_put_bytes(writer, header, 8);
+	raster_put_bytes(writer, data, size);
+	u8 crc[4];
+	raster_write_u32(crc, raster_crc32(raster_crc32(0, (const u8*)type, 4), data, size));
+	raster_put_bytes(writer, crc, 4);
+}
+
+// writes premultiplied pixels as a PNG, RGB when they are all opaque
+static bool raster_write_png_pixels(const char *path, const u32 *pixels, u32 width, u32 height) {
+	bool opaque = true;
+	for (u64 i=0; i<(u64)width * height && opaque; ++i) opaque = (pixels[i] >> 24) == 255;
+	u32 channels = opaque ? 3 : 4;
+	u64 stride = (u64)width * channels;
+
+	// each row gets the filter with the smallest sum of absolute differences
+	u8 *filtered = malloc((stride + 1) * height);
+	u8 *rows = malloc(stride * 2);
+	u8 *trial = malloc(stride);
+	if (!filtered || !rows || !trial) {
+		free(filtered);
+		free(rows);
+		free(trial);
+		return false;
+	}
+	u8 *prev = rows, *row = rows + stride;
+	memset(prev, 0, stride);
+	for (u32 y=0; y<height; ++y) {
+		for (u32 x=0; x<width; ++x) {
+			u32 p = pixels[(u64)y * width + x];
+			u32 a = p >> 24;
+			u8 *out = row + (u64)x * channels;
+			for (u32 c=0; c<3; ++c) {
+				u32 value = (p >> (8 * c)) & 0xff;
+				out[c] = (u8)(a == 255 || a == 0 ? value : (value * 255 + a / 2) / a);
+			}
+			if (channels == 4) out[3] = (u8)a;
+		}
+
+		u8 *dest = filtered + y * (stride + 1);
+		u64 best_cost = ~0ull;
+		for (u8 filter=0; filter<5; ++filter) {
+			u64 cost = 0;
+			for (u64 i=0; i<stride; ++i) {
+				u8 a = i >= channels ? row[i - channels] : 0;
+				u8 b = y ? prev[i] : 0;
+				u8 c = y && i >= channels ? prev[i - channels] : 0;
+				u8 predict = filter == 0 ? 0 : filter == 1 ? a : filter == 2 ? b : filter == 3 ? (u8)(((u32)a + b) >> 1) : raster_paeth(a, b, c);
+				trial[i] = row[i] - predict;
+				cost += trial[i] < 128 ? trial[i] : 256 - trial[i];
+			}
+			if (cost < best_cost) {
+				best_cost = cost;
+				dest[0] = filter;
+				memcpy(dest + 1, trial, stride);
+			}
+		}
+		u8 *swap = prev;
+		prev = row;
+		row = swap;
+	}
+	free(rows);
+	free(trial);
+
+	RasterWriter zlib = {0};
+	u8 zlib_header[2] = { 0x78, 0x01 };
+	raster_put_bytes(&zlib, zlib_header, 2);
+	raster_deflate(&zlib, filtered, (stride + 1) * height);
+	u8 adler[4];
+	raster_write_u32(adler, raster_adler32(filtered, (stride + 1) * height));
+	raster_put_bytes(&zlib, adler, 4);
+	free(filtered);
+
+	RasterWriter png = {0};
+	static const u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	u8 ihdr[13] = {0};
+	raster_write_u32(ihdr, width);
+	raster_write_u32(ihdr + 4, height);
+	ihdr[8] = 8;
+	ihdr[9] = opaque ? 2 : 6;
+	raster_put_bytes(&png, signature, 8);
+	raster_put_chunk(&png, "IHDR", ihdr, 13);
+	raster_put_chunk(&png, "IDAT", zlib.data, (u32)zlib.size);
+	raster_put_chunk(&png, "IEND", NULL, 0);
+
+	bool ok = !zlib.failed && !png.failed;
+	FILE *file = ok ? fopen(path, "wb") : NULL;
+	ok = file && fwrite(png.data, 1, png.size, file) == png.size;
+	if (file && fclose(file) != 0) ok = false;
+	free(zlib.data);
+	free(png.data);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// images
+//------------------------------------------------------------------------------
+static RasterSource *raster_source(Raster *raster, oc_image image) {
+	for (i32 i=0; i<raster->source_count; ++i) {
+		if (raster->sources[i].handle == image.h) return &raster->sources[i];
+	}
+	if (raster->source_count == RASTER_MAX_SOURCES) return NULL;
+
+	RasterSource *source = &raster->sources[raster->source_count++];
+	memset(source, 0, sizeof(*source));
+	source->handle = image.h;
+	HeadlessImage *info = headless_image(image);
+	if (info && info->pixels) {
+		source->width = info->width;
+		source->height = info->height;
+		source->pixels = malloc((u64)info->width * info->height * sizeof(u32));
+		for (u64 i=0; source->pixels && i<(u64)info->width * info->height; ++i) {
+			u8 *p = info->pixels + 4 * i;
+			source->pixels[i] = raster_scale(p[0] | p[1] << 8 | p[2] << 16, p[3]) | (u32)p[3] << 24;
+		}
+	} else if (info) {
+		source->pixels = raster_read_png(info->path, &source->width, &source->height);
+	}
+	if (!source->pixels) {
+		source->failed = true;
+		oc_log_error("raster: could not load image %llu (%s)\n", image.h, info ? info->path : "unknown");
+	}
+	return source;
+}
+
+// box filters the source region down (or up) to width x height, every output
+// pixel is the area weighted average of the texels under it
+static void raster_resample(RasterSource *source, i32 sx, i32 sy, i32 sw, i32 sh, u32 *out, i32 width, i32 height) {
+	f32 *rows = malloc(sizeof(f32) * 4 * (u64)sh * width);
+	if (!rows) {
+		memset(out, 0, sizeof(u32) * (u64)width * height);
+		return;
+	}
+	f32 scale_x = (f32)sw / width;
+	f32 scale_y = (f32)sh / height;
+
+	for (i32 y=0; y<sh; ++y) {
+		const u32 *texels = source->pixels + (u64)(sy + y) * source->width + sx;
+		f32 *dest = rows + 4 * (u64)y * width;
+		for (i32 x=0; x<width; ++x) {
+			f32 start = x * scale_x, end = start + scale_x;
+			f32 sum[4] = {0}, total = 0;
+			for (i32 i=(i32)start; i<sw && i<end; ++i) {
+				f32 weight = (i + 1 < end ? i + 1 : end) - (i > start ? i : start);
+				if (weight <= 0) continue;
+				u32 p = texels[i];
+				for (i32 c=0; c<4; ++c) sum[c] += weight * ((p >> (8 * c)) & 0xff);
+				total += weight;
+			}
+			for (i32 c=0; c<4; ++c) dest[4*x + c] = total > 0 ? sum[c] / total : 0;
+		}
+	}
+
+	for (i32 y=0; y<height; ++y) {
+		f32 start = y * scale_y, end = start + scale_y;
+		for (i32 x=0; x<width; ++x) {
+			f32 sum[4] = {0}, total = 0;
+			for (i32 i=(i32)start; i<sh && i<end; ++i) {
+				f32 weight = (i + 1 < end ? i + 1 : end) - (i > start ? i : start);
+				if (weight <= 0) continue;
+				f32 *p = rows + 4 * ((u64)i * width + x);
+				for (i32 c=0; c<4; ++c) sum[c] += weight * p[c];
+				total += weight;
+			}
+			u32 pixel = 0;
+			for (i32 c=0; c<4; ++c) {
+				f32 value = total > 0 ? sum[c] / total : 0;
+				pixel |= (u32)(value + 0.5f > 255 ? 255 : value + 0.5f) << (8 * c);
+			}
+			out[(u64)y * width + x] = pixel;
+		}
+	}
+	free(rows);
+}
+
+static void raster_scaled_rows(RasterScaled *scaled) {
+	for (i32 y=0; y<scaled->height; ++y) {
+		const u32 *row = scaled->pixels + (u64)y * scaled->width;
+		RasterRow *info = &scaled->rows[y];
+		i32 x0 = 0, x1 = scaled->width;
+		while (x0 < x1 && (row[x0] >> 24) == 0) ++x0;
+		while (x1 > x0 && (row[x1 - 1] >> 24) == 0) --x1;
+		i32 best0 = x0, best1 = x0;
+		for (i32 x=x0; x<x1; ) {
+			if ((row[x] >> 24) != 255) {
+				++x;
+				continue;
+			}
+			i32 run = x;
+			while (x < x1 && (row[x] >> 24) == 255) ++x;
+			if (x - run > best1 - best0) {
+				best0 = run;
+				best1 = x;
+			}
+		}
+		*info = (RasterRow){ (u16)x0, (u16)x1, (u16)best0, (u16)best1 };
+	}
+}
+
+static void raster_clear_scaled(Raster *raster) {
+	for (i32 i=0; i<RASTER_SCALED_SLOTS; ++i) {
+		free(raster->scaled[i].pixels);
+	}
+	memset(raster->scaled, 0, sizeof(RasterScaled) * RASTER_SCALED_SLOTS);
+	raster->scaled_count = 0;
+}
+
+// the image region at width x height, resampled the first time it is asked for.
+// a zero size src means the whole image
+static RasterScaled *raster_scaled(Raster *raster, oc_image image, oc_rect src, i32 width, i32 height) {
+	i32 sx = raster_round(src.x), sy = raster_round(src.y);
+	i32 sw = raster_round(src.w), sh = raster_round(src.h);
+	u32 hash = (u32)image.h * 0x9e3779b1u;
+	hash = (hash ^ (u32)sx) * 0x85ebca6bu;
+	hash = (hash ^ (u32)sy) * 0xc2b2ae35u;
+	hash = (hash ^ (u32)(sw << 16 | sh)) * 0x27d4eb2fu;
+	hash = (hash ^ (u32)(width << 16 | height)) * 0x165667b1u;
+
+	for (u32 probe=0; probe<RASTER_SCALED_SLOTS; ++probe) {
+		RasterScaled *slot = &raster->scaled[(hash + probe) & (RASTER_SCALED_SLOTS - 1)];
+		if (slot->pixels && slot->handle == image.h && slot->src_x == sx && slot->src_y == sy &&
+		    slot->src_w == sw && slot->src_h == sh && slot->width == width && slot->height == height)
+		{
+			return slot;
+		}
+		if (slot->pixels) continue;
+
+		// the table is kept at most half full, raster_draw_record empties it
+		// between frames since draws hold pointers into it
+		if (raster->scaled_count >= RASTER_SCALED_SLOTS / 2) return NULL;
+
+		RasterSource *source = raster_source(raster, image);
+		if (!source || source->failed) return NULL;
+		i32 x0 = sw ? sx : 0, y0 = sw ? sy : 0;
+		i32 x1 = sw ? sx + sw : (i32)source->width, y1 = sw ? sy + sh : (i32)source->height;
+		if (x0 < 0) x0 = 0;
+		if (y0 < 0) y0 = 0;
+		if (x1 > (i32)source->width) x1 = source->width;
+		if (y1 > (i32)source->height) y1 = source->height;
+		if (x1 <= x0 || y1 <= y0) return NULL;
+
+		u64 pixel_bytes = sizeof(u32) * (u64)width * height;
+		u8 *memory = malloc(pixel_bytes + sizeof(RasterRow) * height);
+		if (!memory) return NULL;
+		*slot = (RasterScaled){
+			.handle = image.h,
+			.src_x = sx, .src_y = sy, .src_w = sw, .src_h = sh,
+			.width = width, .height = height,
+			.pixels = (u32*)memory,
+			.rows = (RasterRow*)(memory + pixel_bytes),
+		};
+		raster_resample(source, x0, y0, x1 - x0, y1 - y0, slot->pixels, width, height);
+		raster_scaled_rows(slot);
+		++raster->scaled_count;
+		return slot;
+	}
+	return NULL;
+}
+
+// where an image command lands in the frame, with rows it can't show cut off
+static RasterDraw raster_place(Raster *raster, oc_image image, oc_rect src, oc_rect dest) {
+	RasterDraw draw = { .x = raster_round(dest.x), .y = raster_round(dest.y) };
+	i32 width = raster_round(dest.w), height = raster_round(dest.h);
+	if (width <= 0 || height <= 0 || width > 0xffff || draw.x >= (i32)raster->width || draw.y >= (i32)raster->height ||
+	    draw.x + width <= 0 || draw.y + height <= 0)
+	{
+		return draw;
+	}
+	draw.scaled = raster_scaled(raster, image, src, width, height);
+	draw.row0 = draw.y < 0 ? -draw.y : 0;
+	draw.row1 = draw.y + height > (i32)raster->height ? (i32)raster->height - draw.y : height;
+	return draw;
+}
+
+// the columns of the scaled image that fall inside the frame
+static inline void raster_draw_clip(Raster *raster, RasterDraw *draw, i32 *clip0, i32 *clip1) {
+	*clip0 = draw->x < 0 ? -draw->x : 0;
+	*clip1 = draw->x + draw->scaled->width > (i32)raster->width ? (i32)raster->width - draw->x : draw->scaled->width;
+}
+
+// a row's spans clipped to [clip0, clip1)
+static inline void raster_row_clip(RasterRow info, i32 clip0, i32 clip1, i32 *x0, i32 *x1, i32 *opaque0, i32 *opaque1) {
+	*x0 = info.x0 > clip0 ? info.x0 : clip0;
+	*x1 = info.x1 < clip1 ? info.x1 : clip1;
+	*opaque0 = info.opaque0 > *x0 ? info.opaque0 : *x0;
+	*opaque1 = info.opaque1 < *x1 ? info.opaque1 : *x1;
+}
+
+static void raster_blit(Raster *raster, RasterDraw *draw) {
+	if (!draw->scaled) return;
+	i32 width = draw->scaled->width;
+	i32 clip0, clip1;
+	raster_draw_clip(raster, draw, &clip0, &clip1);
+	for (i32 r=draw->row0; r<draw->row1; ++r) {
+		i32 x0, x1, o0, o1;
+		raster_row_clip(draw->scaled->rows[r], clip0, clip1, &x0, &x1, &o0, &o1);
+		const u32 *src_row = draw->scaled->pixels + (u64)r * width;
+		u32 *dst_row = raster->pixels + (u64)(draw->y + r) * raster->width + draw->x;
+		if (o1 <= o0) {
+			if (x1 > x0) raster_blend_span(dst_row + x0, src_row + x0, x1 - x0);
+			continue;
+		}
+		if (o0 > x0) raster_blend_span(dst_row + x0, src_row + x0, o0 - x0);
+		memcpy(dst_row + o0, src_row + o0, sizeof(u32) * (o1 - o0));
+		if (x1 > o1) raster_blend_span(dst_row + o1, src_row + o1, x1 - o1);
+	}
+}
+
+//------------------------------------------------------------------------------
+// occlusion
+//------------------------------------------------------------------------------
+// NOTE(shaw): most of what a frame draws is covered again by the opaque
+// middle of a card drawn after it, the stock is a stack of cards and every
+// tableau card but the last shows only a strip. before drawing, the commands
+// are walked back to front collecting the columns of each row covered so far,
+// image rows whose pixels are all covered are cut off the top and bottom of
+// their draw, and the clear leaves out whatever the whole frame covers.
+static inline bool raster_covered(RasterCover *cover, i32 x0, i32 x1) {
+	for (u32 i=0; i<cover->count; ++i) {
+		if (cover->x0[i] <= x0 && cover->x1[i] >= x1) return true;
+	}
+	return false;
+}
+
+static void raster_cover(RasterCover *cover, i32 x0, i32 x1) {
+	if (x1 <= x0 || raster_covered(cover, x0, x1)) return;
+	// spans it touches are merged into it
+	u32 kept = 0;
+	for (u32 i=0; i<cover->count; ++i) {
+		if (cover->x1[i] < x0 || cover->x0[i] > x1) {
+			cover->x0[kept] = cover->x0[i];
+			cover->x1[kept] = cover->x1[i];
+			++kept;
+			continue;
+		}
+		if (cover->x0[i] < x0) x0 = cover->x0[i];
+		if (cover->x1[i] > x1) x1 = cover->x1[i];
+	}
+	cover->count = kept;
+	if (kept == RASTER_COVER_SPANS) {
+		// out of room, forgetting a span only means drawing more
+		u32 smallest = 0;
+		for (u32 i=1; i<kept; ++i) {
+			if (cover->x1[i] - cover->x0[i] < cover->x1[smallest] - cover->x0[smallest]) smallest = i;
+		}
+		if (cover->x1[smallest] - cover->x0[smallest] >= x1 - x0) return;
+		cover->x0[smallest] = (u16)x0;
+		cover->x1[smallest] = (u16)x1;
+		return;
+	}
+	cover->x0[kept] = (u16)x0;
+	cover->x1[kept] = (u16)x1;
+	++cover->count;
+}
+
+static void raster_cull_image(Raster *raster, RasterDraw *draw) {
+	if (!draw->scaled) return;
+	i32 first = draw->row1, last = draw->row0 - 1;
+	i32 clip0, clip1;
+	raster_draw_clip(raster, draw, &clip0, &clip1);
+	for (i32 r=draw->row0; r<draw->row1; ++r) {
+		i32 x0, x1, o0, o1;
+		raster_row_clip(draw->scaled->rows[r], clip0, clip1, &x0, &x1, &o0, &o1);
+		RasterCover *cover = &raster->cover[draw->y + r];
+		if (x1 > x0 && !raster_covered(cover, draw->x + x0, draw->x + x1)) {
+			if (first > r) first = r;
+			last = r;
+		}
+		raster_cover(cover, draw->x + o0, draw->x + o1);
+	}
+	draw->row0 = first;
+	draw->row1 = last + 1;
+}
+
+// an opaque fill covers the pixels it fills completely
+static void raster_cull_fill(Raster *raster, oc_rect rect) {
+	i32 x0 = (i32)ceilf(rect.x), x1 = (i32)floorf(rect.x + rect.w);
+	i32 y0 = (i32)ceilf(rect.y), y1 = (i32)floorf(rect.y + rect.h);
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > (i32)raster->width) x1 = raster->width;
+	if (y1 > (i32)raster->height) y1 = raster->height;
+	for (i32 y=y0; y<y1; ++y) {
+		raster_cover(&raster->cover[y], x0, x1);
+	}
+}
+
+// fills the columns of each row nothing after the clear covers
+static void raster_clear_uncovered(Raster *raster, u32 color) {
+	for (u32 y=0; y<raster->height; ++y) {
+		RasterCover cover = raster->cover[y];
+		for (u32 i=1; i<cover.count; ++i) {
+			for (u32 k=i; k>0 && cover.x0[k - 1] > cover.x0[k]; --k) {
+				u16 x0 = cover.x0[k], x1 = cover.x1[k];
+				cover.x0[k] = cover.x0[k - 1];
+				cover.x1[k] = cover.x1[k - 1];
+				cover.x0[k - 1] = x0;
+				cover.x1[k - 1] = x1;
+			}
+		}
+		u32 *row = raster->pixels + (u64)y * raster->width;
+		u32 x = 0;
+		for (u32 i=0; i<=cover.count; ++i) {
+			u32 end = i < cover.count ? cover.x0[i] : raster->width;
+			if (end > x) raster_fill_span(row + x, color, end - x);
+			if (i < cover.count) x = cover.x1[i];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// shapes
+//------------------------------------------------------------------------------
+// fills [x0, x1) x [y0, y1), pixels on its edges get the area they cover
+static void raster_fill_rect(Raster *raster, f32 x0, f32 y0, f32 x1, f32 y1, u32 color) {
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > raster->width) x1 = raster->width;
+	if (y1 > raster->height) y1 = raster->height;
+	if (x1 <= x0 || y1 <= y0) return;
+
+	i32 ix0 = (i32)floorf(x0), ix1 = (i32)ceilf(x1);
+	i32 iy0 = (i32)floorf(y0), iy1 = (i32)ceilf(y1);
+	i32 inner0 = (i32)ceilf(x0), inner1 = (i32)floorf(x1);
+	for (i32 y=iy0; y<iy1; ++y) {
+		f32 cover_y = (y + 1 < y1 ? y + 1 : y1) - (y > y0 ? y : y0);
+		bool full_row = cover_y >= 1 && inner1 > inner0;
+		if (full_row) {
+			raster_blend_color(raster->pixels + (u64)y * raster->width + inner0, color, inner1 - inner0);
+		}
+		for (i32 x=ix0; x<ix1; ++x) {
+			if (full_row && x == inner0) x = inner1;
+			if (x >= ix1) break;
+			f32 cover_x = (x + 1 < x1 ? x + 1 : x1) - (x > x0 ? x : x0);
+			raster_blend_pixel(raster, x, y, color, cover_x * cover_y);
+		}
+	}
+}
+
+// a stroke is centered on the rect's outline, drawn as four bands
+static void raster_stroke_rect(Raster *raster, oc_rect rect, f32 width, u32 color) {
+	f32 half = 0.5f * width;
+	f32 ox0 = rect.x - half, oy0 = rect.y - half;
+	f32 ox1 = rect.x + rect.w + half, oy1 = rect.y + rect.h + half;
+	f32 ix0 = rect.x + half, iy0 = rect.y + half;
+	f32 ix1 = rect.x + rect.w - half, iy1 = rect.y + rect.h - half;
+	if (ix1 <= ix0 || iy1 <= iy0) {
+		raster_fill_rect(raster, ox0, oy0, ox1, oy1, color);
+		return;
+	}
+	raster_fill_rect(raster, ox0, oy0, ox1, iy0, color);
+	raster_fill_rect(raster, ox0, iy1, ox1, oy1, color);
+	raster_fill_rect(raster, ox0, iy0, ix0, iy1, color);
+	raster_fill_rect(raster, ix1, iy0, ox1, iy1, color);
+}
+
+// same signed distance as bake_empty_pile_image, a fill covers what is
+// inside the outline and a stroke the band of width around it
+static void raster_rounded_rect(Raster *raster, oc_rect rect, f32 radius, f32 width, bool stroke, u32 color) {
+	f32 half_w = 0.5f * rect.w, half_h = 0.5f * rect.h;
+	f32 center_x = rect.x + half_w, center_y = rect.y + half_h;
+	f32 limit = half_w < half_h ? half_w : half_h;
+	if (radius > limit) radius = limit;
+	if (radius < 0) radius = 0;
+	f32 pad = (stroke ? 0.5f * width : 0) + 1;
+
+	i32 x0 = (i32)floorf(rect.x - pad), x1 = (i32)ceilf(rect.x + rect.w + pad);
+	i32 y0 = (i32)floorf(rect.y - pad), y1 = (i32)ceilf(rect.y + rect.h + pad);
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > (i32)raster->width) x1 = raster->width;
+	if (y1 > (i32)raster->height) y1 = raster->height;
+
+	for (i32 y=y0; y<y1; ++y)
+	for (i32 x=x0; x<x1; ++x) {
+		f32 qx = fabsf(x + 0.5f - center_x) - (half_w - radius);
+		f32 qy = fabsf(y + 0.5f - center_y) - (half_h - radius);
+		f32 outside_x = qx > 0 ? qx : 0;
+		f32 outside_y = qy > 0 ? qy : 0;
+		f32 inside = qx > qy ? qx : qy;
+		if (inside > 0) inside = 0;
+		f32 dist = sqrtf(outside_x*outside_x + outside_y*outside_y) + inside - radius;
+		f32 coverage = stroke ? 0.5f * width + 0.5f - fabsf(dist) : 0.5f - dist;
+		raster_blend_pixel(raster, x, y, color, coverage > 1 ? 1 : coverage);
+	}
+}
+
+//------------------------------------------------------------------------------
+// text
+//------------------------------------------------------------------------------
+// 5x7 glyphs, one byte per row with the leftmost column in bit 4
+typedef struct {
+	char c;
+	u8 rows[7];
+} RasterGlyph;
+
+static const RasterGlyph raster_glyphs[] = {
+	{ 'A', { 0x0e,0x11,0x11,0x1f,0x11,0x11,0x11 } }, { 'B', { 0x1e,0x11,0x11,0x1e,0x11,0x11,0x1e } },
+	{ 'C', { 0x0e,0x11,0x10,0x10,0x10,0x11,0x0e } }, { 'D', { 0x1e,0x11,0x11,0x11,0x11,0x11,0x1e } },
+	{ 'E', { 0x1f,0x10,0x10,0x1e,0x10,0x10,0x1f } }, { 'F', { 0x1f,0x10,0x10,0x1e,0x10,0x10,0x10 } },
+	{ 'G', { 0x0e,0x11,0x10,0x17,0x11,0x11,0x0f } }, { 'H', { 0x11,0x11,0x11,0x1f,0x11,0x11,0x11 } },
+	{ 'I', { 0x0e,0x04,0x04,0x04,0x04,0x04,0x0e } }, { 'J', { 0x07,0x02,0x02,0x02,0x02,0x12,0x0c } },
+	{ 'K', { 0x11,0x12,0x14,0x18,0x14,0x12,0x11 } }, { 'L', { 0x10,0x10,0x10,0x10,0x10,0x10,0x1f } },
+	{ 'M', { 0x11,0x1b,0x15,0x15,0x11,0x11,0x11 } }, { 'N', { 0x11,0x11,0x19,0x15,0x13,0x11,0x11 } },
+	{ 'O', { 0x0e,0x11,0x11,0x11,0x11,0x11,0x0e } }, { 'P', { 0x1e,0x11,0x11,0x1e,0x10,0x10,0x10 } },
+	{ 'Q', { 0x0e,0x11,0x11,0x11,0x15,0x12,0x0d } }, { 'R', { 0x1e,0x11,0x11,0x1e,0x14,0x12,0x11 } },
+	{ 'S', { 0x0f,0x10,0x10,0x0e,0x01,0x01,0x1e } }, { 'T', { 0x1f,0x04,0x04,0x04,0x04,0x04,0x04 } },
+	{ 'U', { 0x11,0x11,0x11,0x11,0x11,0x11,0x0e } }, { 'V', { 0x11,0x11,0x11,0x11,0x11,0x0a,0x04 } },
+	{ 'W', { 0x11,0x11,0x11,0x15,0x15,0x15,0x0a } }, { 'X', { 0x11,0x11,0x0a,0x04,0x0a,0x11,0x11 } },
+	{ 'Y', { 0x11,0x11,0x0a,0x04,0x04,0x04,0x04 } }, { 'Z', { 0x1f,0x01,0x02,0x04,0x08,0x10,0x1f } },
+	{ '0', { 0x0e,0x11,0x13,0x15,0x19,0x11,0x0e } }, { '1', { 0x04,0x0c,0x04,0x04,0x04,0x04,0x0e } },
+	{ '2', { 0x0e,0x11,0x01,0x02,0x04,0x08,0x1f } }, { '3', { 0x1f,0x02,0x04,0x02,0x01,0x11,0x0e } },
+	{ '4', { 0x02,0x06,0x0a,0x12,0x1f,0x02,0x02 } }, { '5', { 0x1f,0x10,0x1e,0x01,0x01,0x11,0x0e } },
+	{ '6', { 0x06,0x08,0x10,0x1e,0x11,0x11,0x0e } }, { '7', { 0x1f,0x01,0x02,0x04,0x08,0x08,0x08 } },
+	{ '8', { 0x0e,0x11,0x11,0x0e,0x11,0x11,0x0e } }, { '9', { 0x0e,0x11,0x11,0x0f,0x01,0x02,0x0c } },
+	{ '!', { 0x04,0x04,0x04,0x04,0x04,0x00,0x04 } }, { '\'',{ 0x04,0x04,0x08,0x00,0x00,0x00,0x00 } },
+	{ '(', { 0x02,0x04,0x08,0x08,0x08,0x04,0x02 } }, { ')', { 0x08,0x04,0x02,0x02,0x02,0x04,0x08 } },
+	{ '+', { 0x00,0x04,0x04,0x1f,0x04,0x04,0x00 } }, { ',', { 0x00,0x00,0x00,0x00,0x0c,0x04,0x08 } },
+	{ '-', { 0x00,0x00,0x00,0x1f,0x00,0x00,0x00 } }, { '.', { 0x00,0x00,0x00,0x00,0x00,0x0c,0x0c } },
+	{ '/', { 0x00,0x01,0x02,0x04,0x08,0x10,0x00 } }, { ':', { 0x00,0x0c,0x0c,0x00,0x0c,0x0c,0x00 } },
+	{ '?', { 0x0e,0x11,0x01,0x02,0x04,0x00,0x04 } }, { ' ', { 0 } },
+};
+
+static const RasterGlyph *raster_glyph(char c) {
+	if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+	for (i32 i=0; i<ARRAY_COUNT(raster_glyphs); ++i) {
+		if (raster_glyphs[i].c == c) return &raster_glyphs[i];
+	}
+	return raster_glyph('?');
+}
+
+// each character takes the advance the headless metrics give it, 0.55 of the
+// font size, and its ink rises 0.7 of the font size above the baseline
+static void raster_text(Raster *raster, f32 x, f32 y, oc_str8 text, f32 font_size, u32 color) {
+	f32 advance = 0.55f * font_size;
+	f32 cell_w = advance / 6;
+	f32 cell_h = 0.7f * font_size / 7;
+	f32 top = y - 0.7f * font_size;
+	for (u64 i=0; i<text.len; ++i) {
+		const RasterGlyph *glyph = raster_glyph(text.ptr[i]);
+		f32 left = x + i * advance;
+		// cell edges snap to whole pixels so neighbouring cells don't leave seams
+		for (i32 row=0; row<7; ++row)
+		for (i32 col=0; col<5; ++col) {
+			if (!(glyph->rows[row] & (0x10 >> col))) continue;
+			f32 x0 = (f32)raster_round(left + col * cell_w), x1 = (f32)raster_round(left + (col + 1) * cell_w);
+			f32 y0 = (f32)raster_round(top + row * cell_h), y1 = (f32)raster_round(top + (row + 1) * cell_h);
+			raster_fill_rect(raster, x0, y0, x1, y1, color);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// frames
+//------------------------------------------------------------------------------
+static bool raster_init(Raster *raster, u32 width, u32 height) {
+	memset(raster, 0, sizeof(*raster));
+	raster->width = width;
+	raster->height = height;
+	raster->pixels = calloc((u64)width * height, sizeof(u32));
+	raster->cover = calloc(height, sizeof(RasterCover));
+	raster->scaled = calloc(RASTER_SCALED_SLOTS, sizeof(RasterScaled));
+	return raster->pixels && raster->cover && raster->scaled;
+}
+
+static void raster_release(Raster *raster) {
+	if (raster->scaled) {
+		raster_clear_scaled(raster);
+		free(raster->scaled);
+	}
+	for (i32 i=0; i<raster->source_count; ++i) {
+		free(raster->sources[i].pixels);
+	}
+	free(raster->pixels);
+	free(raster->cover);
+	free(raster->draws);
+	memset(raster, 0, sizeof(*raster));
+}
+
+static void raster_draw_command(Raster *raster, DrawCommand *command, RasterDraw *draw, bool first) {
+	u32 color = raster_color(command->color);
+	oc_rect dest = command->dest;
+	switch (command->kind) {
+	case DRAW_COMMAND_CLEAR:
+		if (first) {
+			raster_clear_uncovered(raster, color);
+		} else {
+			raster_fill_span(raster->pixels, color, raster->width * raster->height);
+		}
+		break;
+	case DRAW_COMMAND_IMAGE:
+	case DRAW_COMMAND_IMAGE_REGION:
+		raster_blit(raster, draw);
+		break;
+	case DRAW_COMMAND_RECT_FILL:
+		raster_fill_rect(raster, dest.x, dest.y, dest.x + dest.w, dest.y + dest.h, color);
+		break;
+	case DRAW_COMMAND_RECT_STROKE:
+		raster_stroke_rect(raster, dest, command->width, color);
+		break;
+	case DRAW_COMMAND_ROUNDED_RECT_FILL:
+		raster_rounded_rect(raster, dest, command->radius, 0, false, color);
+		break;
+	case DRAW_COMMAND_ROUNDED_RECT_STROKE:
+		raster_rounded_rect(raster, dest, command->radius, command->width, true, color);
+		break;
+	case DRAW_COMMAND_TEXT:
+		raster_text(raster, command->src.x, command->src.y, command->text, command->font_size, color);
+		break;
+	default:
+		break;
+	}
+}
+
+static inline DrawCommand *raster_command(BlockArray *record, i32 index) {
+	return (DrawCommand*)record->blocks[index / DRAW_RECORD_BLOCK] + index % DRAW_RECORD_BLOCK;
+}
+
+// draws the frame game->draw_record holds, resizing to the game's frame first
+static bool raster_draw_record(Raster *raster, GameState *game) {
+	u32 width = (u32)game->frame_size.x, height = (u32)game->frame_size.y;
+	if (width != raster->width || height != raster->height) {
+		u32 *pixels = realloc(raster->pixels, sizeof(u32) * (u64)width * height);
+		RasterCover *cover = pixels ? realloc(raster->cover, sizeof(RasterCover) * height) : NULL;
+		if (pixels) raster->pixels = pixels;
+		if (cover) raster->cover = cover;
+		if (!pixels || !cover) return false;
+		raster->width = width;
+		raster->height = height;
+	}
+	BlockArray *record = &game->draw_record;
+	if (record->count > raster->draw_capacity) {
+		RasterDraw *draws = realloc(raster->draws, sizeof(RasterDraw) * record->count);
+		if (!draws) return false;
+		raster->draws = draws;
+		raster->draw_capacity = record->count;
+	}
+	if (raster->scaled_count >= RASTER_SCALED_SLOTS / 2) {
+		raster_clear_scaled(raster);
+	}
+
+	for (u32 y=0; y<height; ++y) raster->cover[y].count = 0;
+	for (i32 i=record->count - 1; i >= 0; --i) {
+		DrawCommand *command = raster_command(record, i);
+		RasterDraw *draw = &raster->draws[i];
+		draw->scaled = NULL;
+		if (command->kind == DRAW_COMMAND_IMAGE || command->kind == DRAW_COMMAND_IMAGE_REGION) {
+			oc_rect src = command->kind == DRAW_COMMAND_IMAGE ? (oc_rect){0} : command->src;
+			*draw = raster_place(raster, command->image, src, command->dest);
+			raster_cull_image(raster, draw);
+		} else if (command->kind == DRAW_COMMAND_RECT_FILL && command->color.a >= 1) {
+			raster_cull_fill(raster, command->dest);
+		}
+	}
+
+	for (i32 i=0; i<record->count; ++i) {
+		raster_draw_command(raster, raster_command(record, i), &raster->draws[i], i == 0);
+	}
+	return true;
+}
+
+static bool raster_write_png(Raster *raster, const char *path) {
+	return raster_write_png_pixels(path, raster->pixels, raster->width, raster->height);
+}
+
+#endif
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+// history: every position of the current line of play
+//------------------------------------------------------------------------------
+// NOTE(shaw): each committed move adds a position, kept as the changes to the
+// piles since the position before, and every HISTORY_KEYFRAME_INTERVAL
+// positions a full keyframe of the board. any position is then its keyframe
+// plus at most HISTORY_KEYFRAME_INTERVAL - 1 positions of changes, however
+// far it is from the one on the board, so scrubbing the history bar jumps
+// straight there and the cards animate from where they are.
+//
+// positions follow the undo stack: an undo drops the last one. scrubbing back
+// only shows an earlier position, the game underneath stays at the last one
+// until a move is made from there. that is scored and recorded as undoing
+// back to the position shown, see history_resume, so the record still
+// replays and scrubbing is no cheaper than undo.
+
+static Pile *board_pile(GameState *game, i32 index);
+static i32 board_pile_index(GameState *game, Pile *pile);
+static void position_all_cards_on_pile(GameState *game, Pile *pile, bool instant);
+static void undo_move(GameState *game);
+
+static void history_read_pile(GameState *game, i32 p, HistoryLayout *layout) {
+	Pile *pile = board_pile(game, p);
+	i32 count = 0;
+	oc_list_for_reverse(pile->cards, card, Card, node) {
+		assert(count < HISTORY_PILE_MAX);
+		layout->cards[p][count++] = (u8)(card - game->cards) | (card->face_up ? HISTORY_FACE_UP : 0);
+	}
+	layout->count[p] = (u8)count;
+	game->history.pile_version[p] = pile->version;
+}
+
+static void history_read_board(GameState *game, HistoryLayout *layout) {
+	for (i32 p=0; p<PILE_COUNT; ++p) {
+		history_read_pile(game, p, layout);
+	}
+}
+
+// lays the piles out as layout, with instant false so the cards animate there
+static void history_write_board(GameState *game, HistoryLayout *layout) {
+	for (i32 p=0; p<PILE_COUNT; ++p) {
+		Pile *pile = board_pile(game, p);
+		oc_list_init(&pile->cards);
+		for (i32 i=0; i<layout->count[p]; ++i) {
+			u8 value = layout->cards[p][i];
+			Card *card = &game->cards[value & HISTORY_CARD_MASK];
+			card->face_up = (value & HISTORY_FACE_UP) != 0;
+			card->pile = pile;
+			oc_list_push(&pile->cards, &card->node);
+		}
+		position_all_cards_on_pile(game, pile, false);
+	}
+}
+
+static void history_push_keyframe(GameState *game, HistoryLayout *layout) {
+	HistoryKeyframe *keyframe = block_array_push(&game->history.keyframes);
+	assert(keyframe);
+	i32 at = 0;
+	for (i32 p=0; p<PILE_COUNT; ++p) {
+		keyframe->count[p] = layout->count[p];
+		memcpy(keyframe->cards + at, layout->cards[p], layout->count[p]);
+		at += layout->count[p];
+	}
+}
+
+// the layout of any position: its keyframe, then the changes after it
+static void history_layout_at(GameState *game, i32 position, HistoryLayout *layout) {
+	History *history = &game->history;
+	i32 key = position / HISTORY_KEYFRAME_INTERVAL;
+	HistoryKeyframe *keyframe = block_array_get(&history->keyframes, key);
+	i32 at = 0;
+	for (i32 p=0; p<PILE_COUNT; ++p) {
+		layout->count[p] = keyframe->count[p];
+		memcpy(layout->cards[p], keyframe->cards + at, keyframe->count[p]);
+		at += keyframe->count[p];
+	}
+
+	for (i32 i=key * HISTORY_KEYFRAME_INTERVAL + 1; i<=position; ++i) {
+		HistoryPosition *entry = block_array_get(&history->positions, i);
+		for (i32 c=0; c<entry->change_count; ++c) {
+			HistoryChange *change = block_array_get(&history->changes, entry->first_change + c);
+			if (change->index == HISTORY_SET_COUNT) {
+				layout->count[change->pile] = change->value;
+			} else {
+				layout->cards[change->pile][change->index] = change->value;
+			}
+		}
+	}
+}
+
+// starts a new line of play from the board as it is, called once a deal is
+// planned. with the history off there are no positions and nothing is recorded
+static void history_begin(GameState *game) {
+	History *history = &game->history;
+	block_array_release(&history->positions);
+	block_array_release(&history->changes);
+	block_array_release(&history->keyframes);
+	history->cursor = 0;
+	history->scrubbing = false;
+	if (!history->enabled) return;
+
+	history_read_board(game, &history->layout);
+	HistoryPosition *position = block_array_push(&history->positions);
+	*position = (HistoryPosition){ .score = game->score };
+	history_push_keyframe(game, &history->layout);
+}
+
+// adds the board as the next position, called for every committed move.
+// only piles whose version moved are read, and a pile only ever changes
+// above some slot, so only the slots from the first one that differs are
+// stored
+static void history_record(GameState *game) {
+	History *history = &game->history;
+	if (history->positions.count == 0) return;
+
+	HistoryPosition *position = block_array_push(&history->positions);
+	assert(position);
+	*position = (HistoryPosition){ .first_change = history->changes.count, .score = game->score };
+
+	HistoryLayout *layout = &history->layout;
+	for (i32 p=0; p<PILE_COUNT; ++p) {
+		if (board_pile(game, p)->version == history->pile_version[p]) continue;
+
+		u8 old_cards[HISTORY_PILE_MAX];
+		u8 old_count = layout->count[p];
+		memcpy(old_cards, layout->cards[p], old_count);
+		history_read_pile(game, p, layout);
+		u8 new_count = layout->count[p];
+		i32 first = 0;
+		while (first < old_count && first < new_count && old_cards[first] == layout->cards[p][first]) {
+			++first;
+		}
+		if (first == old_count && first == new_count) continue;
+
+		for (i32 i=first; i<new_count; ++i) {
+			HistoryChange *change = block_array_push(&history->changes);
+			assert(change);
+			*change = (HistoryChange){ .pile = (u8)p, .index = (u8)i, .value = layout->cards[p][i] };
+		}
+		HistoryChange *change = block_array_push(&history->changes);
+		assert(change);
+		*change = (HistoryChange){ .pile = (u8)p, .index = HISTORY_SET_COUNT, .value = new_count };
+	}
+	position->change_count = history->changes.count - position->first_change;
+
+	i32 index = history->positions.count - 1;
+	if (index % HISTORY_KEYFRAME_INTERVAL == 0) {
+		history_push_keyframe(game, layout);
+	}
+	history->cursor = index;
+}
+
+// drops the last position, called for every undo
+static void history_pop(GameState *game) {
+	History *history = &game->history;
+	if (history->positions.count <= 1) return;
+	i32 last = --history->positions.count;
+	HistoryPosition *removed = block_array_get(&history->positions, last);
+	history->changes.count = removed->first_change;
+	history->keyframes.count = (last - 1) / HISTORY_KEYFRAME_INTERVAL + 1;
+	history_read_board(game, &history->layout);
+	history->cursor = last - 1;
+}
+
+static inline bool history_reviewing(GameState *game) {
+	return game->history.cursor < game->history.positions.count - 1;
+}
+
+// shows position target on the board
+static void history_scrub(GameState *game, i32 target) {
+	History *history = &game->history;
+	if (history->positions.count == 0 || game->card_dragging) return;
+	i32 last = history->positions.count - 1;
+	if (target < 0) target = 0;
+	if (target > last) target = last;
+	if (target == history->cursor) return;
+
+	HistoryLayout layout;
+	history_layout_at(game, target, &layout);
+	history_write_board(game, &layout);
+	history->cursor = target;
+
+	HistoryPosition *position = block_array_get(&history->positions, target);
+	i32 score = target == last ? game->score : position->score;
+	snprintf(game->score_string, sizeof(game->score_string), "Score: %d", score);
+}
+
+// makes the position on the board the last one before a move is made from
+// it. the board is put back at the last position, without moving anything
+// on screen, and undone back down to where it was, so the score, the undo
+// stack and the record all see ordinary undos. the moves call it once they
+// know they can be made, a press that moves nothing leaves the board in review
+static void history_resume(GameState *game) {
+	History *history = &game->history;
+	if (!history_reviewing(game)) return;
+	i32 target = history->cursor;
+
+	oc_vec2 pos[ARRAY_COUNT(game->cards)], prev_pos[ARRAY_COUNT(game->cards)];
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		pos[i] = game->cards[i].pos;
+		prev_pos[i] = game->cards[i].prev_pos;
+	}
+
+	history_write_board(game, &history->layout);
+	history->cursor = history->positions.count - 1;
+	while (history->positions.count - 1 > target && game->undo_stack.count > 0) {
+		undo_move(game);
+	}
+
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		game->cards[i].pos = pos[i];
+		game->cards[i].prev_pos = prev_pos[i];
+	}
+}
+
+//------------------------------------------------------------------------------
+// history bar
+//------------------------------------------------------------------------------
+static oc_rect history_bar_rect(GameState *game) {
+	f32 x = game->board_margin.x;
+	return (oc_rect){ x, game->frame_size.y - HISTORY_BAR_HEIGHT - 8, game->frame_size.x - 2*x, HISTORY_BAR_HEIGHT };
+}
+
+static bool history_bar_visible(GameState *game) {
+	return game->state == STATE_PLAY && game->history.positions.count > 1;
+}
+
+static void history_scrub_to_x(GameState *game, f32 x) {
+	oc_rect rect = history_bar_rect(game);
+	f32 t = (x - rect.x) / rect.w;
+	if (t < 0) t = 0;
+	if (t > 1) t = 1;
+	history_scrub(game, (i32)(t * (game->history.positions.count - 1) + 0.5f));
+}
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+// input latency
+//------------------------------------------------------------------------------
+// NOTE(shaw): measures the time from an input callback to the end of the first
+// present that reflects it. bucket i counts latencies in [2^i, 2^(i+1))
+// microseconds, which covers sub microsecond up to several seconds in a
+// fixed amount of space.
+
+// called whenever an input event changes game state
+void latency_note_input(GameState *game, f64 event_time) {
+	if (game->latency_pending_time == 0 || event_time < game->latency_pending_time) {
+		game->latency_pending_time = event_time;
+	}
+}
+
+// called right after a present
+void latency_note_present(GameState *game) {
+	if (game->latency_pending_time == 0) {
+		return;
+	}
+	f64 latency_us = (oc_clock_time(OC_CLOCK_MONOTONIC) - game->latency_pending_time) * 1e6;
+	game->latency_pending_time = 0;
+
+	i32 bucket = 0;
+	while (bucket < LATENCY_BUCKETS - 1 && latency_us >= (f64)(2ull << bucket)) {
+		++bucket;
+	}
+	++game->latency_histogram[bucket];
+	++game->latency_count;
+}
+
+// upper bound in microseconds of the bucket holding the given percentile
+f64 latency_percentile(GameState *game, f64 percentile) {
+	if (game->latency_count == 0) {
+		return 0;
+	}
+	u64 target = (u64)(percentile * game->latency_count + 0.5);
+	if (target < 1) target = 1;
+	u64 seen = 0;
+	for (i32 i=0; i<LATENCY_BUCKETS; ++i) {
+		seen += game->latency_histogram[i];
+		if (seen >= target) {
+			return (f64)(2ull << i);
+		}
+	}
+	return (f64)(2ull << (LATENCY_BUCKETS - 1));
+}
+
+void latency_report(GameState *game) {
+	oc_log_info("input latency over %u presents: p50 < %.0fus, p90 < %.0fus, p99 < %.0fus\n",
+		game->latency_count, latency_percentile(game, 0.50), latency_percentile(game, 0.90), latency_percentile(game, 0.99));
+	for (i32 i=0; i<LATENCY_BUCKETS; ++i) {
+		if (game->latency_histogram[i]) {
+			oc_log_info("  < %8lluus: %u\n", (unsigned long long)(2ull << i), game->latency_histogram[i]);
+		}
+	}
+}
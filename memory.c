@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+// block arrays
+//------------------------------------------------------------------------------
+static const char *mem_subsystem_names[MEM_SUBSYSTEM_COUNT] = {
+	[MEM_UNDO_STACK]    = "undo stack",
+	[MEM_WIN_CARD_PATH] = "win card path",
+	[MEM_TELEMETRY]     = "telemetry",
+	[MEM_NOTATION]      = "notation",
+	[MEM_DEAL_TABLE]    = "deal table",
+	[MEM_SOLVER]        = "solver",
+	[MEM_PAR]           = "par",
+	[MEM_TIMELINE]      = "timeline",
+	[MEM_HISTORY]       = "history",
+	[MEM_TRACE]         = "trace",
+	[MEM_DRAW_RECORD]   = "draw record",
+};
+
+// the same names as json keys, for the native tools that print them
+static inline const char *mem_subsystem_key(i32 subsystem) {
+	static const char *keys[MEM_SUBSYSTEM_COUNT] = {
+		[MEM_UNDO_STACK]    = "undo_stack",
+		[MEM_WIN_CARD_PATH] = "win_card_path",
+		[MEM_TELEMETRY]     = "telemetry",
+		[MEM_NOTATION]      = "notation",
+		[MEM_DEAL_TABLE]    = "deal_table",
+		[MEM_SOLVER]        = "solver",
+		[MEM_PAR]           = "par",
+		[MEM_TIMELINE]      = "timeline",
+		[MEM_HISTORY]       = "history",
+		[MEM_TRACE]         = "trace",
+		[MEM_DRAW_RECORD]   = "draw_record",
+	};
+	return keys[subsystem];
+}
+
+void mem_track(MemUsage *usage, i64 delta) {
+	usage->live += delta;
+	if (usage->live > usage->peak) {
+		usage->peak = usage->live;
+	}
+}
+
+void block_array_init(BlockArray *array, MemUsage *usage, u32 item_size, u32 block_items) {
+	memset(array, 0, sizeof(*array));
+	array->usage = usage;
+	array->item_size = item_size;
+	array->block_items = block_items;
+}
+
+// returns NULL once the array can't hold any more blocks
+void *block_array_get(BlockArray *array, i32 index) {
+	assert(index >= 0);
+	i32 block = index / array->block_items;
+	i32 offset = index % array->block_items;
+	if (block >= BLOCK_ARRAY_MAX_BLOCKS) {
+		return NULL;
+	}
+	while (block >= array->block_count) {
+		if (!array->arena_initialized) {
+			oc_arena_init(&array->arena);
+			array->arena_initialized = true;
+		}
+		u64 size = (u64)array->item_size * array->block_items;
+		array->blocks[array->block_count++] = oc_arena_push(&array->arena, size);
+		mem_track(array->usage, size);
+	}
+	return (u8*)array->blocks[block] + offset * array->item_size;
+}
+
+void *block_array_push(BlockArray *array) {
+	void *item = block_array_get(array, array->count);
+	if (item) {
+		++array->count;
+	}
+	return item;
+}
+
+// gives every block back, the array can be used again afterwards
+void block_array_release(BlockArray *array) {
+	if (array->arena_initialized) {
+		oc_arena_cleanup(&array->arena);
+		mem_track(array->usage, -(i64)((u64)array->item_size * array->block_items * array->block_count));
+	}
+	block_array_init(array, array->usage, array->item_size, array->block_items);
+}
+
+void mem_report(GameState *game) {
+	oc_log_info("GameState: %llu bytes\n", (unsigned long long)sizeof(GameState));
+	oc_log_info("ui context: %llu bytes, outside GameState\n", (unsigned long long)sizeof(ui_context));
+	for (i32 i=0; i<MEM_SUBSYSTEM_COUNT; ++i) {
+		oc_log_info("%s: %llu bytes live, %llu bytes peak\n", mem_subsystem_names[i],
+			(unsigned long long)game->memory[i].live, (unsigned long long)game->memory[i].peak);
+	}
+}
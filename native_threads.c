@@ -0,0 +1,77 @@
+// Minimal threads for the native tools (psolve.c, rate.c), never part of the
+// game module. Threads run a function on an argument and are joined, locks are
+// spinlocks on an i32.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+typedef void NativeThreadProc(void *arg);
+
+typedef struct {
+	NativeThreadProc *proc;
+	void *arg;
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+} NativeThread;
+
+#ifdef _WIN32
+static DWORD WINAPI native_thread_entry(LPVOID param) {
+	NativeThread *thread = param;
+	thread->proc(thread->arg);
+	return 0;
+}
+
+static void native_thread_start(NativeThread *thread, NativeThreadProc *proc, void *arg) {
+	thread->proc = proc;
+	thread->arg = arg;
+	thread->handle = CreateThread(NULL, 0, native_thread_entry, thread, 0, NULL);
+}
+
+static void native_thread_join(NativeThread *thread) {
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+}
+
+static i32 native_cpu_count(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (i32)info.dwNumberOfProcessors;
+}
+#else
+static void *native_thread_entry(void *param) {
+	NativeThread *thread = param;
+	thread->proc(thread->arg);
+	return NULL;
+}
+
+static void native_thread_start(NativeThread *thread, NativeThreadProc *proc, void *arg) {
+	thread->proc = proc;
+	thread->arg = arg;
+	pthread_create(&thread->handle, NULL, native_thread_entry, thread);
+}
+
+static void native_thread_join(NativeThread *thread) {
+	pthread_join(thread->handle, NULL);
+}
+
+static i32 native_cpu_count(void) {
+	return (i32)sysconf(_SC_NPROCESSORS_ONLN);
+}
+#endif
+
+static inline void native_lock(volatile i32 *lock) {
+	while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+		while (__atomic_load_n(lock, __ATOMIC_RELAXED));
+	}
+}
+
+static inline void native_unlock(volatile i32 *lock) {
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,421 @@
+//------------------------------------------------------------------------------
+// move notation
+//------------------------------------------------------------------------------
+// NOTE(shaw): a game record is one line of space separated tokens:
+//
+//     d<deal number> <1|3> [t<steps>] <moves...> [=<score>]
+//
+// where a move is s (draw from stock), r (recycle the waste), u (undo) or
+// <from>[:<count>]><to> for a transfer. piles are w, f1-f4 and t1-t7, and the
+// count says how many cards move off a tableau pile, one when left out. t is
+// the game timer in SIM_STEPs when the record was made, replay adds it up step
+// by step so the time bonus comes out to the same point. a trailing =<score>
+// is the score the record claims.
+//
+// the moves prove everything in the score but the time bonus, the timer is
+// only what the record says. a timer shorter than NOTATION_MIN_MOVE_TIME per
+// move or longer than the game can show (NOTATION_MAX_TIMER_STEPS) is
+// rejected, and the bonus is reported on its own so a claimed score can be
+// judged without it.
+//
+//     d3735928559 3 t11235 s s t5>t2 w>f1 t7:3>t2 u r =645
+//
+// records replay through the same pile_transfer and update_score calls the
+// game itself makes, so a replayed score is exactly what the game would show.
+
+static void game_reset_with_deal(GameState *game, u32 deal_number);
+static void game_reset(GameState *game);
+static void draw_from_stock(GameState *game, bool instant);
+static void recycle_waste(GameState *game, bool instant);
+static void undo_move(GameState *game);
+static void commit_move(GameState *game);
+static void set_state(GameState *game, StateKind state);
+static bool is_movable_stack(Card *card);
+static bool can_drop(Card *card, Card *target);
+static bool can_drop_empty_pile(GameState *game, Card *card, Pile *pile);
+static void update_score_pile_transfer(GameState *game, Pile *from_pile, Pile *to_pile);
+static void undo_push_pile_transfer(GameState *game, Card *card, Pile *target_pile);
+static void pile_transfer(GameState *game, Pile *target_pile, Card *card, bool instant);
+static void reveal_tableau_card(GameState *game);
+static bool is_game_won(GameState *game);
+static bool is_autocomplete_possible(GameState *game);
+static bool autocomplete_step(GameState *game, bool instant);
+static void finish_won_game(GameState *game);
+static i32 time_bonus(f64 timer);
+static Card *pile_peek_top(Pile *pile);
+
+typedef struct {
+	bool ok;
+	const char *error;
+	i32 error_token; // index of the offending token
+	bool has_claimed_score;
+	i32 claimed_score;
+	i32 time_bonus; // the part of the score that comes from the record's timer
+} ReplayResult;
+
+static void notation_push(GameState *game, NotationMove move) {
+	NotationMove *slot = block_array_push(&game->notation);
+	if (slot) {
+		*slot = move;
+	} else {
+		oc_log_error("too many moves to record in notation\n");
+	}
+}
+
+// called as a move is committed, the temp undo stack still holds its entries
+static void notation_record_commit(GameState *game) {
+	for (i32 i=0; i<game->temp_undo_stack_index; ++i) {
+		UndoInfo *undo = &game->temp_undo_stack[i];
+		if (undo->kind != UNDO_PILE_TRANSFER) continue;
+
+		NotationMove move = { .kind = NOTATION_TRANSFER, .from = undo->prev_pile, .to = undo->pile, .count = 1 };
+		if (undo->prev_pile == 0 && undo->pile == 1) {
+			move.kind = NOTATION_STOCK;
+		} else if (undo->prev_pile == 1 && undo->pile == 0) {
+			move.kind = NOTATION_RECYCLE;
+		} else {
+			Card *card = &game->cards[undo->card];
+			for (oc_list_elt *node = card->node.prev; node; node = node->prev) {
+				++move.count;
+			}
+		}
+		notation_push(game, move);
+		return;
+	}
+}
+
+static void notation_record_undo(GameState *game) {
+	notation_push(game, (NotationMove){ .kind = NOTATION_UNDO });
+}
+
+static i32 notation_write_pile(char *out, i32 pile) {
+	if (pile == 1) return snprintf(out, 3, "w");
+	if (pile < 6)  return snprintf(out, 3, "f%d", pile - 1);
+	return snprintf(out, 3, "t%d", pile - 5);
+}
+
+static i32 notation_write_move(char *out, NotationMove move) {
+	switch (move.kind) {
+	case NOTATION_STOCK:   out[0] = 's'; return 1;
+	case NOTATION_RECYCLE: out[0] = 'r'; return 1;
+	case NOTATION_UNDO:    out[0] = 'u'; return 1;
+	default:               break;
+	}
+	i32 length = notation_write_pile(out, move.from);
+	if (move.count > 1) {
+		length += snprintf(out + length, 4, ":%d", move.count);
+	}
+	out[length++] = '>';
+	length += notation_write_pile(out + length, move.to);
+	return length;
+}
+
+// writes the current game as a record, the result lives in arena
+static oc_str8 notation_export(GameState *game, oc_arena *arena) {
+	BlockArray *moves = &game->notation;
+	u64 capacity = 64 + (u64)moves->count * NOTATION_MAX_MOVE_TEXT;
+	char *text = oc_arena_push_array(arena, char, capacity);
+
+	i32 length = snprintf(text, capacity, "d%u %d t%llu", game->deal_number, game->draw_three_mode ? 3 : 1, (u64)(game->timer / SIM_STEP + 0.5));
+	for (i32 block=0, first=0; first < moves->count; ++block, first += moves->block_items) {
+		NotationMove *block_moves = moves->blocks[block];
+		i32 count = moves->count - first;
+		if (count > (i32)moves->block_items) count = moves->block_items;
+		for (i32 i=0; i<count; ++i) {
+			text[length++] = ' ';
+			length += notation_write_move(text + length, block_moves[i]);
+		}
+	}
+	length += snprintf(text + length, capacity - length, " =%d", game->score);
+	return (oc_str8){ .ptr = text, .len = length };
+}
+
+//------------------------------------------------------------------------------
+// parsing and replay
+//------------------------------------------------------------------------------
+typedef struct {
+	const char *at;
+	const char *end;
+} NotationToken;
+
+static bool notation_next_token(const char **cursor, const char *end, NotationToken *token) {
+	const char *at = *cursor;
+	while (at < end && (*at == ' ' || *at == '\t' || *at == '\r' || *at == '\n')) ++at;
+	if (at == end) {
+		*cursor = at;
+		return false;
+	}
+	token->at = at;
+	while (at < end && !(*at == ' ' || *at == '\t' || *at == '\r' || *at == '\n')) ++at;
+	token->end = at;
+	*cursor = at;
+	return true;
+}
+
+static bool notation_parse_u64(const char **at, const char *end, u64 *value) {
+	const char *start = *at;
+	u64 result = 0;
+	while (*at < end && **at >= '0' && **at <= '9') {
+		result = result * 10 + (u64)(**at - '0');
+		if (result > UINT32_MAX) return false;
+		++*at;
+	}
+	*value = result;
+	return *at > start;
+}
+
+// returns a board_pile() index or -1
+static i32 notation_parse_pile(const char **at, const char *end) {
+	if (*at >= end) return -1;
+	char kind = *(*at)++;
+	if (kind == 'w') return 1;
+	if (*at >= end) return -1;
+	i32 n = *(*at)++ - '0';
+	if (kind == 'f' && n >= 1 && n <= 4) return 1 + n;
+	if (kind == 't' && n >= 1 && n <= 7) return 5 + n;
+	return -1;
+}
+
+static bool notation_parse_transfer(NotationToken token, NotationMove *move) {
+	const char *at = token.at;
+	i32 from = notation_parse_pile(&at, token.end);
+	if (from < 0) return false;
+	u64 count = 1;
+	if (at < token.end && *at == ':') {
+		++at;
+		if (!notation_parse_u64(&at, token.end, &count) || count < 1 || count > CARD_KIND_COUNT) return false;
+	}
+	if (at >= token.end || *at++ != '>') return false;
+	i32 to = notation_parse_pile(&at, token.end);
+	if (to < 0 || at != token.end) return false;
+	*move = (NotationMove){ .kind = NOTATION_TRANSFER, .from = (u8)from, .to = (u8)to, .count = (u8)count };
+	return true;
+}
+
+// applies a transfer if it is legal, the same way a drop or click would
+static bool notation_apply_transfer(GameState *game, NotationMove move) {
+	Pile *from = board_pile(game, move.from);
+	Pile *to = board_pile(game, move.to);
+	if (from == to || to->kind == PILE_WASTE) return false;
+	if (move.count > 1 && (from->kind != PILE_TABLEAU || to->kind == PILE_FOUNDATION)) return false;
+
+	Card *card = pile_peek_top(from);
+	for (i32 i=1; card && i<move.count; ++i) {
+		card = oc_list_next_entry(from->cards, card, Card, node);
+	}
+	if (!card || !card->face_up || !is_movable_stack(card)) return false;
+
+	Card *top = pile_peek_top(to);
+	bool legal = top ? can_drop(card, top) : can_drop_empty_pile(game, card, to);
+	if (!legal) return false;
+
+	update_score_pile_transfer(game, from, to);
+	undo_push_pile_transfer(game, card, to);
+	pile_transfer(game, to, card, true);
+	reveal_tableau_card(game);
+	return true;
+}
+
+static bool notation_apply_move(GameState *game, NotationMove move) {
+	switch (move.kind) {
+	case NOTATION_STOCK:
+		if (oc_list_empty(game->stock.cards)) return false;
+		draw_from_stock(game, true);
+		break;
+	case NOTATION_RECYCLE:
+		if (!oc_list_empty(game->stock.cards) || oc_list_empty(game->waste.cards)) return false;
+		recycle_waste(game, true);
+		break;
+	case NOTATION_UNDO:
+		if (game->undo_stack.count == 0) return false;
+		undo_move(game);
+		return true;
+	case NOTATION_TRANSFER:
+		if (!notation_apply_transfer(game, move)) return false;
+		break;
+	default:
+		return false;
+	}
+	commit_move(game);
+
+	if (is_game_won(game)) {
+		finish_won_game(game);
+	}
+	return true;
+}
+
+// resets the game to the record's deal and plays its moves. on success the
+// game is left in the final position, on failure at the last legal one
+static ReplayResult notation_replay(GameState *game, const char *text, u64 length) {
+	ReplayResult result = { .error_token = 0 };
+	const char *cursor = text;
+	const char *end = text + length;
+	NotationToken token;
+
+	u64 deal_number = 0;
+	const char *at = NULL;
+	if (!notation_next_token(&cursor, end, &token) || *token.at != 'd' ||
+	    !(at = token.at + 1, notation_parse_u64(&at, token.end, &deal_number)) || at != token.end)
+	{
+		result.error = "expected d<deal number>";
+		return result;
+	}
+
+	result.error_token = 1;
+	if (!notation_next_token(&cursor, end, &token) || token.end - token.at != 1 ||
+	    (*token.at != '1' && *token.at != '3'))
+	{
+		result.error = "expected draw mode 1 or 3";
+		return result;
+	}
+	bool draw_three = *token.at == '3';
+
+	game->replaying = true;
+	game->draw_three_mode = draw_three;
+	game_reset_with_deal(game, (u32)deal_number);
+	timeline_fast_forward(game);
+	set_state(game, STATE_PLAY);
+
+	bool has_timer = false;
+	i32 moves = 0;
+	for (i32 index=2; notation_next_token(&cursor, end, &token); ++index) {
+		result.error_token = index;
+		char first = *token.at;
+
+		// the timer sits in the header, transfers off the tableau always have a >
+		if (first == 't' && index == 2 && !memchr(token.at, '>', token.end - token.at)) {
+			const char *timer_at = token.at + 1;
+			u64 steps = 0;
+			if (!notation_parse_u64(&timer_at, token.end, &steps) || timer_at != token.end) {
+				result.error = "bad timer";
+				break;
+			}
+			if (steps > NOTATION_MAX_TIMER_STEPS) {
+				result.error = "timer longer than the game shows";
+				break;
+			}
+			game->timer = 0;
+			for (u64 i=0; i<steps; ++i) {
+				game->timer += SIM_STEP;
+			}
+			has_timer = true;
+			continue;
+		}
+
+		if (first == '=') {
+			const char *score_at = token.at + 1;
+			bool negative = score_at < token.end && *score_at == '-';
+			if (negative) ++score_at;
+			u64 score = 0;
+			if (!notation_parse_u64(&score_at, token.end, &score) || score_at != token.end) {
+				result.error = "bad claimed score";
+				break;
+			}
+			if (score > INT32_MAX) {
+				result.error = "claimed score out of range";
+				break;
+			}
+			result.has_claimed_score = true;
+			result.claimed_score = negative ? -(i32)score : (i32)score;
+			if (notation_next_token(&cursor, end, &token)) {
+				result.error_token = index + 1;
+				result.error = "tokens after the claimed score";
+				break;
+			}
+			result.ok = true;
+			break;
+		}
+
+		if (game->state == STATE_WIN) {
+			result.error = "move after the game was won";
+			break;
+		}
+
+		NotationMove move = {0};
+		if (token.end - token.at == 1 && first == 's') {
+			move.kind = NOTATION_STOCK;
+		} else if (token.end - token.at == 1 && first == 'r') {
+			move.kind = NOTATION_RECYCLE;
+		} else if (token.end - token.at == 1 && first == 'u') {
+			move.kind = NOTATION_UNDO;
+		} else if (!notation_parse_transfer(token, &move)) {
+			result.error = "unknown move";
+			break;
+		}
+
+		if (!notation_apply_move(game, move)) {
+			result.error = "illegal move";
+			break;
+		}
+		++moves;
+	}
+
+	if (!result.error && has_timer && game->timer < moves * NOTATION_MIN_MOVE_TIME) {
+		result.ok = false;
+		result.error_token = 2;
+		result.error = "timer too short for the moves";
+	}
+
+	// autocomplete moves aren't recorded, a record that ends where the game
+	// would autocomplete plays out the same way
+	if (!result.error && game->state == STATE_PLAY && is_autocomplete_possible(game)) {
+		while (autocomplete_step(game, true));
+		finish_won_game(game);
+	}
+
+	if (game->state == STATE_WIN) {
+		result.time_bonus = time_bonus(game->timer);
+	}
+	if (!result.error) {
+		result.ok = true;
+		if (result.has_claimed_score && result.claimed_score != game->score) {
+			result.ok = false;
+			result.error = "claimed score does not match";
+		}
+	}
+	game->replaying = false;
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// export and import
+//------------------------------------------------------------------------------
+static const char *notation_record_path = "game_record.txt";
+
+static void notation_export_to_file(GameState *game) {
+	oc_arena_scope scratch = oc_scratch_begin();
+	oc_str8 record = notation_export(game, scratch.arena);
+
+	oc_file file = oc_file_open(OC_STR8(notation_record_path), OC_FILE_ACCESS_WRITE, OC_FILE_OPEN_CREATE | OC_FILE_OPEN_TRUNCATE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_error("Could not open file %s\n", notation_record_path);
+	} else {
+		if (oc_file_write(file, record.len, record.ptr) != record.len) {
+			oc_log_error("Failed to write game record");
+		}
+		oc_file_close(file);
+		oc_log_info("exported %d moves to %s\n", game->notation.count, notation_record_path);
+	}
+	oc_scratch_end(scratch);
+}
+
+static void notation_import_from_file(GameState *game) {
+	oc_file file = oc_file_open(OC_STR8(notation_record_path), OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_info("No game record found");
+		return;
+	}
+
+	oc_arena_scope scratch = oc_scratch_begin();
+	u64 size = oc_file_size(file);
+	char *text = oc_arena_push_array(scratch.arena, char, size);
+	u64 bytes_read = oc_file_read(file, size, text);
+	oc_file_close(file);
+
+	ReplayResult result = notation_replay(game, text, bytes_read);
+	if (!result.ok) {
+		oc_log_error("game record rejected at token %d: %s\n", result.error_token, result.error);
+		game_reset(game);
+	}
+	oc_scratch_end(scratch);
+}
@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------------
+// par: fewest moves to win
+//------------------------------------------------------------------------------
+// NOTE(shaw): iterative deepening A* over the solver's moves. every solver
+// move is one game move (draws, recycles and the auto foundation moves too),
+// so the length of the shortest path is the par for "Moves:". each iteration
+// is a depth first search that cuts any line whose moves so far plus
+// par_lower_bound pass the bound, and the next bound is the smallest value
+// that got cut. the bound never overestimates, so the first win found is the
+// shortest, among the lines the solver's move rules allow.
+//
+// a whole deal is usually far too big for that to finish, so the search
+// starts from the plain solver's win as the best so far and first spends up
+// to half its nodes shortening it: one depth first pass that cuts any line
+// that can't beat the best so far and tightens the cut with every shorter
+// win it finds. if that pass ends the best is proven, otherwise IDA* takes
+// the rest of the nodes and only looks for lines shorter than the best.
+// either it finds one, which is then the shortest, or its bound climbs to
+// the best and proves it. when the nodes run out first the par is the best
+// win known, not proven, and lower_bound says how far the proof got.
+//
+// the search keeps its stack in ParSearch and runs for a given time, so the
+// game can spread it over frames, the seed solve included. the whole thing lives in one arena of at
+// most the memory cap: the seed solver, the frames, two paths and a table of
+// the fewest moves each visited state was reached in this iteration,
+// reaching it again in as many or more is cut. a full table only means more
+// states get searched twice.
+
+#define PAR_TABLE_PROBES 16
+#define PAR_G_BITS 10
+#define PAR_G_MASK ((1ull << PAR_G_BITS) - 1)
+#define PAR_NO_BOUND 0xffffffff
+
+// cards that aren't home yet each need a move to a foundation, the stock
+// needs drawing through at least once, and a card sitting over a lower card
+// of its own suit has to leave its pile before it can go home. moves out of
+// a pile take one face up run, so each face down blocker and one for the face
+// up part are separate moves
+static u32 par_lower_bound(SolverState *s) {
+	u32 bound = SUIT_COUNT * CARD_KIND_COUNT;
+	for (i32 suit=0; suit < SUIT_COUNT; ++suit) {
+		bound -= s->foundation[suit];
+	}
+	u32 draw = s->draw_three ? 3 : 1;
+	bound += (u32)(s->talon_count - s->waste_count + draw - 1) / draw;
+
+	for (i32 i=0; i<7; ++i) {
+		u8 lowest[SUIT_COUNT] = { CARD_KIND_COUNT, CARD_KIND_COUNT, CARD_KIND_COUNT, CARD_KIND_COUNT };
+		bool face_up_blocker = false;
+		for (i32 j=0; j < s->tableau_count[i]; ++j) {
+			u8 card = s->tableau[i][j];
+			u8 suit = solver_card_suit(card);
+			u8 kind = solver_card_kind(card);
+			if (kind > lowest[suit]) {
+				if (j < s->tableau_hidden[i]) {
+					++bound;
+				} else {
+					face_up_blocker = true;
+				}
+			} else {
+				lowest[suit] = kind;
+			}
+		}
+		bound += face_up_blocker;
+	}
+	return bound;
+}
+
+static void par_init(ParSearch *par, u64 memory_cap) {
+	memset(par, 0, sizeof(*par));
+	oc_arena_init(&par->arena);
+	solver_init(&par->seed, &par->arena, PAR_SEED_NODES);
+	par->frames = oc_arena_push_array(&par->arena, SolverFrame, PAR_MAX_MOVES);
+	par->path = oc_arena_push_array(&par->arena, SolverMove, SOLVER_MAX_PATH);
+	par->best_path = oc_arena_push_array(&par->arena, SolverMove, SOLVER_MAX_PATH);
+	u64 fixed = par->seed.bytes + PAR_MAX_MOVES * sizeof(SolverFrame) + 2ull * SOLVER_MAX_PATH * sizeof(SolverMove);
+	u32 table_size = 1024;
+	while (fixed + 2ull * table_size * sizeof(u64) <= memory_cap && table_size < (1u << 28)) {
+		table_size *= 2;
+	}
+	par->table_mask = table_size - 1;
+	par->table = oc_arena_push_array(&par->arena, u64, table_size);
+	par->bytes = fixed + (u64)table_size * sizeof(u64);
+}
+
+static void par_begin_iteration(ParSearch *par) {
+	memset(par->table, 0, ((u64)par->table_mask + 1) * sizeof(u64));
+	par->table_count = 0;
+	par->next_bound = PAR_NO_BOUND;
+	par->frames[0].state = par->start;
+	par->depth = 0;
+	par->entering = true;
+	par->path_length = 0;
+	++par->iterations;
+}
+
+static void par_start(ParSearch *par, SolverState *start, u64 node_limit) {
+	par->start = *start;
+	par->status = PAR_SEARCHING;
+	par->node_limit = node_limit;
+	par->nodes = 0;
+	par->iterations = 0;
+	par->table_peak = 0;
+	par->proven = false;
+	par->first_bound = par->lower_bound = par_lower_bound(start);
+	par->par = 0;
+	par->seed_par = 0;
+	par->seconds = 0;
+	par->seeding = true;
+	solver_begin(&par->seed, start);
+}
+
+// runs the seed solve for up to seconds, then starts the search from its win
+static bool par_seed(ParSearch *par, f64 seconds) {
+	SolverResult result = solver_continue(&par->seed, seconds);
+	if (result == SOLVER_SEARCHING) {
+		return false;
+	}
+	if (result == SOLVER_WON && par->seed.path_length <= PAR_MAX_MOVES) {
+		par->par = par->seed_par = par->seed.path_length;
+		memcpy(par->best_path, par->seed.path, par->par * sizeof(SolverMove));
+	}
+	par->nodes = par->seed.nodes;
+	par->seeding = false;
+
+	par->shortening = par->par > 0;
+	par->bound = par->shortening ? par->par - 1 : par->lower_bound;
+	par_begin_iteration(par);
+	return true;
+}
+
+static void par_finish(ParSearch *par, bool proven) {
+	par->proven = proven && par->par > 0;
+	if (par->proven) {
+		par->lower_bound = par->par;
+	}
+	par->status = PAR_DONE;
+}
+
+// true if the state was already reached in as few moves this iteration
+static bool par_seen(ParSearch *par, SolverState *s, u32 moves) {
+	u64 key = solver_hash(s) & ~PAR_G_MASK;
+	u32 slot = (u32)(key >> PAR_G_BITS) & par->table_mask;
+	for (i32 probe=0; probe < PAR_TABLE_PROBES; ++probe) {
+		u64 entry = par->table[slot];
+		if (entry == 0) {
+			if (par->table_count < par->table_mask / 4 * 3) {
+				par->table[slot] = key | moves;
+				if (++par->table_count > par->table_peak) par->table_peak = par->table_count;
+			}
+			return false;
+		}
+		if ((entry & ~PAR_G_MASK) == key) {
+			if ((entry & PAR_G_MASK) <= moves) return true;
+			par->table[slot] = key | moves;
+			return false;
+		}
+		slot = (slot + 1) & par->table_mask;
+	}
+	return false;
+}
+
+// searches for up to seconds, or to the end when seconds is zero. PAR_DONE
+// once the search is proven or out of nodes, par is zero if no win was found
+static ParStatus par_run(ParSearch *par, f64 seconds) {
+	f64 start_time = oc_clock_time(OC_CLOCK_MONOTONIC);
+	f64 deadline = seconds > 0 ? start_time + seconds : 0;
+
+	if (par->seeding && !par_seed(par, seconds)) {
+		par->seconds += oc_clock_time(OC_CLOCK_MONOTONIC) - start_time;
+		return par->status;
+	}
+
+	for (u32 step=1; par->status == PAR_SEARCHING; ++step) {
+		// cut lines cost time too, so the clock is read by loop steps rather than nodes
+		if (deadline > 0 && (step & 255) == 0 && oc_clock_time(OC_CLOCK_MONOTONIC) > deadline) {
+			break;
+		}
+		SolverFrame *frame = &par->frames[par->depth];
+		if (par->entering) {
+			par->entering = false;
+			frame->move_count = frame->next_move = 0;
+			solver_apply_safe_moves(&frame->state, par->path, &par->path_length);
+			frame->path_start = (u16)par->path_length;
+			u32 moves = par->path_length;
+			u32 estimate = moves + par_lower_bound(&frame->state);
+
+			if (par->par && estimate >= par->par) {
+				// can't beat the best so far
+			} else if (estimate > par->bound) {
+				if (estimate < par->next_bound) par->next_bound = estimate;
+			} else if (solver_is_trivially_won(&frame->state)) {
+				// the bound is exact here, every card left goes straight home
+				solver_play_out(&frame->state, par->path, &par->path_length);
+				par->par = par->path_length;
+				memcpy(par->best_path, par->path, par->par * sizeof(SolverMove));
+				if (!par->shortening) {
+					par_finish(par, true);
+					break;
+				}
+				par->bound = par->par - 1;
+			} else if (!par_seen(par, &frame->state, moves)) {
+				if (++par->nodes >= par->node_limit) {
+					par_finish(par, false);
+					break;
+				}
+				if (par->shortening && par->nodes >= par->node_limit / 2) {
+					// out of shortening nodes, prove what there is from below
+					par->shortening = false;
+					par->bound = par->lower_bound;
+					par_begin_iteration(par);
+					continue;
+				}
+				solver_generate_moves(frame);
+			}
+		}
+
+		if (frame->next_move == frame->move_count || par->depth + 1 == PAR_MAX_MOVES) {
+			if (par->depth > 0) {
+				--par->depth;
+				continue;
+			}
+			// a finished shortening pass searched every line that could beat
+			// the best, same as IDA* running out of lines under it
+			if (par->shortening || par->next_bound == PAR_NO_BOUND || par->next_bound > PAR_MAX_MOVES) {
+				par_finish(par, true);
+				break;
+			}
+			par->bound = par->lower_bound = par->next_bound;
+			par_begin_iteration(par);
+			continue;
+		}
+
+		SolverMove move = frame->moves[frame->next_move++];
+		SolverFrame *next = &par->frames[par->depth + 1];
+		next->state = frame->state;
+		solver_apply(&next->state, move);
+		par->path_length = frame->path_start;
+		par->path[par->path_length++] = move;
+		++par->depth;
+		par->entering = true;
+	}
+
+	par->seconds += oc_clock_time(OC_CLOCK_MONOTONIC) - start_time;
+	return par->status;
+}
@@ -0,0 +1,69 @@
+// Par finder for offline analysis.
+//
+// Builds natively against headless/orca.h like bench.c. Runs the game's par
+// search (par.c) on a range of deals for one draw mode and writes a JSON line
+// per deal: the par and whether it is proven, the plain solver's win it
+// started from, the lower bound at the start and where the proof got to,
+// iterations, nodes, peak table use against the memory cap and the time. A
+// summary line follows.
+//
+// usage: parfind <1|3> first_deal count [node_limit] [memory_cap_mb] [output.jsonl]
+
+#include "solitaire.c"
+
+int main(int argc, char **argv) {
+	if (argc < 4) {
+		fprintf(stderr, "usage: parfind <1|3> first_deal count [node_limit] [memory_cap_mb] [output.jsonl]\n");
+		return 1;
+	}
+	bool draw_three = atoi(argv[1]) == 3;
+	u32 first = (u32)strtoul(argv[2], NULL, 10);
+	u32 count = (u32)strtoul(argv[3], NULL, 10);
+	u64 node_limit = argc > 4 ? strtoull(argv[4], NULL, 10) : PAR_NODE_LIMIT;
+	u64 memory_cap = argc > 5 ? strtoull(argv[5], NULL, 10) << 20 : PAR_MEMORY_CAP;
+	FILE *out = argc > 6 ? fopen(argv[6], "w") : stdout;
+	if (!out) {
+		fprintf(stderr, "could not open %s\n", argv[6]);
+		return 1;
+	}
+
+	headless.log_info = false;
+
+	ParSearch par;
+	par_init(&par, memory_cap);
+
+	u32 won = 0, proven = 0;
+	u64 total_par = 0, total_seed = 0, total_gap = 0, total_nodes = 0;
+	f64 total_seconds = 0;
+	for (u32 i=0; i<count; ++i) {
+		SolverState state;
+		solver_deal(&state, first + i, draw_three);
+		par_start(&par, &state, node_limit);
+		par_run(&par, 0);
+
+		fprintf(out, "{\"deal\":%u,\"draw\":%d,\"par\":%u,\"proven\":%s,\"seed_par\":%u,\"first_bound\":%u,"
+			"\"lower_bound\":%u,\"iterations\":%u,\"nodes\":%llu,\"table_peak\":%u,\"table_slots\":%u,\"bytes\":%llu,\"ms\":%.1f}\n",
+			first + i, draw_three ? 3 : 1, par.par, par.proven ? "true" : "false", par.seed_par, par.first_bound,
+			par.lower_bound, par.iterations, (unsigned long long)par.nodes, par.table_peak, par.table_mask + 1,
+			(unsigned long long)par.bytes, par.seconds * 1000.0);
+		fflush(out);
+
+		total_nodes += par.nodes;
+		total_seconds += par.seconds;
+		if (par.par) {
+			++won;
+			proven += par.proven;
+			total_par += par.par;
+			total_seed += par.seed_par;
+			total_gap += par.par - par.lower_bound;
+		}
+	}
+
+	fprintf(out, "{\"summary\":true,\"draw\":%d,\"deals\":%u,\"won\":%u,\"proven\":%u,\"mean_par\":%.1f,"
+		"\"mean_seed_par\":%.1f,\"mean_unproven_gap\":%.2f,\"nodes\":%llu,\"nodes_per_s\":%.0f,\"seconds\":%.1f}\n",
+		draw_three ? 3 : 1, count, won, proven,
+		won ? (f64)total_par / won : 0.0, won ? (f64)total_seed / won : 0.0, won ? (f64)total_gap / won : 0.0,
+		(unsigned long long)total_nodes, total_seconds > 0 ? total_nodes / total_seconds : 0.0, total_seconds);
+	if (out != stdout) fclose(out);
+	return 0;
+}
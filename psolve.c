@@ -0,0 +1,356 @@
+// Parallel solver for offline deal analysis.
+//
+// Builds natively against headless/orca.h like bench.c. The position is split
+// near the root into a fixed list of subtrees, in the order a single search
+// would visit them, and worker threads search them with their own Solver. Each
+// worker takes subtrees from the front of its own deque and steals from the
+// back of the others when it runs dry. States found dead for good go in a
+// lock free table all workers read, see solver_visit.
+//
+// The answer is the same for any thread count: the subtree list doesn't depend
+// on it, a subtree's own search never depends on what the others found (dead
+// states only cut branches that couldn't win), and the reported solution is
+// the one from the first subtree in order that wins. Only node counts and times
+// change. That holds as long as no subtree hits the node limit.
+//
+// For each deal it solves once per thread count from 1 up to the maximum,
+// doubling, checks the answers agree and writes a JSON line per run, then a
+// line per thread count with the total time and speedup over one thread.
+//
+// node_limit applies to each subtree.
+//
+// usage: psolve <1|3> first_deal count [node_limit] [max_threads] [output.jsonl]
+
+#include "solitaire.c"
+#include "native_threads.c"
+
+#define PSOLVE_SPLIT_TASKS 64
+#define PSOLVE_SPLIT_MAX_DEPTH 8
+#define PSOLVE_PREFIX_MAX 64
+#define PSOLVE_MAX_THREADS 64
+#define PSOLVE_SHARED_SLOTS (1u << 22)
+#define PSOLVE_DEFAULT_NODE_LIMIT 2000000
+
+typedef struct {
+	SolverState state;
+	SolverMove prefix[PSOLVE_PREFIX_MAX]; // moves from the root to state
+	u32 prefix_length;
+	SolverResult result;
+	u32 nodes;
+	SolverMove *solution; // prefix plus the subtree's path, if it won
+	u32 solution_length;
+} PsolveTask;
+
+typedef struct {
+	volatile i32 lock;
+	i32 head, tail; // tasks[head..tail) are left
+	i32 *tasks;
+} PsolveDeque;
+
+typedef struct PsolveRun PsolveRun;
+
+typedef struct {
+	PsolveRun *run;
+	i32 index;
+	i32 task;
+	Solver solver;
+	oc_arena arena;
+	u64 nodes;
+	u32 steals;
+} PsolveWorker;
+
+struct PsolveRun {
+	PsolveTask *tasks;
+	i32 task_count;
+	i32 thread_count;
+	PsolveWorker *workers;
+	PsolveDeque deques[PSOLVE_MAX_THREADS];
+	SolverSharedTable shared;
+	volatile i32 first_win; // lowest task index that won
+};
+
+static f64 psolve_now(void) {
+	return oc_clock_time(OC_CLOCK_MONOTONIC);
+}
+
+//------------------------------------------------------------------------------
+// root split
+//------------------------------------------------------------------------------
+typedef struct {
+	PsolveTask *tasks;
+	i32 count;
+	i32 capacity;
+	SolverMove prefix[PSOLVE_PREFIX_MAX];
+} PsolveSplit;
+
+// collects the positions depth moves below s in search order
+static void psolve_split_walk(PsolveSplit *split, SolverState s, u32 prefix_length, i32 depth) {
+	solver_apply_safe_moves(&s, split->prefix, &prefix_length);
+
+	SolverFrame frame = { .state = s };
+	if (!solver_is_trivially_won(&s)) {
+		solver_generate_moves(&frame);
+	}
+	if (depth == 0 || frame.move_count == 0 || prefix_length + 1 >= PSOLVE_PREFIX_MAX) {
+		if (split->count < split->capacity) {
+			PsolveTask *task = &split->tasks[split->count];
+			memset(task, 0, sizeof(*task));
+			task->state = s;
+			task->prefix_length = prefix_length;
+			memcpy(task->prefix, split->prefix, prefix_length * sizeof(SolverMove));
+		}
+		++split->count;
+		return;
+	}
+	for (i32 i=0; i<frame.move_count; ++i) {
+		SolverState next = s;
+		solver_apply(&next, frame.moves[i]);
+		split->prefix[prefix_length] = frame.moves[i];
+		psolve_split_walk(split, next, prefix_length + 1, depth - 1);
+	}
+}
+
+// splits one level deeper until there are enough subtrees, the list depends
+// only on the position
+static i32 psolve_split(SolverState *root, PsolveTask *tasks, i32 capacity) {
+	PsolveSplit split = { .tasks = tasks, .capacity = capacity };
+	i32 chosen = 1;
+	for (i32 depth=1; depth <= PSOLVE_SPLIT_MAX_DEPTH; ++depth) {
+		split.count = 0;
+		psolve_split_walk(&split, *root, 0, depth);
+		if (split.count > capacity) break;
+		chosen = depth;
+		if (split.count >= PSOLVE_SPLIT_TASKS) break;
+	}
+	split.count = 0;
+	psolve_split_walk(&split, *root, 0, chosen);
+	return split.count;
+}
+
+//------------------------------------------------------------------------------
+// workers
+//------------------------------------------------------------------------------
+static bool psolve_should_stop(void *user) {
+	PsolveWorker *worker = user;
+	return __atomic_load_n(&worker->run->first_win, __ATOMIC_RELAXED) < worker->task;
+}
+
+static bool psolve_take(PsolveWorker *worker, i32 *task) {
+	PsolveRun *run = worker->run;
+	PsolveDeque *own = &run->deques[worker->index];
+	native_lock(&own->lock);
+	bool found = own->head < own->tail;
+	if (found) *task = own->tasks[own->head++];
+	native_unlock(&own->lock);
+	if (found) return true;
+
+	for (i32 i=1; i<run->thread_count; ++i) {
+		PsolveDeque *victim = &run->deques[(worker->index + i) % run->thread_count];
+		native_lock(&victim->lock);
+		found = victim->head < victim->tail;
+		if (found) *task = victim->tasks[--victim->tail];
+		native_unlock(&victim->lock);
+		if (found) {
+			++worker->steals;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void psolve_work(PsolveWorker *worker) {
+	PsolveRun *run = worker->run;
+	i32 index;
+	while (psolve_take(worker, &index)) {
+		PsolveTask *task = &run->tasks[index];
+		if (__atomic_load_n(&run->first_win, __ATOMIC_RELAXED) < index) {
+			task->result = SOLVER_UNKNOWN;
+			continue;
+		}
+
+		worker->task = index;
+		Solver *solver = &worker->solver;
+		task->result = solver_solve(solver, &task->state);
+		task->nodes = solver->nodes;
+		worker->nodes += solver->nodes;
+
+		if (task->result == SOLVER_WON) {
+			task->solution_length = task->prefix_length + solver->path_length;
+			task->solution = malloc(task->solution_length * sizeof(SolverMove));
+			memcpy(task->solution, task->prefix, task->prefix_length * sizeof(SolverMove));
+			memcpy(task->solution + task->prefix_length, solver->path, solver->path_length * sizeof(SolverMove));
+
+			i32 first = __atomic_load_n(&run->first_win, __ATOMIC_RELAXED);
+			while (index < first && !__atomic_compare_exchange_n(&run->first_win, &first, index, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+		}
+	}
+}
+
+static void psolve_thread_proc(void *arg) {
+	psolve_work(arg);
+}
+
+//------------------------------------------------------------------------------
+// runner
+//------------------------------------------------------------------------------
+typedef struct {
+	SolverResult result;
+	u32 solution_length;
+	u64 solution_hash;
+	u64 nodes;
+	u32 steals;
+	i32 tasks;
+	f64 seconds;
+} PsolveOutcome;
+
+static PsolveOutcome psolve_solve(PsolveRun *run, PsolveWorker *workers, i32 thread_count, SolverState *root) {
+	PsolveOutcome outcome = {0};
+	f64 start = psolve_now();
+
+	run->task_count = psolve_split(root, run->tasks, PSOLVE_SPLIT_TASKS * 4);
+	run->thread_count = thread_count;
+	run->workers = workers;
+	run->first_win = INT32_MAX;
+	memset(run->shared.slots, 0, ((u64)run->shared.mask + 1) * sizeof(u64));
+
+	// each worker starts with an even share, in order, so early subtrees are
+	// searched first and a win there cuts the later ones short
+	for (i32 t=0; t<thread_count; ++t) {
+		PsolveDeque *deque = &run->deques[t];
+		deque->lock = 0;
+		deque->head = deque->tail = 0;
+		for (i32 i=t; i<run->task_count; i+=thread_count) {
+			deque->tasks[deque->tail++] = i;
+		}
+		workers[t].run = run;
+		workers[t].index = t;
+		workers[t].nodes = 0;
+		workers[t].steals = 0;
+	}
+
+	NativeThread threads[PSOLVE_MAX_THREADS];
+	for (i32 t=1; t<thread_count; ++t) {
+		native_thread_start(&threads[t], psolve_thread_proc, &workers[t]);
+	}
+	psolve_work(&workers[0]);
+	for (i32 t=1; t<thread_count; ++t) {
+		native_thread_join(&threads[t]);
+	}
+	outcome.seconds = psolve_now() - start;
+
+	outcome.result = SOLVER_LOST;
+	for (i32 i=0; i<run->task_count; ++i) {
+		PsolveTask *task = &run->tasks[i];
+		if (i == run->first_win) {
+			outcome.result = SOLVER_WON;
+			outcome.solution_length = task->solution_length;
+			u64 hash = 0xcbf29ce484222325ull;
+			for (u32 k=0; k<task->solution_length; ++k) {
+				SolverMove m = task->solution[k];
+				hash = (hash ^ (m.from | m.to << 8 | m.count << 16)) * 0x100000001b3ull;
+			}
+			outcome.solution_hash = hash;
+			break;
+		}
+		if (task->result == SOLVER_UNKNOWN) {
+			outcome.result = SOLVER_UNKNOWN;
+		}
+	}
+	for (i32 i=0; i<run->task_count; ++i) {
+		free(run->tasks[i].solution);
+		run->tasks[i].solution = NULL;
+	}
+	for (i32 t=0; t<thread_count; ++t) {
+		outcome.nodes += workers[t].nodes;
+		outcome.steals += workers[t].steals;
+	}
+	outcome.tasks = run->task_count;
+	return outcome;
+}
+
+static const char *psolve_result_names[] = {
+	[SOLVER_UNKNOWN] = "unknown",
+	[SOLVER_WON]     = "won",
+	[SOLVER_LOST]    = "lost",
+};
+
+int main(int argc, char **argv) {
+	if (argc < 4) {
+		fprintf(stderr, "usage: psolve <1|3> first_deal count [node_limit] [max_threads] [output.jsonl]\n");
+		return 1;
+	}
+	bool draw_three = atoi(argv[1]) == 3;
+	u32 first = (u32)strtoul(argv[2], NULL, 10);
+	u32 count = (u32)strtoul(argv[3], NULL, 10);
+	u32 node_limit = argc > 4 ? (u32)strtoul(argv[4], NULL, 10) : PSOLVE_DEFAULT_NODE_LIMIT;
+	i32 max_threads = argc > 5 ? atoi(argv[5]) : native_cpu_count();
+	if (max_threads < 1) max_threads = 1;
+	if (max_threads > PSOLVE_MAX_THREADS) max_threads = PSOLVE_MAX_THREADS;
+	FILE *out = stdout;
+	if (argc > 6) {
+		out = fopen(argv[6], "w");
+		if (!out) {
+			fprintf(stderr, "could not open %s\n", argv[6]);
+			return 1;
+		}
+	}
+
+	headless.log_info = false;
+
+	static PsolveRun run;
+	run.tasks = calloc(PSOLVE_SPLIT_TASKS * 4, sizeof(PsolveTask));
+	run.shared.mask = PSOLVE_SHARED_SLOTS - 1;
+	run.shared.slots = malloc(PSOLVE_SHARED_SLOTS * sizeof(u64));
+	for (i32 t=0; t<max_threads; ++t) {
+		run.deques[t].tasks = malloc(PSOLVE_SPLIT_TASKS * 4 * sizeof(i32));
+	}
+
+	PsolveWorker *workers = calloc(max_threads, sizeof(PsolveWorker));
+	for (i32 t=0; t<max_threads; ++t) {
+		oc_arena_init(&workers[t].arena);
+		solver_init(&workers[t].solver, &workers[t].arena, node_limit);
+		workers[t].solver.shared = &run.shared;
+		workers[t].solver.should_stop = psolve_should_stop;
+		workers[t].solver.user = &workers[t];
+	}
+
+	i32 thread_counts[PSOLVE_MAX_THREADS];
+	i32 runs = 0;
+	for (i32 t=1; t < max_threads; t *= 2) thread_counts[runs++] = t;
+	thread_counts[runs++] = max_threads;
+	f64 total_seconds[PSOLVE_MAX_THREADS] = {0};
+	u32 mismatches = 0;
+
+	for (u32 deal=first; deal < first + count; ++deal) {
+		SolverState root;
+		solver_deal(&root, deal, draw_three);
+		PsolveOutcome reference = {0};
+		for (i32 r=0; r<runs; ++r) {
+			PsolveOutcome outcome = psolve_solve(&run, workers, thread_counts[r], &root);
+			total_seconds[r] += outcome.seconds;
+			if (r == 0) {
+				reference = outcome;
+			}
+			bool same = outcome.result == reference.result &&
+			            outcome.solution_length == reference.solution_length &&
+			            outcome.solution_hash == reference.solution_hash;
+			mismatches += !same;
+			fprintf(out, "{\"deal\":%u,\"draw\":%d,\"threads\":%d,\"result\":\"%s\",\"solution_moves\":%u,\"tasks\":%d,\"nodes\":%llu,\"steals\":%u,\"ms\":%.2f,\"matches_one_thread\":%s}\n",
+				deal, draw_three ? 3 : 1, thread_counts[r], psolve_result_names[outcome.result],
+				outcome.solution_length, outcome.tasks, outcome.nodes, outcome.steals,
+				outcome.seconds * 1000.0, same ? "true" : "false");
+		}
+		fflush(out);
+	}
+
+	for (i32 r=0; r<runs; ++r) {
+		fprintf(out, "{\"threads\":%d,\"total_ms\":%.1f,\"speedup\":%.2f}\n",
+			thread_counts[r], total_seconds[r] * 1000.0,
+			total_seconds[r] > 0 ? total_seconds[0] / total_seconds[r] : 0);
+	}
+	fprintf(stderr, "%u deals, %d thread counts up to %d, %u runs disagreed with one thread\n",
+		count, runs, max_threads, mismatches);
+
+	if (out != stdout) fclose(out);
+	return mismatches > 0;
+}
@@ -0,0 +1,323 @@
+// Deal difficulty rater for offline analysis.
+//
+// Builds natively against headless/orca.h like bench.c. Each deal is solved
+// once and rated 1 (easy) to 10 (hard) from what the solve cost and what the
+// opening deal looks like:
+//
+//   nodes            positions the solver expanded
+//   max_depth        deepest line it had to look down
+//   recycles         times the solution turns the waste back over
+//   buried_aces      cards covering the aces, a stock ace counts the draws
+//                    it takes to reach it
+//   blocked_kings    face down kings with cards under them, each one ties up
+//                    a column until an empty pile turns up
+//   face_down_depth  cards covering the face down twos and threes
+//
+// The rating comes from fixed weights and thresholds (rate_score and
+// rate_thresholds), so a deal keeps its rating however many others get rated
+// next to it. Deals the solver loses or gives up on get rating 0 and no band.
+//
+// Every rated deal is a JSON line in the cache file. Deals already in the
+// cache are not solved again, new ones are appended. Deals are solved on all
+// cores, each worker takes the next unrated deal. Once the range is done the
+// whole cache for the draw mode is written out as band tables for the game's
+// deal filter: easy_drawN.dat (1-3), medium_drawN.dat (4-7) and
+// hard_drawN.dat (8-10) in table_dir, see deal_table.c.
+//
+// usage: rate <1|3> first_deal count cache.jsonl [node_limit] [threads] [table_dir]
+
+#include "solitaire.c"
+#include "native_threads.c"
+#include "deal_table_write.c"
+
+#define RATE_DEFAULT_NODE_LIMIT 100000
+#define RATE_MAX_THREADS 64
+
+typedef struct {
+	u32 deal;
+	bool draw_three;
+	SolverResult result;
+	u32 nodes;
+	u32 max_depth;
+	u32 recycles;
+	u32 buried_aces;
+	u32 blocked_kings;
+	u32 face_down_depth;
+	f32 score;
+	u32 rating;
+} RateEntry;
+
+typedef struct {
+	RateEntry *entries;
+	u32 count;
+	volatile u32 next; // next entry to rate
+} RateRun;
+
+typedef struct {
+	RateRun *run;
+	Solver solver;
+	oc_arena arena;
+} RateWorker;
+
+//------------------------------------------------------------------------------
+// rating
+//------------------------------------------------------------------------------
+static void rate_features(RateEntry *entry, SolverState *s) {
+	u32 draw = s->draw_three ? 3 : 1;
+	entry->buried_aces = 0;
+	entry->blocked_kings = 0;
+	entry->face_down_depth = 0;
+
+	for (i32 i=0; i<7; ++i) {
+		for (i32 j=0; j < s->tableau_count[i]; ++j) {
+			u8 kind = solver_card_kind(s->tableau[i][j]);
+			u32 above = (u32)(s->tableau_count[i] - 1 - j);
+			bool face_down = j < s->tableau_hidden[i];
+			if (kind == CARD_ACE) {
+				entry->buried_aces += above;
+			} else if (face_down && kind <= CARD_ACE + 2) {
+				entry->face_down_depth += above;
+			} else if (face_down && kind == CARD_KING && j > 0) {
+				++entry->blocked_kings;
+			}
+		}
+	}
+	// talon[0] is the top of the stock
+	for (i32 i=0; i < s->talon_count; ++i) {
+		if (solver_card_kind(s->talon[i]) == CARD_ACE) {
+			entry->buried_aces += (u32)i / draw + 1;
+		}
+	}
+}
+
+// NOTE(shaw): the weights put the search effort first, log2 of the nodes is
+// about 7 for a deal that falls out and 16 for one at the node limit. the
+// opening features only move a deal within its effort band. changing any of
+// this means regenerating the band tables.
+static f32 rate_score(RateEntry *entry) {
+	return log2f((f32)entry->nodes + 1) +
+	       0.02f * (f32)entry->max_depth +
+	       1.0f * (f32)entry->recycles +
+	       0.1f * (f32)entry->buried_aces +
+	       0.5f * (f32)entry->blocked_kings +
+	       0.05f * (f32)entry->face_down_depth;
+}
+
+// the score a deal has to pass for ratings 2 to 10, taken from the deciles of
+// deals 1-2000 in each draw mode
+static const f32 rate_thresholds[2][9] = {
+	{ 11.24f, 12.04f, 12.59f, 13.14f, 13.81f, 14.42f, 15.18f, 16.03f, 17.86f }, // turn 1
+	{ 12.62f, 14.46f, 15.75f, 17.01f, 18.41f, 19.71f, 21.04f, 22.57f, 24.76f }, // turn 3
+};
+
+static u32 rate_from_score(f32 score, bool draw_three) {
+	u32 rating = 1;
+	while (rating < 10 && score > rate_thresholds[draw_three ? 1 : 0][rating - 1]) {
+		++rating;
+	}
+	return rating;
+}
+
+static void rate_deal(RateEntry *entry, Solver *solver) {
+	SolverState state;
+	solver_deal(&state, entry->deal, entry->draw_three);
+	rate_features(entry, &state);
+
+	entry->result = solver_solve(solver, &state);
+	entry->nodes = solver->nodes;
+	entry->max_depth = solver->max_depth;
+	entry->recycles = 0;
+	for (u32 i=0; i < solver->path_length; ++i) {
+		entry->recycles += solver->path[i].to == SOLVER_PILE_STOCK;
+	}
+	entry->score = rate_score(entry);
+	entry->rating = entry->result == SOLVER_WON ? rate_from_score(entry->score, entry->draw_three) : 0;
+}
+
+static void rate_work(void *arg) {
+	RateWorker *worker = arg;
+	RateRun *run = worker->run;
+	for (;;) {
+		u32 i = __atomic_fetch_add(&run->next, 1, __ATOMIC_RELAXED);
+		if (i >= run->count) break;
+		rate_deal(&run->entries[i], &worker->solver);
+	}
+}
+
+//------------------------------------------------------------------------------
+// cache
+//------------------------------------------------------------------------------
+static const char *rate_result_names[] = {
+	[SOLVER_UNKNOWN] = "unknown",
+	[SOLVER_WON]     = "won",
+	[SOLVER_LOST]    = "lost",
+};
+
+static void rate_write_entry(FILE *out, RateEntry *e) {
+	fprintf(out, "{\"deal\":%u,\"draw\":%d,\"result\":\"%s\",\"nodes\":%u,\"max_depth\":%u,"
+		"\"recycles\":%u,\"buried_aces\":%u,\"blocked_kings\":%u,\"face_down_depth\":%u,"
+		"\"score\":%.3f,\"rating\":%u}\n",
+		e->deal, e->draw_three ? 3 : 1, rate_result_names[e->result], e->nodes, e->max_depth,
+		e->recycles, e->buried_aces, e->blocked_kings, e->face_down_depth, e->score, e->rating);
+}
+
+static bool rate_read_entry(const char *line, RateEntry *e) {
+	char result[16];
+	i32 draw;
+	i32 n = sscanf(line, "{\"deal\":%u,\"draw\":%d,\"result\":\"%15[a-z]\",\"nodes\":%u,\"max_depth\":%u,"
+		"\"recycles\":%u,\"buried_aces\":%u,\"blocked_kings\":%u,\"face_down_depth\":%u,"
+		"\"score\":%f,\"rating\":%u}",
+		&e->deal, &draw, result, &e->nodes, &e->max_depth,
+		&e->recycles, &e->buried_aces, &e->blocked_kings, &e->face_down_depth, &e->score, &e->rating);
+	if (n != 11) {
+		return false;
+	}
+	e->draw_three = draw == 3;
+	e->result = SOLVER_UNKNOWN;
+	for (i32 i=0; i<ARRAY_COUNT(rate_result_names); ++i) {
+		if (strcmp(result, rate_result_names[i]) == 0) e->result = (SolverResult)i;
+	}
+	return true;
+}
+
+static int rate_compare_deal(const void *a, const void *b) {
+	u32 x = ((const RateEntry*)a)->deal, y = ((const RateEntry*)b)->deal;
+	return x < y ? -1 : x > y;
+}
+
+//------------------------------------------------------------------------------
+// band tables
+//------------------------------------------------------------------------------
+typedef struct {
+	const char *name;
+	u32 min_rating, max_rating;
+} RateBand;
+
+static const RateBand rate_bands[] = {
+	{ "easy",   1, 3 },
+	{ "medium", 4, 7 },
+	{ "hard",   8, 10 },
+};
+
+// entries sorted by deal
+static bool rate_write_bands(const char *dir, RateEntry *entries, u32 count, bool draw_three) {
+	bool ok = true;
+	u32 *deals = malloc((u64)(count ? count : 1) * sizeof(u32));
+	for (i32 b=0; b<ARRAY_COUNT(rate_bands); ++b) {
+		u32 band_count = 0;
+		for (u32 i=0; i<count; ++i) {
+			u32 rating = entries[i].rating;
+			if (rating >= rate_bands[b].min_rating && rating <= rate_bands[b].max_rating) {
+				deals[band_count++] = entries[i].deal;
+			}
+		}
+		char path[1024];
+		snprintf(path, sizeof(path), "%s/%s_draw%d.dat", dir, rate_bands[b].name, draw_three ? 3 : 1);
+		ok = deal_table_write(path, deals, band_count) && ok;
+	}
+	free(deals);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+int main(int argc, char **argv) {
+	if (argc < 5) {
+		fprintf(stderr, "usage: rate <1|3> first_deal count cache.jsonl [node_limit] [threads] [table_dir]\n");
+		return 1;
+	}
+	bool draw_three = atoi(argv[1]) == 3;
+	u32 first = (u32)strtoul(argv[2], NULL, 10);
+	u32 count = (u32)strtoul(argv[3], NULL, 10);
+	const char *cache_path = argv[4];
+	u32 node_limit = argc > 5 ? (u32)strtoul(argv[5], NULL, 10) : RATE_DEFAULT_NODE_LIMIT;
+	i32 thread_count = argc > 6 ? atoi(argv[6]) : native_cpu_count();
+	const char *table_dir = argc > 7 ? argv[7] : NULL;
+	if (thread_count < 1) thread_count = 1;
+	if (thread_count > RATE_MAX_THREADS) thread_count = RATE_MAX_THREADS;
+
+	headless.log_info = false;
+
+	// everything cached for this draw mode, then the deals still to rate
+	u32 capacity = count + 1024;
+	u32 cached = 0;
+	RateEntry *entries = malloc((u64)capacity * sizeof(RateEntry));
+	FILE *cache = fopen(cache_path, "r");
+	if (cache) {
+		char line[512];
+		while (fgets(line, sizeof(line), cache)) {
+			RateEntry entry;
+			if (!rate_read_entry(line, &entry) || entry.draw_three != draw_three) continue;
+			if (cached == capacity) {
+				capacity *= 2;
+				entries = realloc(entries, (u64)capacity * sizeof(RateEntry));
+			}
+			entries[cached++] = entry;
+		}
+		fclose(cache);
+	}
+	qsort(entries, cached, sizeof(RateEntry), rate_compare_deal);
+
+	RateRun run = {0};
+	if (cached + count > capacity) {
+		capacity = cached + count;
+		entries = realloc(entries, (u64)capacity * sizeof(RateEntry));
+	}
+	run.entries = entries + cached;
+	for (u32 i=0; i<count; ++i) {
+		RateEntry key = { .deal = first + i };
+		if (!bsearch(&key, entries, cached, sizeof(RateEntry), rate_compare_deal)) {
+			run.entries[run.count++] = (RateEntry){ .deal = first + i, .draw_three = draw_three };
+		}
+	}
+
+	RateWorker workers[RATE_MAX_THREADS];
+	NativeThread threads[RATE_MAX_THREADS];
+	for (i32 t=0; t<thread_count; ++t) {
+		workers[t].run = &run;
+		oc_arena_init(&workers[t].arena);
+		solver_init(&workers[t].solver, &workers[t].arena, node_limit);
+	}
+	f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+	for (i32 t=1; t<thread_count; ++t) {
+		native_thread_start(&threads[t], rate_work, &workers[t]);
+	}
+	rate_work(&workers[0]);
+	for (i32 t=1; t<thread_count; ++t) {
+		native_thread_join(&threads[t]);
+	}
+	f64 seconds = oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+
+	cache = fopen(cache_path, "a");
+	if (!cache) {
+		fprintf(stderr, "could not open %s\n", cache_path);
+		return 1;
+	}
+	u32 histogram[11] = {0};
+	for (u32 i=0; i<run.count; ++i) {
+		rate_write_entry(cache, &run.entries[i]);
+	}
+	fclose(cache);
+
+	u32 total = cached + run.count;
+	qsort(entries, total, sizeof(RateEntry), rate_compare_deal);
+	for (u32 i=0; i<total; ++i) {
+		++histogram[entries[i].rating];
+	}
+	fprintf(stderr, "turn %d: rated %u deals in %.1fs (%.0f deals/s) on %d threads, %u already cached\n",
+		draw_three ? 3 : 1, run.count, seconds, seconds > 0 ? run.count / seconds : 0.0, thread_count,
+		count - run.count);
+	fprintf(stderr, "ratings over %u cached deals:", total);
+	for (i32 r=0; r<=10; ++r) {
+		fprintf(stderr, " %d:%u", r, histogram[r]);
+	}
+	fprintf(stderr, "\n");
+
+	bool ok = true;
+	if (table_dir) {
+		ok = rate_write_bands(table_dir, entries, total, draw_three);
+	}
+	free(entries);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+// Software rendering of board states, for golden images and render benchmarks.
+//
+// Builds natively against headless/orca.h like bench.c, and draws each
+// scenario's frame with headless/raster.h: solitaire_draw records the canvas
+// calls, raster_draw_record turns them into pixels. The assets are read from
+// the data directory, so run it from the repository root.
+//
+// Each scenario is drawn once (decoding and resampling its images) and then
+// frames more times from the warm caches, the JSON line per scenario gives the
+// first frame and the mean, p50 and p99 of the rest with the frames per
+// second they come to. Given a golden directory (golden/ in the repository,
+// created if it is missing) the frame is compared with <scenario>.png there:
+// a missing golden image is written, a pixel off by more than
+// RENDER_TOLERANCE in any channel fails the scenario and the frame is
+// written next to it as <scenario>.actual.png. The exit code is the number of
+// scenarios that failed.
+//
+// usage: render [frames] [golden_dir] [output.jsonl]
+
+#include "solitaire.c"
+#include "raster.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define render_make_dir(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define render_make_dir(path) mkdir(path, 0755)
+#endif
+
+#define RENDER_DEFAULT_FRAMES 1000
+#define RENDER_DEAL 1
+#define RENDER_TOLERANCE 2
+
+typedef struct {
+	const char *name;
+	void (*setup)(GameState *game);
+} RenderScenario;
+
+static f64 render_now(void) {
+	return headless_wall_time() * 1e6; // microseconds, the monotonic clock is manual
+}
+
+static int render_compare_f64(const void *a, const void *b) {
+	f64 x = *(const f64*)a;
+	f64 y = *(const f64*)b;
+	return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+// board setups, every one starts from the same deal
+//------------------------------------------------------------------------------
+// the deal with every pile emptied, for setups that lay out their own cards
+static void render_clear_board(GameState *game) {
+	game_reset_with_deal(game, RENDER_DEAL);
+	oc_list_init(&game->stock.cards);
+	oc_list_init(&game->waste.cards);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		oc_list_init(&game->foundations[i].cards);
+	}
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		oc_list_init(&game->tableau[i].cards);
+	}
+	game->card_dragging = NULL;
+	set_state(game, STATE_PLAY);
+}
+
+static void render_steps(GameState *game, i32 steps) {
+	for (i32 i=0; i<steps; ++i) {
+		solitaire_simulate_step(game);
+	}
+}
+
+static void render_settle(GameState *game) {
+	for (i32 i=0; i<10000 && game->state == STATE_DEALING; ++i) {
+		solitaire_simulate_step(game);
+	}
+	render_steps(game, 600);
+}
+
+static void render_click(GameState *game, f32 x, f32 y) {
+	oc_on_mouse_move(x, y, 0, 0);
+	oc_on_mouse_down(OC_MOUSE_LEFT);
+	solitaire_simulate_step(game);
+	oc_on_mouse_up(OC_MOUSE_LEFT);
+	solitaire_simulate_step(game);
+}
+
+static void setup_dealing(GameState *game) {
+	game_reset_with_deal(game, RENDER_DEAL);
+	render_steps(game, 20);
+}
+
+static void setup_fresh_deal(GameState *game) {
+	game_reset_with_deal(game, RENDER_DEAL);
+	render_settle(game);
+}
+
+// one card turned from the stock, so the history bar shows
+static void setup_history_bar(GameState *game) {
+	setup_fresh_deal(game);
+	render_click(game, game->stock.pos.x + 20, game->stock.pos.y + 20);
+	render_settle(game);
+}
+
+static void setup_draw_three_waste(GameState *game) {
+	bool draw_three = game->draw_three_mode;
+	game->draw_three_mode = true;
+	setup_fresh_deal(game);
+	while (!oc_list_empty(game->stock.cards)) {
+		Card *card = pile_peek_top(&game->stock);
+		card->face_up = true;
+		pile_transfer(game, &game->waste, card, true);
+	}
+	render_settle(game);
+	game->draw_three_mode = draw_three;
+}
+
+// the 13 card run on tableau[0] held over the middle of the board
+static void setup_drag_run(GameState *game) {
+	render_clear_board(game);
+	test_deal_for_autocomplete(game, game->cards, ARRAY_COUNT(game->cards));
+	set_state(game, STATE_PLAY);
+	render_settle(game);
+
+	Card *king = oc_list_last_entry(game->tableau[0].cards, Card, node);
+	oc_on_mouse_move(king->pos.x + 0.5f * game->card_width, king->pos.y + 5, 0, 0);
+	oc_on_mouse_down(OC_MOUSE_LEFT);
+	solitaire_simulate_step(game);
+	oc_on_mouse_move(0.45f * game->frame_size.x, 0.35f * game->frame_size.y, 0, 0);
+	render_steps(game, 30);
+}
+
+static void setup_autocomplete(GameState *game) {
+	render_clear_board(game);
+	test_deal_for_autocomplete(game, game->cards, ARRAY_COUNT(game->cards));
+	start_autocomplete_sequence(game, false);
+	render_steps(game, 40);
+}
+
+static void setup_win_animation(GameState *game) {
+	render_clear_board(game);
+	test_deal_for_autocomplete(game, game->cards, ARRAY_COUNT(game->cards));
+	start_autocomplete_sequence(game, false);
+	for (i32 i=0; i<100000 && game->win_card_path.count < 1500; ++i) {
+		solitaire_simulate_step(game);
+	}
+}
+
+static void setup_rules(GameState *game) {
+	game_reset_with_deal(game, RENDER_DEAL);
+	render_settle(game);
+	set_state(game, STATE_SHOW_RULES);
+}
+
+static RenderScenario render_scenarios[] = {
+	{ "dealing",          setup_dealing },
+	{ "fresh_deal",       setup_fresh_deal },
+	{ "history_bar",      setup_history_bar },
+	{ "draw3_waste_24",   setup_draw_three_waste },
+	{ "drag_13_card_run", setup_drag_run },
+	{ "autocomplete",     setup_autocomplete },
+	{ "win_animation",    setup_win_animation },
+	{ "rules",            setup_rules },
+};
+
+//------------------------------------------------------------------------------
+// runner
+//------------------------------------------------------------------------------
+typedef struct {
+	u64 pixels; // off by more than RENDER_TOLERANCE
+	u32 max_diff;
+} RenderDiff;
+
+static RenderDiff render_diff(Raster *raster, const u32 *golden) {
+	RenderDiff diff = {0};
+	for (u64 i=0; i<(u64)raster->width * raster->height; ++i) {
+		u32 a = raster->pixels[i], b = golden[i];
+		if (a == b) continue;
+		u32 worst = 0;
+		for (i32 c=0; c<4; ++c) {
+			i32 d = (i32)((a >> (8 * c)) & 0xff) - (i32)((b >> (8 * c)) & 0xff);
+			if (d < 0) d = -d;
+			if ((u32)d > worst) worst = d;
+		}
+		if (worst > diff.max_diff) diff.max_diff = worst;
+		if (worst > RENDER_TOLERANCE) ++diff.pixels;
+	}
+	return diff;
+}
+
+// compares the frame with the golden image, or writes it if there is none.
+// returns whether the scenario passed
+static bool render_golden(Raster *raster, const char *dir, const char *name, FILE *out) {
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s.png", dir, name);
+	u32 width = 0, height = 0;
+	u32 *golden = raster_read_png(path, &width, &height);
+	if (!golden) {
+		bool written = raster_write_png(raster, path);
+		fprintf(out, ",\"golden\":\"%s\"", written ? "written" : "write_failed");
+		return written;
+	}
+
+	bool passed = false;
+	if (width != raster->width || height != raster->height) {
+		fprintf(out, ",\"golden\":\"size_mismatch\",\"golden_size\":[%u,%u]", width, height);
+	} else {
+		RenderDiff diff = render_diff(raster, golden);
+		passed = diff.pixels == 0;
+		fprintf(out, ",\"golden\":\"%s\",\"diff_pixels\":%llu,\"max_diff\":%u",
+			passed ? "match" : "mismatch", diff.pixels, diff.max_diff);
+	}
+	if (!passed) {
+		snprintf(path, sizeof(path), "%s/%s.actual.png", dir, name);
+		raster_write_png(raster, path);
+	}
+	free(golden);
+	return passed;
+}
+
+static bool render_run(GameState *game, Raster *raster, RenderScenario *scenario, i32 frames, const char *golden_dir, FILE *out) {
+	pcg32_seed(&game->rng, 0x5eed);
+	scenario->setup(game);
+	solitaire_draw(game);
+
+	f64 start = render_now();
+	raster_draw_record(raster, game);
+	f64 first_us = render_now() - start;
+
+	f64 *frame_us = malloc(frames * sizeof(f64));
+	f64 total = 0;
+	for (i32 frame=0; frame<frames; ++frame) {
+		f64 begin = render_now();
+		raster_draw_record(raster, game);
+		frame_us[frame] = render_now() - begin;
+		total += frame_us[frame];
+	}
+	qsort(frame_us, frames, sizeof(f64), render_compare_f64);
+	f64 mean = total / frames;
+
+	fprintf(out, "{\"scenario\":\"%s\",\"width\":%u,\"height\":%u,\"commands\":%d,\"frames\":%d,"
+		"\"first_frame_us\":%.1f,\"frame_us\":{\"mean\":%.1f,\"p50\":%.1f,\"p99\":%.1f},\"fps\":%.0f",
+		scenario->name, raster->width, raster->height, game->draw_record.count, frames,
+		first_us, mean, frame_us[frames / 2], frame_us[(i32)(0.99 * (frames - 1))], mean > 0 ? 1e6 / mean : 0.0);
+	free(frame_us);
+
+	bool passed = true;
+	if (golden_dir) {
+		passed = render_golden(raster, golden_dir, scenario->name, out);
+	}
+	fprintf(out, "}\n");
+	fflush(out);
+	return passed;
+}
+
+int main(int argc, char **argv) {
+	i32 frames = argc > 1 ? atoi(argv[1]) : RENDER_DEFAULT_FRAMES;
+	if (frames <= 0) frames = RENDER_DEFAULT_FRAMES;
+	const char *golden_dir = argc > 2 ? argv[2] : NULL;
+	if (golden_dir) {
+		render_make_dir(golden_dir); // fails harmlessly when it is already there
+	}
+	FILE *out = stdout;
+	if (argc > 3) {
+		out = fopen(argv[3], "w");
+		if (!out) {
+			fprintf(stderr, "could not open %s\n", argv[3]);
+			return 1;
+		}
+	}
+
+	headless.log_info = false;
+	headless.manual_clock = true;
+	headless.file_root = "data";
+	oc_on_init();
+	GameState *game = &orca_game;
+	game->telemetry_enabled = false;
+	game->interactive = false;
+
+	static Raster raster;
+	if (!raster_init(&raster, (u32)game->frame_size.x, (u32)game->frame_size.y)) {
+		fprintf(stderr, "could not allocate the frame\n");
+		return 1;
+	}
+
+	i32 failed = 0;
+	for (i32 i=0; i<ARRAY_COUNT(render_scenarios); ++i) {
+		if (!render_run(game, &raster, &render_scenarios[i], frames, golden_dir, out)) {
+			++failed;
+		}
+	}
+	raster_release(&raster);
+
+	if (out != stdout) fclose(out);
+	return failed;
+}
@@ -0,0 +1,294 @@
+// Parallel board simulation for bot evaluation and soak runs.
+//
+// Builds natively against headless/orca.h like bench.c. Every worker thread
+// keeps boards_per_thread boards of its own, each a GameState set up with
+// game_init, and steps them all in turn one SIM_STEP at a time. A board takes
+// the next deal from a shared counter, watches it deal, plays it with a simple
+// greedy bot through notation_apply_move, the same path a replayed record
+// takes, lets the autocomplete play out and hands back the result. Boards
+// share nothing but the deal counter, so throughput should grow with threads
+// until the cores run out.
+//
+// The deals are played once per thread count from 1 up to the maximum,
+// doubling. The bot only looks at its own board, so every deal must come out
+// the same whichever thread and board played it; each run is checked against
+// one thread. A JSON line per run gives deals and steps per second and the
+// speedup, then one line gives the bot's results.
+//
+// usage: sim <1|3> first_deal count [boards_per_thread] [max_threads] [output.jsonl]
+
+#include "solitaire.c"
+#include "native_threads.c"
+
+#define SIM_MAX_THREADS 64
+#define SIM_DEFAULT_BOARDS 16
+#define SIM_MAX_BOT_MOVES 1000
+
+typedef struct {
+	bool won;
+	u16 moves;
+	i32 score;
+	u32 steps;
+} SimResult;
+
+typedef struct {
+	GameState *game;
+	bool playing;
+	u32 deal;
+	u32 steps;
+	i32 stuck_recycles; // recycles since the bot last moved a card
+} SimBoard;
+
+typedef struct SimRun SimRun;
+
+typedef struct {
+	SimRun *run;
+	i32 boards;
+	SimBoard *board;
+	u64 steps;
+} SimWorker;
+
+struct SimRun {
+	bool draw_three;
+	u32 first;
+	u32 count;
+	volatile u32 next; // deals handed out so far
+	SimResult *results;
+};
+
+//------------------------------------------------------------------------------
+// bot
+//------------------------------------------------------------------------------
+// NOTE(shaw): the bot plays foundation moves first, then tableau moves that
+// turn a card over or empty a pile for a king, then the waste onto the
+// tableau, and otherwise draws. it gives up once it has gone round the stock
+// twice without moving a card, or after SIM_MAX_BOT_MOVES moves. it is meant
+// to be cheap and deterministic, not strong
+
+static bool sim_try(GameState *game, u8 kind, i32 from, i32 to, i32 count) {
+	NotationMove move = { .kind = kind, .from = (u8)from, .to = (u8)to, .count = (u8)count };
+	return notation_apply_move(game, move);
+}
+
+static bool sim_bot_move(GameState *game, SimBoard *board) {
+	// onto the foundations, waste first
+	for (i32 from=1; from<13; ++from) {
+		if (from >= 2 && from < 6) continue;
+		for (i32 to=2; to<6; ++to) {
+			if (sim_try(game, NOTATION_TRANSFER, from, to, 1)) {
+				board->stuck_recycles = 0;
+				return true;
+			}
+		}
+	}
+
+	// whole face up runs between tableau piles, when that uncovers something
+	for (i32 from=6; from<13; ++from) {
+		Pile *pile = board_pile(game, from);
+		Card *base = NULL;
+		i32 count = 0;
+		bool covers_face_down = false;
+		oc_list_for(pile->cards, card, Card, node) {
+			if (!card->face_up) {
+				covers_face_down = true;
+				break;
+			}
+			base = card;
+			++count;
+		}
+		if (!base || (!covers_face_down && base->kind == CARD_KING)) continue;
+		for (i32 to=6; to<13; ++to) {
+			if (!covers_face_down && oc_list_empty(board_pile(game, to)->cards)) continue;
+			if (sim_try(game, NOTATION_TRANSFER, from, to, count)) {
+				board->stuck_recycles = 0;
+				return true;
+			}
+		}
+	}
+
+	for (i32 to=6; to<13; ++to) {
+		if (sim_try(game, NOTATION_TRANSFER, 1, to, 1)) {
+			board->stuck_recycles = 0;
+			return true;
+		}
+	}
+
+	if (sim_try(game, NOTATION_STOCK, 0, 1, 1)) return true;
+	if (board->stuck_recycles < 2 && sim_try(game, NOTATION_RECYCLE, 1, 0, 1)) {
+		++board->stuck_recycles;
+		return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// boards
+//------------------------------------------------------------------------------
+static void sim_finish(SimRun *run, SimBoard *board) {
+	GameState *game = board->game;
+	run->results[board->deal - run->first] = (SimResult){
+		.won = game->state == STATE_WIN,
+		.moves = (u16)game->move_count,
+		.score = game->score,
+		.steps = board->steps,
+	};
+	board->playing = false;
+}
+
+// advances one board by one step, false once there are no deals left for it
+static bool sim_step_board(SimRun *run, SimBoard *board) {
+	GameState *game = board->game;
+	if (!board->playing) {
+		u32 index = __atomic_fetch_add(&run->next, 1, __ATOMIC_RELAXED);
+		if (index >= run->count) return false;
+		board->playing = true;
+		board->deal = run->first + index;
+		board->steps = 0;
+		board->stuck_recycles = 0;
+		game->draw_three_mode = run->draw_three;
+		game_reset_with_deal(game, board->deal);
+	}
+
+	if (game->state == STATE_PLAY) {
+		bool moved = game->move_count < SIM_MAX_BOT_MOVES && sim_bot_move(game, board);
+		if (!moved) {
+			sim_finish(run, board);
+			return true;
+		}
+		if (game->state == STATE_PLAY && is_autocomplete_possible(game)) {
+			start_autocomplete_sequence(game, false);
+		}
+	}
+	if (game->state == STATE_WIN) {
+		sim_finish(run, board);
+		return true;
+	}
+
+	solitaire_simulate_step(game);
+	++board->steps;
+	return true;
+}
+
+static void sim_worker_proc(void *arg) {
+	SimWorker *worker = arg;
+	i32 active = worker->boards;
+	while (active > 0) {
+		active = 0;
+		for (i32 i=0; i<worker->boards; ++i) {
+			SimBoard *board = &worker->board[i];
+			if (board->game && sim_step_board(worker->run, board)) {
+				++active;
+				++worker->steps;
+			} else {
+				board->game = NULL;
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	if (argc < 4) {
+		fprintf(stderr, "usage: sim <1|3> first_deal count [boards_per_thread] [max_threads] [output.jsonl]\n");
+		return 1;
+	}
+	bool draw_three = atoi(argv[1]) == 3;
+	u32 first = (u32)strtoul(argv[2], NULL, 10);
+	u32 count = (u32)strtoul(argv[3], NULL, 10);
+	i32 boards = argc > 4 ? atoi(argv[4]) : SIM_DEFAULT_BOARDS;
+	if (boards < 1) boards = 1;
+	i32 max_threads = argc > 5 ? atoi(argv[5]) : native_cpu_count();
+	if (max_threads < 1) max_threads = 1;
+	if (max_threads > SIM_MAX_THREADS) max_threads = SIM_MAX_THREADS;
+	FILE *out = stdout;
+	if (argc > 6) {
+		out = fopen(argv[6], "w");
+		if (!out) {
+			fprintf(stderr, "could not open %s\n", argv[6]);
+			return 1;
+		}
+	}
+
+	headless.log_info = false;
+
+	// boards are made once and reused for every run, each with its own rng
+	// stream. highscores, telemetry and the history stay off
+	i32 board_count = boards * max_threads;
+	GameState *games = calloc(board_count, sizeof(GameState));
+	for (i32 i=0; i<board_count; ++i) {
+		game_init(&games[i], 0x5eed + i);
+		games[i].history.enabled = false;
+	}
+
+	i32 thread_counts[SIM_MAX_THREADS];
+	i32 runs = 0;
+	for (i32 t=1; t < max_threads; t *= 2) thread_counts[runs++] = t;
+	thread_counts[runs++] = max_threads;
+
+	SimResult *reference = calloc(count, sizeof(SimResult));
+	SimRun run = { .draw_three = draw_three, .first = first, .count = count };
+	run.results = calloc(count, sizeof(SimResult));
+	SimWorker workers[SIM_MAX_THREADS];
+	NativeThread threads[SIM_MAX_THREADS];
+	f64 one_thread_seconds = 0;
+	u32 mismatches = 0;
+
+	for (i32 r=0; r<runs; ++r) {
+		i32 thread_count = thread_counts[r];
+		run.next = 0;
+		memset(run.results, 0, count * sizeof(SimResult));
+		for (i32 t=0; t<thread_count; ++t) {
+			SimBoard *board = calloc(boards, sizeof(SimBoard));
+			for (i32 i=0; i<boards; ++i) {
+				board[i].game = &games[t * boards + i];
+			}
+			workers[t] = (SimWorker){ .run = &run, .boards = boards, .board = board };
+		}
+
+		f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+		for (i32 t=0; t<thread_count; ++t) {
+			native_thread_start(&threads[t], sim_worker_proc, &workers[t]);
+		}
+		u64 steps = 0;
+		for (i32 t=0; t<thread_count; ++t) {
+			native_thread_join(&threads[t]);
+			steps += workers[t].steps;
+			free(workers[t].board);
+		}
+		f64 seconds = oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+		if (r == 0) {
+			one_thread_seconds = seconds;
+			memcpy(reference, run.results, count * sizeof(SimResult));
+		}
+
+		u32 differ = 0;
+		for (u32 i=0; i<count; ++i) {
+			differ += memcmp(&run.results[i], &reference[i], sizeof(SimResult)) != 0;
+		}
+		mismatches += differ;
+
+		fprintf(out, "{\"threads\":%d,\"boards\":%d,\"deals\":%u,\"steps\":%llu,\"ms\":%.1f,\"deals_per_s\":%.0f,"
+			"\"steps_per_s\":%.0f,\"speedup\":%.2f,\"deals_differing_from_one_thread\":%u}\n",
+			thread_count, thread_count * boards, count, (unsigned long long)steps, seconds * 1000.0,
+			seconds > 0 ? count / seconds : 0.0, seconds > 0 ? steps / seconds : 0.0,
+			seconds > 0 ? one_thread_seconds / seconds : 0.0, differ);
+		fflush(out);
+	}
+
+	u32 won = 0;
+	u64 total_moves = 0, won_score = 0;
+	for (u32 i=0; i<count; ++i) {
+		total_moves += reference[i].moves;
+		if (reference[i].won) {
+			++won;
+			won_score += reference[i].score;
+		}
+	}
+	fprintf(out, "{\"summary\":true,\"draw\":%d,\"deals\":%u,\"won\":%u,\"win_rate\":%.3f,\"mean_moves\":%.1f,\"mean_won_score\":%.1f}\n",
+		draw_three ? 3 : 1, count, won, count ? (f64)won / count : 0.0,
+		count ? (f64)total_moves / count : 0.0, won ? (f64)won_score / won : 0.0);
+	fprintf(stderr, "%u deals, %d thread counts up to %d, %u results disagreed with one thread\n",
+		count, runs, max_threads, mismatches);
+
+	if (out != stdout) fclose(out);
+	return mismatches > 0;
+}
@@ -0,0 +1,509 @@
+// Input level soak test.
+//
+// Builds natively against headless/orca.h like bench.c. A bot plays game
+// after game on the board the Orca entry points drive, using only the events
+// a player makes: oc_on_mouse_move, oc_on_mouse_down/up for drags and clicks,
+// right clicks for auto transfer, and the U and R keys. Everything goes
+// through oc_on_frame_refresh, so drop resolution, the animations, dealing,
+// autocomplete and the win animation all run as they do in the game.
+//
+// The headless clock is manual and every frame moves it on by
+// time_scale / 60 seconds, so at the default 8 each frame runs
+// SIM_MAX_STEPS_PER_FRAME steps and the frames run as fast as the machine
+// allows. After every frame the board is checked: every card is in exactly
+// one pile and the pile lists link up, no card sits at 0,0 (the old "card
+// jumps to the top left" bug in todo.txt), no card takes longer than
+// SOAK_STUCK_SECONDS to reach where it is going, and in play only tableau and
+// stock cards are face down and the top of every tableau pile is face up once
+// the board is still. A move the bot made that the game didn't take counts as a
+// failure too, and so does a game record that doesn't replay: whenever a game
+// is won or given up, the record Export Game would write is replayed on a
+// board of its own and has to come out at the same result and score.
+//
+// It writes a JSON line per violation (the first SOAK_MAX_REPORTED), a
+// progress line per hour of game time, and a summary with the games played,
+// the wall time per frame and the memory of every subsystem. The exit code is
+// the number of violations, capped at 255.
+//
+// usage: soak [hours] [time_scale] [seed] [output.jsonl]
+
+#include "solitaire.c"
+
+#define SOAK_MAX_EVENTS 16
+#define SOAK_DRAG_FRAMES 6
+#define SOAK_STUCK_SECONDS 10.0
+#define SOAK_WIN_SECONDS 15.0 // how much of the win animation is watched before the next deal
+#define SOAK_UNDO_CHANCE 0.03f
+#define SOAK_SLOPPY_DROP_CHANCE 0.03f
+#define SOAK_MAX_REPORTED 20
+
+typedef enum {
+	SOAK_EVENT_MOVE,
+	SOAK_EVENT_LEFT_DOWN,
+	SOAK_EVENT_LEFT_UP,
+	SOAK_EVENT_RIGHT_DOWN,
+	SOAK_EVENT_RIGHT_UP,
+	SOAK_EVENT_KEY_DOWN,
+	SOAK_EVENT_KEY_UP,
+} SoakEventKind;
+
+typedef struct {
+	SoakEventKind kind;
+	oc_vec2 pos; // SOAK_EVENT_MOVE
+	oc_key_code key; // SOAK_EVENT_KEY_*
+} SoakEvent;
+
+typedef struct {
+	GameState *game;
+	Pcg32 rng;
+	f64 frame_dt;
+
+	// the action being played out, one event a frame
+	SoakEvent events[SOAK_MAX_EVENTS];
+	i32 event_count;
+	i32 next_event;
+	oc_vec2 mouse;
+
+	// an action that should make a move checks it did once it is played out
+	bool expect_move;
+	i32 moves_before;
+	i32 stuck_recycles; // recycles since the bot last moved a card
+	f64 win_seconds;
+	StateKind last_state;
+
+	u64 frames;
+	u64 games;
+	u64 wins;
+	u64 drags;
+	u64 clicks;
+	u64 right_clicks;
+	u64 undos;
+	u64 sloppy_drops;
+	u64 records;
+	u64 violations;
+	f32 unsettled_seconds[52];
+
+	f64 *frame_us;
+	u64 frame_us_capacity;
+	u64 deal_live_first; // memory live as a deal starts
+	u64 deal_live_max;
+	GameState *replay; // a board of its own for replaying the game's records
+	FILE *out;
+} Soak;
+
+static void soak_check_record(Soak *soak);
+
+//------------------------------------------------------------------------------
+// actions
+//------------------------------------------------------------------------------
+static void soak_push(Soak *soak, SoakEvent event) {
+	assert(soak->event_count < SOAK_MAX_EVENTS);
+	soak->events[soak->event_count++] = event;
+}
+
+static void soak_move_to(Soak *soak, f32 x, f32 y) {
+	soak_push(soak, (SoakEvent){ .kind = SOAK_EVENT_MOVE, .pos = { x, y } });
+}
+
+static void soak_key(Soak *soak, oc_key_code key) {
+	soak_push(soak, (SoakEvent){ .kind = SOAK_EVENT_KEY_DOWN, .key = key });
+	soak_push(soak, (SoakEvent){ .kind = SOAK_EVENT_KEY_UP, .key = key });
+}
+
+static void soak_click(Soak *soak, oc_vec2 pos, bool right) {
+	soak_move_to(soak, pos.x, pos.y);
+	soak_push(soak, (SoakEvent){ .kind = right ? SOAK_EVENT_RIGHT_DOWN : SOAK_EVENT_LEFT_DOWN });
+	soak_push(soak, (SoakEvent){ .kind = right ? SOAK_EVENT_RIGHT_UP : SOAK_EVENT_LEFT_UP });
+	if (right) ++soak->right_clicks; else ++soak->clicks;
+}
+
+// the top strip of a card, the part that shows when cards cover it
+static oc_vec2 soak_grab_point(GameState *game, Card *card) {
+	return (oc_vec2){ card->pos.x + 0.5f * game->card_width, card->pos.y + 0.1f * game->card_height };
+}
+
+// where a card dropped on pile lines up with what is there
+static oc_vec2 soak_drop_pos(GameState *game, Pile *pile) {
+	Card *top = oc_list_first_entry(pile->cards, Card, node);
+	if (!top) return pile->pos;
+	if (pile->kind == PILE_TABLEAU) {
+		return (oc_vec2){ top->pos.x, top->pos.y + 0.25f * game->card_height };
+	}
+	return top->pos;
+}
+
+// picks card up, carries it over a few frames and lets go with its corner at to
+static void soak_drag(Soak *soak, Card *card, oc_vec2 to) {
+	GameState *game = soak->game;
+	oc_vec2 from = soak_grab_point(game, card);
+	oc_vec2 offset = { from.x - card->pos.x, from.y - card->pos.y };
+	soak_move_to(soak, from.x, from.y);
+	soak_push(soak, (SoakEvent){ .kind = SOAK_EVENT_LEFT_DOWN });
+	for (i32 i=1; i<=SOAK_DRAG_FRAMES; ++i) {
+		f32 t = (f32)i / SOAK_DRAG_FRAMES;
+		soak_move_to(soak, from.x + (to.x + offset.x - from.x) * t, from.y + (to.y + offset.y - from.y) * t);
+	}
+	soak_push(soak, (SoakEvent){ .kind = SOAK_EVENT_LEFT_UP });
+	++soak->drags;
+}
+
+static void soak_expect_move(Soak *soak) {
+	soak->expect_move = true;
+	soak->moves_before = soak->game->move_count;
+	soak->stuck_recycles = 0;
+}
+
+//------------------------------------------------------------------------------
+// bot
+//------------------------------------------------------------------------------
+// NOTE(shaw): the same greedy order as the bot in sim.c, played with the
+// mouse: foundation moves (by right click, click or drag, picked at random),
+// tableau runs that uncover a card or empty a pile, the waste onto the
+// tableau, then the stock. now and then it undoes, or drops a card somewhere
+// it can't go so it has to fly back. with nothing left it deals again
+
+static bool soak_fits_foundation(Card *card, Pile *foundation) {
+	Card *top = pile_peek_top(foundation);
+	return top ? card->suit == top->suit && card->kind == top->kind + 1 : card->kind == CARD_ACE;
+}
+
+static bool soak_plan_foundation(Soak *soak, Card *card) {
+	GameState *game = soak->game;
+	if (!card || !card->face_up) return false;
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		Pile *foundation = &game->foundations[i];
+		if (!soak_fits_foundation(card, foundation)) continue;
+		switch (pcg32_next(&soak->rng) % 3) {
+		case 0: soak_click(soak, soak_grab_point(game, card), true); break;
+		case 1: soak_click(soak, soak_grab_point(game, card), false); break;
+		default: soak_drag(soak, card, soak_drop_pos(game, foundation)); break;
+		}
+		soak_expect_move(soak);
+		return true;
+	}
+	return false;
+}
+
+static bool soak_plan_tableau(Soak *soak, Card *card, bool allow_empty) {
+	GameState *game = soak->game;
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		Pile *pile = &game->tableau[i];
+		if (pile == card->pile) continue;
+		Card *top = pile_peek_top(pile);
+		bool legal = top ? can_drop(card, top) : allow_empty && can_drop_empty_pile(game, card, pile);
+		if (!legal) continue;
+		soak_drag(soak, card, soak_drop_pos(game, pile));
+		soak_expect_move(soak);
+		return true;
+	}
+	return false;
+}
+
+static void soak_plan(Soak *soak) {
+	GameState *game = soak->game;
+	Card *waste_top = pile_peek_top(&game->waste);
+
+	f32 roll = rand_f32(&soak->rng);
+	if (roll < SOAK_UNDO_CHANCE && game->undo_stack.count > 0) {
+		soak_key(soak, OC_KEY_U);
+		++soak->undos;
+		return;
+	}
+	if (roll < SOAK_UNDO_CHANCE + SOAK_SLOPPY_DROP_CHANCE && waste_top) {
+		soak_drag(soak, waste_top, game->stock.pos);
+		++soak->sloppy_drops;
+		return;
+	}
+
+	if (soak_plan_foundation(soak, waste_top)) return;
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		if (soak_plan_foundation(soak, pile_peek_top(&game->tableau[i]))) return;
+	}
+
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		Card *base = NULL;
+		bool covers_face_down = false;
+		oc_list_for(game->tableau[i].cards, card, Card, node) {
+			if (!card->face_up) {
+				covers_face_down = true;
+				break;
+			}
+			base = card;
+		}
+		if (!base || (!covers_face_down && base->kind == CARD_KING)) continue;
+		if (soak_plan_tableau(soak, base, covers_face_down)) return;
+	}
+
+	if (waste_top && soak_plan_tableau(soak, waste_top, true)) return;
+
+	Card *stock_top = pile_peek_top(&game->stock);
+	if (stock_top) {
+		soak_click(soak, soak_grab_point(game, stock_top), false);
+		return;
+	}
+	if (waste_top && soak->stuck_recycles < 2) {
+		soak_click(soak, (oc_vec2){ game->stock.pos.x + 0.5f * game->card_width, game->stock.pos.y + 0.5f * game->card_height }, false);
+		++soak->stuck_recycles;
+		return;
+	}
+
+	soak_check_record(soak);
+	soak_key(soak, OC_KEY_R);
+}
+
+//------------------------------------------------------------------------------
+// checks
+//------------------------------------------------------------------------------
+static void soak_violation(Soak *soak, const char *what, i32 card) {
+	GameState *game = soak->game;
+	if (soak->violations++ < SOAK_MAX_REPORTED) {
+		fprintf(soak->out, "{\"violation\":\"%s\",\"frame\":%llu,\"game\":%llu,\"deal\":%u,\"state\":%d,\"card\":%d}\n",
+			what, soak->frames, soak->games, game->deal_number, game->state, card);
+		fflush(soak->out);
+	}
+}
+
+// the record the game would export has to replay to the same result and
+// score, on the replay board so the game in progress is left alone
+static void soak_check_record(Soak *soak) {
+	GameState *game = soak->game;
+	oc_arena_scope scratch = oc_scratch_begin();
+	oc_str8 record = notation_export(game, scratch.arena);
+	ReplayResult result = notation_replay(soak->replay, record.ptr, record.len);
+	if (!result.ok) {
+		soak_violation(soak, "record does not replay", -1);
+		fprintf(soak->out, "{\"record\":\"%.*s\",\"error\":\"%s\",\"token\":%d}\n",
+			(int)record.len, record.ptr, result.error, result.error_token);
+	} else if ((soak->replay->state == STATE_WIN) != (game->state == STATE_WIN)) {
+		soak_violation(soak, "record replays to a different result", -1);
+	}
+	++soak->records;
+	oc_scratch_end(scratch);
+}
+
+static bool soak_board_still(GameState *game) {
+	if (game->card_dragging) return false;
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		Card *card = &game->cards[i];
+		if (card->pos.x != card->target_pos.x || card->pos.y != card->target_pos.y) return false;
+	}
+	return true;
+}
+
+static void soak_check_pile(Soak *soak, Pile *pile, u8 *seen) {
+	GameState *game = soak->game;
+	oc_list_elt *prev = NULL;
+	for (oc_list_elt *node = pile->cards.first; node; node = node->next) {
+		if (node->prev != prev) {
+			soak_violation(soak, "broken list link", -1);
+			return;
+		}
+		Card *card = oc_list_entry(node, Card, node);
+		i32 index = (i32)(card - game->cards);
+		if (index < 0 || index >= ARRAY_COUNT(game->cards)) {
+			soak_violation(soak, "foreign card in a pile", -1);
+			return;
+		}
+		if (seen[index]++) soak_violation(soak, "card in two piles", index);
+		if (card->pile != pile) soak_violation(soak, "card pile pointer disagrees with its list", index);
+		// a sequence shows cards with the faces they had when it was planned
+		if (game->state == STATE_PLAY && !card->face_up && pile->kind != PILE_TABLEAU && pile->kind != PILE_STOCK) {
+			soak_violation(soak, "face down card outside the tableau and stock", index);
+		}
+		prev = node;
+	}
+	if (pile->cards.last != prev) soak_violation(soak, "broken list tail", -1);
+}
+
+static void soak_check(Soak *soak) {
+	GameState *game = soak->game;
+	// the win animation takes cards off the foundations for good
+	if (game->state == STATE_WIN) {
+		memset(soak->unsettled_seconds, 0, sizeof(soak->unsettled_seconds));
+		return;
+	}
+
+	u8 seen[52] = {0};
+	soak_check_pile(soak, &game->stock, seen);
+	soak_check_pile(soak, &game->waste, seen);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) soak_check_pile(soak, &game->foundations[i], seen);
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) soak_check_pile(soak, &game->tableau[i], seen);
+	for (i32 i=0; i<ARRAY_COUNT(seen); ++i) {
+		if (!seen[i]) soak_violation(soak, "card in no pile", i);
+	}
+
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		Card *card = &game->cards[i];
+		if ((card->pos.x == 0 && card->pos.y == 0) || (card->target_pos.x == 0 && card->target_pos.y == 0)) {
+			soak_violation(soak, "card at 0,0", i);
+		}
+		bool moving = card->pos.x != card->target_pos.x || card->pos.y != card->target_pos.y;
+		soak->unsettled_seconds[i] = moving ? soak->unsettled_seconds[i] + (f32)soak->frame_dt : 0;
+		if (soak->unsettled_seconds[i] > SOAK_STUCK_SECONDS) {
+			soak_violation(soak, "card stuck short of its target", i);
+			soak->unsettled_seconds[i] = 0;
+		}
+	}
+
+	if (game->state == STATE_PLAY && soak_board_still(game)) {
+		for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+			Card *top = pile_peek_top(&game->tableau[i]);
+			if (top && !top->face_up) soak_violation(soak, "face down card on top of the tableau", (i32)(top - game->cards));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// frames
+//------------------------------------------------------------------------------
+static void soak_send(Soak *soak, SoakEvent *event) {
+	switch (event->kind) {
+	case SOAK_EVENT_MOVE:
+		oc_on_mouse_move(event->pos.x, event->pos.y, event->pos.x - soak->mouse.x, event->pos.y - soak->mouse.y);
+		soak->mouse = event->pos;
+		break;
+	case SOAK_EVENT_LEFT_DOWN:  oc_on_mouse_down(OC_MOUSE_LEFT); break;
+	case SOAK_EVENT_LEFT_UP:    oc_on_mouse_up(OC_MOUSE_LEFT); break;
+	case SOAK_EVENT_RIGHT_DOWN: oc_on_mouse_down(OC_MOUSE_RIGHT); break;
+	case SOAK_EVENT_RIGHT_UP:   oc_on_mouse_up(OC_MOUSE_RIGHT); break;
+	case SOAK_EVENT_KEY_DOWN:   oc_on_key_down(0, event->key); break;
+	case SOAK_EVENT_KEY_UP:     oc_on_key_up(0, event->key); break;
+	}
+}
+
+static u64 soak_live_bytes(GameState *game) {
+	u64 live = 0;
+	for (i32 i=0; i<MEM_SUBSYSTEM_COUNT; ++i) live += game->memory[i].live;
+	return live;
+}
+
+static void soak_frame(Soak *soak) {
+	GameState *game = soak->game;
+
+	if (soak->next_event < soak->event_count) {
+		soak_send(soak, &soak->events[soak->next_event++]);
+	} else {
+		if (soak->expect_move && game->state == STATE_PLAY && !game->card_dragging && game->move_count == soak->moves_before) {
+			soak_violation(soak, "move not taken", -1);
+			soak_key(soak, OC_KEY_R);
+		}
+		soak->expect_move = false;
+		soak->event_count = soak->next_event = 0;
+
+		if (game->state == STATE_WIN) {
+			soak->win_seconds += soak->frame_dt;
+			if (soak->win_seconds > SOAK_WIN_SECONDS) soak_key(soak, OC_KEY_R);
+		} else if (game->state == STATE_PLAY && soak_board_still(game)) {
+			soak_plan(soak);
+		}
+	}
+
+	headless.clock_time += soak->frame_dt;
+	f64 start = headless_wall_time();
+	oc_on_frame_refresh();
+	f64 us = (headless_wall_time() - start) * 1e6;
+
+	if (soak->frames == soak->frame_us_capacity) {
+		soak->frame_us_capacity = soak->frame_us_capacity ? 2 * soak->frame_us_capacity : 4096;
+		soak->frame_us = realloc(soak->frame_us, soak->frame_us_capacity * sizeof(f64));
+	}
+	soak->frame_us[soak->frames++] = us;
+
+	if (game->state != soak->last_state) {
+		if (game->state == STATE_DEALING) {
+			++soak->games;
+			soak->win_seconds = 0;
+			soak->stuck_recycles = 0;
+			u64 live = soak_live_bytes(game);
+			if (soak->games == 1) soak->deal_live_first = live;
+			if (live > soak->deal_live_max) soak->deal_live_max = live;
+		} else if (game->state == STATE_WIN) {
+			++soak->wins;
+			soak_check_record(soak);
+		}
+		soak->last_state = game->state;
+	}
+
+	soak_check(soak);
+}
+
+static int soak_compare_f64(const void *a, const void *b) {
+	f64 x = *(const f64*)a;
+	f64 y = *(const f64*)b;
+	return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+	f64 hours = argc > 1 ? atof(argv[1]) : 1.0;
+	f64 time_scale = argc > 2 ? atof(argv[2]) : SIM_MAX_STEPS_PER_FRAME;
+	u64 seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+	FILE *out = argc > 4 ? fopen(argv[4], "w") : stdout;
+	if (!out) {
+		fprintf(stderr, "could not open %s\n", argv[4]);
+		return 1;
+	}
+	if (time_scale <= 0) time_scale = 1;
+
+	headless.log_info = false;
+	headless.manual_clock = true;
+	oc_on_init();
+	GameState *game = &orca_game;
+	game->telemetry_enabled = false;
+	// no highscore file, and no par search eating wall time between steps
+	game->interactive = false;
+
+	static GameState replay;
+	game_init(&replay, seed);
+	replay.history.enabled = false;
+
+	static Soak soak;
+	soak.game = game;
+	soak.replay = &replay;
+	soak.out = out;
+	soak.frame_dt = time_scale / 60.0;
+	pcg32_seed(&soak.rng, seed);
+	soak.last_state = game->state;
+	soak.games = 1;
+	soak.deal_live_first = soak.deal_live_max = soak_live_bytes(game);
+
+	f64 wall_start = headless_wall_time();
+	f64 next_report = 3600;
+	while (headless.clock_time < hours * 3600) {
+		soak_frame(&soak);
+		if (headless.clock_time >= next_report) {
+			fprintf(out, "{\"hour\":%.0f,\"frames\":%llu,\"games\":%llu,\"wins\":%llu,\"violations\":%llu,\"wall_s\":%.1f}\n",
+				next_report / 3600, soak.frames, soak.games, soak.wins, soak.violations, headless_wall_time() - wall_start);
+			fflush(out);
+			next_report += 3600;
+		}
+	}
+	f64 wall_seconds = headless_wall_time() - wall_start;
+
+	f64 total_us = 0;
+	for (u64 i=0; i<soak.frames; ++i) total_us += soak.frame_us[i];
+	qsort(soak.frame_us, soak.frames, sizeof(f64), soak_compare_f64);
+	f64 *us = soak.frame_us;
+	u64 n = soak.frames;
+
+	fprintf(out, "{\"summary\":true,\"game_hours\":%.2f,\"wall_s\":%.1f,\"speedup\":%.0f,\"frames\":%llu,\"steps\":%llu,"
+		"\"games\":%llu,\"wins\":%llu,\"drags\":%llu,\"clicks\":%llu,\"right_clicks\":%llu,\"undos\":%llu,\"sloppy_drops\":%llu,"
+		"\"records\":%llu,\"violations\":%llu",
+		headless.clock_time / 3600, wall_seconds, wall_seconds > 0 ? headless.clock_time / wall_seconds : 0.0,
+		soak.frames, (u64)(headless.clock_time / SIM_STEP + 0.5),
+		soak.games, soak.wins, soak.drags, soak.clicks, soak.right_clicks, soak.undos, soak.sloppy_drops,
+		soak.records, soak.violations);
+	fprintf(out, ",\"frame_us\":{\"mean\":%.2f,\"p50\":%.2f,\"p99\":%.2f,\"p999\":%.2f,\"max\":%.2f}",
+		n ? total_us / n : 0.0, n ? us[n / 2] : 0.0, n ? us[(u64)(n * 0.99)] : 0.0, n ? us[(u64)(n * 0.999)] : 0.0, n ? us[n - 1] : 0.0);
+	fprintf(out, ",\"memory\":{\"state_bytes\":%llu,\"live_at_deal_first\":%llu,\"live_at_deal_max\":%llu",
+		(u64)sizeof(GameState), soak.deal_live_first, soak.deal_live_max);
+	for (i32 i=0; i<MEM_SUBSYSTEM_COUNT; ++i) {
+		fprintf(out, ",\"%s\":{\"live\":%llu,\"peak\":%llu}",
+			mem_subsystem_key(i), game->memory[i].live, game->memory[i].peak);
+	}
+	fprintf(out, "}}\n");
+	fprintf(stderr, "%.2f game hours in %.1fs, %llu games, %llu wins, %llu violations\n",
+		headless.clock_time / 3600, wall_seconds, soak.games, soak.wins, soak.violations);
+
+	if (out != stdout) fclose(out);
+	return soak.violations > 255 ? 255 : (int)soak.violations;
+}
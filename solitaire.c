@@ -4,7 +4,18 @@
 
 #include "random.c"
 #include "common.c"
+#include "memory.c"
+#include "solver.c"
+#include "par.c"
+#include "deal_table.c"
+#include "telemetry.c"
+#include "latency.c"
+#include "trace.c"
+#include "timeline.c"
+#include "history.c"
+#include "draw_record.c"
 #include "draw.c"
+#include "notation.c"
 
 static char *describe_suit(Suit suit) {
 	switch (suit) {
@@ -40,29 +51,46 @@ static char *pile_names[] = {
 	"foundations[0]", "foundations[1]", "foundations[2]", "foundations[3]", 
 	"tableau[0]", "tableau[1]", "tableau[2]", "tableau[3]", "tableau[4]", "tableau[5]", "tableau[6]"
 };
-static char *describe_pile(Pile *pile) {
-	if (pile == &game.stock) return pile_names[0];
-	if (pile == &game.waste) return pile_names[1];
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		if (pile == &game.foundations[i]) {
+static char *describe_pile(GameState *game, Pile *pile) {
+	if (pile == &game->stock) return pile_names[0];
+	if (pile == &game->waste) return pile_names[1];
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		if (pile == &game->foundations[i]) {
 			return pile_names[i + 2];
 		}
 	}
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		if (pile == &game.tableau[i]) {
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		if (pile == &game->tableau[i]) {
 			return pile_names[i + 6];
 		}
 	}
 	return "unknown";
 }
 
-static void print_card_info(Card *card) {
+// trace event names for state transitions
+static const char *state_trace_names[] = {
+	[STATE_NONE]             = "state none",
+	[STATE_DEALING]          = "state dealing",
+	[STATE_PLAY]             = "state play",
+	[STATE_SHOW_RULES]       = "state show rules",
+	[STATE_SELECT_CARD_BACK] = "state select card back",
+	[STATE_SHOW_STATISTICS]  = "state show statistics",
+	[STATE_AUTOCOMPLETE]     = "state autocomplete",
+	[STATE_WIN]              = "state win",
+};
+
+static void set_state(GameState *game, StateKind state) {
+	trace_instant(game, state_trace_names[state], game->state);
+	game->state = state;
+}
+
+static void print_card_info(GameState *game, Card *card) {
 	Card *prev = oc_list_prev_entry(card->pile->cards, card, Card, node);
 	Card *next = oc_list_next_entry(card->pile->cards, card, Card, node);
 	oc_log_info("\nCard: %s %s\n\tpile = %s\n\tpos = (%f, %f)\n\tface_up = %s\n\tprev = %s %s\n\tnext = %s %s",
 		describe_card_kind(card->kind),
 		describe_suit(card->suit),
-		describe_pile(card->pile),
+		describe_pile(game, card->pile),
 		card->pos.x, card->pos.y,
 		card->face_up ? "true" : "false",
 		prev ? describe_card_kind(prev->kind) : "none",
@@ -71,6 +99,10 @@ static void print_card_info(Card *card) {
 		next ? describe_suit(next->suit) : "none");
 }
 
+static inline CardDrag *card_drag(GameState *game, Card *card) {
+	return &game->card_drag[card - game->cards];
+}
+
 static f32 vec2_dist(oc_vec2 v1, oc_vec2 v2) {
 	f32 a = v2.x - v1.x;
 	f32 b = v2.y - v1.y;
@@ -97,69 +129,69 @@ static inline bool rect_in_rect(oc_rect a, oc_rect b) {
 	       point_in_rect(a.x + a.w, a.y + a.h, b);
 }
 
-static bool point_in_card_bounds(f32 x, f32 y, Card *card) {
+static bool point_in_card_bounds(GameState *game, f32 x, f32 y, Card *card) {
 	if (!card)
 		return false;
-	return x >= card->pos.x && x < card->pos.x + game.card_width &&
-		   y >= card->pos.y && y < card->pos.y + game.card_height;
+	return x >= card->pos.x && x < card->pos.x + game->card_width &&
+		   y >= card->pos.y && y < card->pos.y + game->card_height;
 }
 
-static void set_sizes_based_on_viewport(u32 width, u32 height) {
-    game.frame_size.x = width;
-    game.frame_size.y = height;
+static void set_sizes_based_on_viewport(GameState *game, u32 width, u32 height) {
+    game->frame_size.x = width;
+    game->frame_size.y = height;
 
-	game.board_margin.y = 50;
-	game.board_margin.x = 50;
+	game->board_margin.y = 50;
+	game->board_margin.x = 50;
 
-	if (game.frame_size.x > 2400) {
-		game.board_margin.x = (u32)(0.25f * width);
-	} else if (game.frame_size.x > 1900) {
-		game.board_margin.x = (u32)(0.21f * width);
-	} else if (game.frame_size.x > 1600) {
-		game.board_margin.x = (u32)(0.17f * width);
-	} else if (game.frame_size.x > 1200) {
-		game.board_margin.x = (u32)(0.10f * width);
+	if (game->frame_size.x > 2400) {
+		game->board_margin.x = (u32)(0.25f * width);
+	} else if (game->frame_size.x > 1900) {
+		game->board_margin.x = (u32)(0.21f * width);
+	} else if (game->frame_size.x > 1600) {
+		game->board_margin.x = (u32)(0.17f * width);
+	} else if (game->frame_size.x > 1200) {
+		game->board_margin.x = (u32)(0.10f * width);
 	}
 
-	f32 usable_width = width - (2.0f * game.board_margin.x);
+	f32 usable_width = width - (2.0f * game->board_margin.x);
 	f32 pct_card_margin = 0.18;
 
-	game.card_width = ((f32)usable_width * (1.0f - pct_card_margin)) / 7.0f;
-	game.card_height = (f32)game.card_width / CARD_ASPECT;
-	game.card_margin_x = ((f32)usable_width * pct_card_margin) / (ARRAY_COUNT(game.tableau) - 1);
-	game.tableau_margin_top = 25;
+	game->card_width = ((f32)usable_width * (1.0f - pct_card_margin)) / 7.0f;
+	game->card_height = (f32)game->card_width / CARD_ASPECT;
+	game->card_margin_x = ((f32)usable_width * pct_card_margin) / (ARRAY_COUNT(game->tableau) - 1);
+	game->tableau_margin_top = 25;
 
-	game.stock.pos.x = game.board_margin.x;
-	game.stock.pos.y = game.board_margin.y;
+	game->stock.pos.x = game->board_margin.x;
+	game->stock.pos.y = game->board_margin.y;
 
-	game.waste.pos.x = game.stock.pos.x + game.card_width + game.card_margin_x;
-	game.waste.pos.y = game.board_margin.y;
+	game->waste.pos.x = game->stock.pos.x + game->card_width + game->card_margin_x;
+	game->waste.pos.y = game->board_margin.y;
 
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		game.foundations[i].pos.x = game.board_margin.x + ((i + 3) * (game.card_width + game.card_margin_x));
-		game.foundations[i].pos.y = game.board_margin.y;
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		game->foundations[i].pos.x = game->board_margin.x + ((i + 3) * (game->card_width + game->card_margin_x));
+		game->foundations[i].pos.y = game->board_margin.y;
 	}
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		game.tableau[i].pos.x = game.board_margin.x + i*(game.card_width + game.card_margin_x);
-		game.tableau[i].pos.y = game.board_margin.y + game.card_height + game.tableau_margin_top;
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		game->tableau[i].pos.x = game->board_margin.x + i*(game->card_width + game->card_margin_x);
+		game->tableau[i].pos.y = game->board_margin.y + game->card_height + game->tableau_margin_top;
 	}
 }
 
-static void load_images(void) {
-	game.card_backs[0] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-00.png"), false);
-	game.card_backs[1] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-01.png"), false);
-	game.card_backs[2] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-02.png"), false);
-	game.card_backs[3] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-03.png"), false);
-	game.card_backs[4] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-04.png"), false);
-	game.card_backs[5] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-05.png"), false);
-	game.card_backs[6] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-06.png"), false);
-	game.card_backs[7] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-07.png"), false);
-	game.card_backs[8] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-08.png"), false);
-	game.card_backs[9] = oc_image_create_from_path(game.surface, OC_STR8("Card-Back-09.png"), false);
-	game.spritesheet = oc_image_create_from_path(game.surface, OC_STR8("classic_13x4x280x390.png"), false);
-	game.reload_icon = oc_image_create_from_path(game.surface, OC_STR8("reload.png"), false);
-	game.rules_images[0] = oc_image_create_from_path(game.surface, OC_STR8("klondike_rules_draw_1.png"), false);
-	game.rules_images[1] = oc_image_create_from_path(game.surface, OC_STR8("klondike_rules_draw_3.png"), false);
+static void load_images(GameState *game) {
+	game->card_backs[0] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-00.png"), false);
+	game->card_backs[1] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-01.png"), false);
+	game->card_backs[2] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-02.png"), false);
+	game->card_backs[3] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-03.png"), false);
+	game->card_backs[4] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-04.png"), false);
+	game->card_backs[5] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-05.png"), false);
+	game->card_backs[6] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-06.png"), false);
+	game->card_backs[7] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-07.png"), false);
+	game->card_backs[8] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-08.png"), false);
+	game->card_backs[9] = oc_image_create_from_path(game->surface, OC_STR8("Card-Back-09.png"), false);
+	game->spritesheet = oc_image_create_from_path(game->surface, OC_STR8("classic_13x4x280x390.png"), false);
+	game->reload_icon = oc_image_create_from_path(game->surface, OC_STR8("reload.png"), false);
+	game->rules_images[0] = oc_image_create_from_path(game->surface, OC_STR8("klondike_rules_draw_1.png"), false);
+	game->rules_images[1] = oc_image_create_from_path(game->surface, OC_STR8("klondike_rules_draw_3.png"), false);
 
 	u32 card_width = 280; 
 	u32 card_height = 390;
@@ -167,7 +199,7 @@ static void load_images(void) {
 	u32 cols = 13;
 	for (i32 j=0; j<rows; ++j)
 	for (i32 i=0; i<cols; ++i) {
-		game.card_sprite_rects[j][i] = (oc_rect){
+		game->card_sprite_rects[j][i] = (oc_rect){
 			.x = i * card_width,
 			.y = j * card_height,
 			.w = card_width,
@@ -180,25 +212,25 @@ static Card *pile_peek_top(Pile *pile);
 
 // positions the second and third cards from the top of the waste pile, and
 // returns the new position for the top card
-static oc_vec2 position_second_and_third_cards_on_waste(Card *second, Card *third, bool instant) {
-	Pile *pile = &game.waste;
+static oc_vec2 position_second_and_third_cards_on_waste(GameState *game, Card *second, Card *third, bool instant) {
+	Pile *pile = &game->waste;
 	oc_vec2 new_pos = pile->pos;
-	if (game.draw_three_mode) {
-		i32 x_offset = 0.22f * game.card_width;
+	if (game->draw_three_mode) {
+		i32 x_offset = 0.22f * game->card_width;
 		if (second) {
-			Card *third = oc_list_next_entry(game.waste.cards, second, Card, node);
+			Card *third = oc_list_next_entry(game->waste.cards, second, Card, node);
 			if (third) {
 				third->target_pos = pile->pos;
 				i32 new_x = third->target_pos.x + x_offset;
 				second->target_pos.x = new_x;
 				if (instant) {
-					third->pos = pile->pos;
-					second->pos.x = new_x;
+					third->pos = third->prev_pos = pile->pos;
+					second->pos.x = second->prev_pos.x = new_x;
 				}
 			} else {
 				second->target_pos = pile->pos;
 				if (instant) {
-					second->pos = pile->pos;
+					second->pos = second->prev_pos = pile->pos;
 				}
 			}
 			new_pos.x = second->target_pos.x + x_offset;
@@ -208,7 +240,7 @@ static oc_vec2 position_second_and_third_cards_on_waste(Card *second, Card *thir
 	return new_pos;
 }
 
-static void position_card_on_top_of_pile(Card *card, Pile *pile, bool instant) {
+static void position_card_on_top_of_pile(GameState *game, Card *card, Pile *pile, bool instant) {
 	assert(card);
 	assert(pile);
 	oc_vec2 new_pos = {0};
@@ -226,9 +258,9 @@ static void position_card_on_top_of_pile(Card *card, Pile *pile, bool instant) {
 	}
 
 	case PILE_WASTE: {
-		Card *second = pile_peek_top(&game.waste);
-		Card *third = second ? oc_list_next_entry(game.waste.cards, second, Card, node) : NULL;
-		new_pos = position_second_and_third_cards_on_waste(second, third, instant);
+		Card *second = pile_peek_top(&game->waste);
+		Card *third = second ? oc_list_next_entry(game->waste.cards, second, Card, node) : NULL;
+		new_pos = position_second_and_third_cards_on_waste(game, second, third, instant);
 		break;
 	}
 
@@ -240,7 +272,7 @@ static void position_card_on_top_of_pile(Card *card, Pile *pile, bool instant) {
 	case PILE_TABLEAU: {
 		Card *top = oc_list_first_entry(pile->cards, Card, node);
 		if (top) {
-			i32 y_offset = top->face_up ? (0.25f * game.card_height) : (0.125f * game.card_height);
+			i32 y_offset = top->face_up ? (0.25f * game->card_height) : (0.125f * game->card_height);
 			new_pos.x = top->target_pos.x;
 			new_pos.y = top->target_pos.y + y_offset;
 		} else {
@@ -256,17 +288,23 @@ static void position_card_on_top_of_pile(Card *card, Pile *pile, bool instant) {
 
 	card->target_pos = new_pos;
 	if (instant) {
-		card->pos = new_pos;
+		card->pos = card->prev_pos = new_pos;
 	} 
 }
 
-static void position_all_cards_on_pile(Pile *pile, bool instant) {
+static inline void pile_bump_version(GameState *game, Pile *pile) {
+	++pile->version;
+	++game->board_version;
+}
+
+static void position_all_cards_on_pile(GameState *game, Pile *pile, bool instant) {
+	pile_bump_version(game, pile);
 	switch (pile->kind) {
 	case PILE_FOUNDATION: {
 		oc_list_for_reverse(pile->cards, card, Card, node) {
 			card->target_pos = pile->pos;
 			if (instant) {
-				card->pos = card->target_pos;
+				card->pos = card->prev_pos = card->target_pos;
 			}
 		}
 		break;
@@ -274,18 +312,18 @@ static void position_all_cards_on_pile(Pile *pile, bool instant) {
 
 	case PILE_WASTE: {
 		oc_list_for_reverse(pile->cards, card, Card, node) {
-			if (game.draw_three_mode && card == oc_list_first_entry(pile->cards, Card, node)) {
+			if (game->draw_three_mode && card == oc_list_first_entry(pile->cards, Card, node)) {
 				Card *second = oc_list_next_entry(pile->cards, card, Card, node);
 				Card *third = second ? oc_list_next_entry(pile->cards, second, Card, node) : NULL;
-				oc_vec2 new_pos = position_second_and_third_cards_on_waste(second, third, instant);
+				oc_vec2 new_pos = position_second_and_third_cards_on_waste(game, second, third, instant);
 				card->target_pos = new_pos;
 				if (instant) {
-					card->pos = new_pos;
+					card->pos = card->prev_pos = new_pos;
 				}
 			} else {
 				card->target_pos = pile->pos;
 				if (instant) {
-					card->pos = card->target_pos;
+					card->pos = card->prev_pos = card->target_pos;
 				}
 			}
 		}
@@ -298,21 +336,21 @@ static void position_all_cards_on_pile(Pile *pile, bool instant) {
 			card->target_pos.x = pile->pos.x - offset;
 			card->target_pos.y = pile->pos.y - offset;
 			if (instant) {
-				card->pos = card->target_pos;
+				card->pos = card->prev_pos = card->target_pos;
 			}
 			offset += STOCK_OFFSET_BETWEEN_CARDS;
 		}
 		break;
 	}
 	case PILE_TABLEAU: {
-		i32 y_offset_face_up = 0.25f * game.card_height;
-		i32 y_offset_face_down = 0.125f * game.card_height;
+		i32 y_offset_face_up = 0.25f * game->card_height;
+		i32 y_offset_face_down = 0.125f * game->card_height;
 		i32 y_offset = 0;
 		oc_list_for_reverse(pile->cards, card, Card, node) {
 			card->target_pos.x = pile->pos.x;
 			card->target_pos.y = pile->pos.y + y_offset;
 			if (instant) {
-				card->pos = card->target_pos;
+				card->pos = card->prev_pos = card->target_pos;
 			}
 			y_offset += card->face_up ? y_offset_face_up : y_offset_face_down;
 		}
@@ -325,34 +363,37 @@ static void position_all_cards_on_pile(Pile *pile, bool instant) {
 }
 
 
-static void pile_transfer(Pile *target_pile, Card *card, bool instant);
+static void pile_transfer(GameState *game, Pile *target_pile, Card *card, bool instant);
 
-static void undo_push_pile_transfer(Card *card) {
-	assert(game.temp_undo_stack_index < ARRAY_COUNT(game.temp_undo_stack));
+static void undo_push_pile_transfer(GameState *game, Card *card, Pile *target_pile) {
+	assert(game->temp_undo_stack_index < ARRAY_COUNT(game->temp_undo_stack));
 	Card *parent = oc_list_next_entry(card->pile->cards, card, Card, node);
+	u8 flags = 0;
+	if (card->face_up) flags |= UNDO_WAS_FACE_UP;
+	if (parent && parent->face_up) flags |= UNDO_WAS_PARENT_FACE_UP;
 	UndoInfo move = {
 		.kind = UNDO_PILE_TRANSFER,
-		.prev_pile = card->pile,
-		.card = card, 
-		.was_face_up = card->face_up,
-		.parent = parent,
-		.was_parent_face_up = parent && parent->face_up,
+		.flags = flags,
+		.prev_pile = (u8)board_pile_index(game, card->pile),
+		.pile = (u8)board_pile_index(game, target_pile),
+		.card = (u8)(card - game->cards),
+		.parent = parent ? (u8)(parent - game->cards) : UNDO_NO_CARD,
 	};
-	game.temp_undo_stack[game.temp_undo_stack_index++] = move;
+	game->temp_undo_stack[game->temp_undo_stack_index++] = move;
 }
 
-static void undo_push_score_change(i32 score_change) {
-	assert(game.temp_undo_stack_index < ARRAY_COUNT(game.temp_undo_stack));
+static void undo_push_score_change(GameState *game, i32 score_change) {
+	assert(game->temp_undo_stack_index < ARRAY_COUNT(game->temp_undo_stack));
 	UndoInfo move = {
 		.kind = UNDO_SCORE_CHANGE,
 		.score_change = score_change,
 	};
-	game.temp_undo_stack[game.temp_undo_stack_index++] = move;
+	game->temp_undo_stack[game->temp_undo_stack_index++] = move;
 }
 
-void update_highscore(i32 score) {
-	game.highscore = score;
-	snprintf(game.highscore_string, sizeof(game.highscore_string), "High Score: %d", game.highscore);
+void update_highscore(GameState *game, i32 score) {
+	game->highscore = score;
+	snprintf(game->highscore_string, sizeof(game->highscore_string), "High Score: %d", game->highscore);
 }
 
 void log_file_status(oc_file file) {
@@ -363,15 +404,16 @@ void log_file_status(oc_file file) {
 			status.accessDate.seconds, status.modificationDate.seconds);
 }
 
-void load_highscore(void) {
+void load_highscore(GameState *game) {
 	oc_str8 path = OC_STR8("highscore.dat");
 	oc_file file = oc_file_open(path, OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+	trace_instant(game, "load_highscore open", oc_file_last_error(file));
 
 	oc_file_last_error(file);
 
     if(oc_file_last_error(file) != OC_IO_OK) {
         oc_log_info("No high score data found");
-		update_highscore(0);
+		update_highscore(game, 0);
 		return;
     }
 
@@ -380,35 +422,46 @@ void load_highscore(void) {
 	i32 score = 0;
 	u64 size = sizeof(i32);
 	u64 bytes_read = oc_file_read(file, size, (char*)&score);
+	trace_instant(game, "load_highscore read", (i32)bytes_read);
 	if (bytes_read != size) {
 		oc_log_error("Couldn't read highscore data\n");
 		score = 0;
 	} 
 	oc_file_close(file);
-	update_highscore(score);
+	trace_instant(game, "load_highscore close", 0);
+	update_highscore(game, score);
 }
 
-void save_highscore(void) {
+void save_highscore(GameState *game) {
+	if (!game->interactive) return;
 	oc_str8 path = OC_STR8("highscore.dat");
 	oc_file file = oc_file_open(path, OC_FILE_ACCESS_WRITE, OC_FILE_OPEN_CREATE);
+	trace_instant(game, "save_highscore open", oc_file_last_error(file));
 	if(oc_file_last_error(file) != OC_IO_OK) {
 		oc_log_error("Could not open file %*.s\n", oc_str8_ip(path));
 		return;
 	}
  
 	u64 size = sizeof(i32);
-	u64 bytes_written = oc_file_write(file, size, (char*)&game.highscore);
+	u64 bytes_written = oc_file_write(file, size, (char*)&game->highscore);
+	trace_instant(game, "save_highscore write", (i32)bytes_written);
 	if (bytes_written != size) {
 		oc_log_error("Failed to save highscore to disk");
 	}
 
 	oc_file_close(file);
+	trace_instant(game, "save_highscore close", 0);
+}
+
+// added to the score when the game is won, from the seconds it took
+static i32 time_bonus(f64 timer) {
+	return timer > 0 ? (i32)(700000 / timer) : 0;
 }
 
-static void update_score(UpdateScoreParams params) {
+static void update_score(GameState *game, UpdateScoreParams params) {
 	switch (params.kind) {
 	case SCORE_RESET:
-		game.score = 0;
+		game->score = 0;
 		break;
 	case SCORE_PILE_TRANSFER: {
 		assert(params.from_pile);
@@ -425,54 +478,51 @@ static void update_score(UpdateScoreParams params) {
 		} else if (from_kind == PILE_FOUNDATION && to_kind == PILE_TABLEAU) {
 			score_change = -15;
 		}
-		undo_push_score_change(score_change);
-		game.score += score_change;
+		undo_push_score_change(game, score_change);
+		game->score += score_change;
 		break;
 	}
 	case SCORE_REVEAL_TABLEAU:
-		undo_push_score_change(5);
-		game.score += 5;
+		undo_push_score_change(game, 5);
+		game->score += 5;
 		break;
 	case SCORE_RECYCLE_WASTE:
-		if (!game.draw_three_mode) {
-			undo_push_score_change(-100);
-			game.score -= 100;
+		if (!game->draw_three_mode) {
+			undo_push_score_change(game, -100);
+			game->score -= 100;
 		}
 		break;
 	case SCORE_UNDO:
-		game.score -= params.score_change;
+		game->score -= params.score_change;
 		break;
-	case SCORE_TIME_BONUS: {
-		if (game.timer > 0) {
-			i32 bonus = (i32)(700000 / game.timer);
-			game.score += bonus;
-		}
+	case SCORE_TIME_BONUS:
+		game->score += time_bonus(game->timer);
 		break;
-	}
 	default: 
 		assert(0);
 		break;
 	}
-	if (game.score < 0) game.score = 0;
-	snprintf(game.score_string, sizeof(game.score_string), "Score: %d", game.score);
+	if (game->score < 0) game->score = 0;
+	snprintf(game->score_string, sizeof(game->score_string), "Score: %d", game->score);
 
-	if (game.score > game.highscore) {
-		update_highscore(game.score);
-		save_highscore();
+	if (game->score > game->highscore && !game->replaying) {
+		update_highscore(game, game->score);
+		save_highscore(game);
 	}
 }
 
-static void update_score_pile_transfer(Pile *from_pile, Pile *to_pile) {
+static void update_score_pile_transfer(GameState *game, Pile *from_pile, Pile *to_pile) {
 	UpdateScoreParams params = { 
 		.kind = SCORE_PILE_TRANSFER, 
 		.from_pile = from_pile,
 		.to_pile = to_pile};
-	update_score(params);
+	update_score(game, params);
 }
 
-static Card *pile_pop(Pile *pile) {
+static Card *pile_pop(GameState *game, Pile *pile) {
 	Card *card = oc_list_pop_entry(&pile->cards, Card, node);
 	if (card) card->pile = NULL;
+	pile_bump_version(game, pile);
 	return card;
 }
 
@@ -480,18 +530,21 @@ static Card *pile_peek_top(Pile *pile) {
 	return oc_list_first_entry(pile->cards, Card, node);
 }
 
-static void pile_push(Pile *pile, Card *card, bool instant) {
-	position_card_on_top_of_pile(card, pile, instant);
+static void pile_push(GameState *game, Pile *pile, Card *card, bool instant) {
+	position_card_on_top_of_pile(game, card, pile, instant);
 	card->pile = pile;
 	oc_list_push(&pile->cards, &card->node);
+	pile_bump_version(game, pile);
 }
 
 // this is basically moving a sublist from one list to another
 // rather than a single element 
-static void pile_transfer(Pile *target_pile, Card *card, bool instant) {
+static void pile_transfer(GameState *game, Pile *target_pile, Card *card, bool instant) {
 	assert(card->pile);
 	Pile *old_pile = card->pile;
 	oc_list_elt *node = &card->node;
+	pile_bump_version(game, old_pile);
+	pile_bump_version(game, target_pile);
 
 	oc_list *old_list = &old_pile->cards;
 	if (node->next) {
@@ -511,104 +564,123 @@ static void pile_transfer(Pile *target_pile, Card *card, bool instant) {
 		target_pile->cards.last = node;
 	}
 
-	position_card_on_top_of_pile(card, target_pile, instant);
+	position_card_on_top_of_pile(game, card, target_pile, instant);
 	card->pile = target_pile;
 	target_pile->cards.first = node;
 
 	while (node->prev) {
 		node = node->prev;
 		Card *current = oc_list_entry(node, Card, node);
-		position_card_on_top_of_pile(current, target_pile, instant);
+		position_card_on_top_of_pile(game, current, target_pile, instant);
 		current->pile = target_pile;
 		target_pile->cards.first = node;
 	}
 
 	if (old_pile->kind == PILE_WASTE) {
-		position_all_cards_on_pile(&game.waste, instant);
+		position_all_cards_on_pile(game, &game->waste, instant);
 	}
 }
 
-static void update_moves_string(void) {
-	i32 total_moves = game.move_count + game.undo_count;
+static void update_moves_string(GameState *game) {
+	i32 total_moves = game->move_count + game->undo_count;
 	assert(total_moves <= 9999);
-	snprintf(game.moves_string, sizeof(game.moves_string), "Moves: %d", total_moves);
+	if (game->par.status == PAR_DONE && game->par.par > 0) {
+		const char *label = game->par.proven ? "par" : "best";
+		snprintf(game->moves_string, sizeof(game->moves_string), "Moves: %d (%s %u)", total_moves, label, game->par.par);
+	} else {
+		snprintf(game->moves_string, sizeof(game->moves_string), "Moves: %d", total_moves);
+	}
 }
 
 
 
-static void undo_commit(void) {
-	if (game.temp_undo_stack_index > 0) {
-		assert(game.undo_stack_index + game.temp_undo_stack_index + 1 < ARRAY_COUNT(game.undo_stack));
-		game.undo_stack[game.undo_stack_index++] = (UndoInfo){.kind = UNDO_COMMIT_MARKER};
-		for (i32 i=0; i<game.temp_undo_stack_index; ++i) {
-			UndoInfo move = game.temp_undo_stack[i];
-			game.undo_stack[game.undo_stack_index++] = move;
+static void undo_commit(GameState *game) {
+	if (game->temp_undo_stack_index > 0) {
+		assert(game->undo_stack.count + game->temp_undo_stack_index + 1 < UNDO_STACK_MAX);
+		UndoInfo *marker = block_array_push(&game->undo_stack);
+		*marker = (UndoInfo){.kind = UNDO_COMMIT_MARKER};
+		for (i32 i=0; i<game->temp_undo_stack_index; ++i) {
+			UndoInfo *move = block_array_push(&game->undo_stack);
+			*move = game->temp_undo_stack[i];
 		}
-		game.temp_undo_stack_index = 0;
+		game->temp_undo_stack_index = 0;
 	}
 }
 
-static void commit_move(void) {
-	if (game.temp_undo_stack_index > 0) {
-		++game.move_count;
-		update_moves_string();
+static void commit_move(GameState *game) {
+	bool moved = game->temp_undo_stack_index > 0;
+	if (moved) {
+		++game->move_count;
+		trace_instant(game, "commit_move", game->move_count);
+		update_moves_string(game);
+		notation_record_commit(game);
+		if (!game->replaying) {
+			telemetry_note_move(game);
+		}
+	}
+	undo_commit(game);
+	if (moved) {
+		history_record(game);
 	}
-	undo_commit();
 }
 
-static void undo_move(void) {
-	if (game.undo_stack_index > 0) {
+static void undo_move(GameState *game) {
+	if (game->undo_stack.count > 0) {
+		trace_instant(game, "undo_move", game->move_count);
 		bool cleanup_waste = false;
-		UndoInfo undo = game.undo_stack[--game.undo_stack_index];
+		UndoInfo undo = *(UndoInfo*)block_array_get(&game->undo_stack, --game->undo_stack.count);
 		while (undo.kind != UNDO_COMMIT_MARKER) {
-			assert(game.undo_stack_index > 0);
+			assert(game->undo_stack.count > 0);
 			switch (undo.kind) {
 			case UNDO_PILE_TRANSFER: {
-				if (undo.card->pile->kind == PILE_WASTE) {
+				Card *card = &game->cards[undo.card];
+				if (card->pile->kind == PILE_WASTE) {
 				 cleanup_waste = true;
 				}
-				if (undo.parent) {
-				 undo.parent->face_up = undo.was_parent_face_up;
+				if (undo.parent != UNDO_NO_CARD) {
+				 game->cards[undo.parent].face_up = (undo.flags & UNDO_WAS_PARENT_FACE_UP) != 0;
 				}
-				pile_transfer(undo.prev_pile, undo.card, true);
-				undo.card->face_up = undo.was_face_up;
+				pile_transfer(game, board_pile(game, undo.prev_pile), card, true);
+				card->face_up = (undo.flags & UNDO_WAS_FACE_UP) != 0;
 				break;
 			}
 			case UNDO_SCORE_CHANGE: {
 				UpdateScoreParams params = { .kind = SCORE_UNDO, .score_change = undo.score_change };
-				update_score(params);
+				update_score(game, params);
 				break;
 			}
 			default:
 				assert(0);
 				break;
 			}
-			undo = game.undo_stack[--game.undo_stack_index];
+			undo = *(UndoInfo*)block_array_get(&game->undo_stack, --game->undo_stack.count);
 		}
 		
 		if (cleanup_waste) {
-			position_all_cards_on_pile(&game.waste, false);
+			position_all_cards_on_pile(game, &game->waste, false);
 		}
 
 		// score penalty for undo
 		UpdateScoreParams params = { .kind = SCORE_UNDO, .score_change = 15 };
-		update_score(params);
+		update_score(game, params);
 
-		++game.undo_count;
-		update_moves_string();
+		++game->undo_count;
+		update_moves_string(game);
+		notation_record_undo(game);
+		history_pop(game);
 	}
 }
 
-static void shuffle_deck(Card *cards, i32 num_cards) {
+static void shuffle_deck(Card *cards, i32 num_cards, Pcg32 *rng) {
 	for (i32 i=num_cards-1; i > 0; --i) {
-		i32 j = (i32)rand_range_u32(0, i);
+		i32 j = (i32)(pcg32_next(rng) % (u32)(i + 1));
 		Card tmp = cards[i];
 		cards[i] = cards[j];
 		cards[j] = tmp;
 	}
 }
 
-static void test_deal_for_autocomplete(Card *cards, i32 num_cards) {
+static void test_deal_for_autocomplete(GameState *game, Card *cards, i32 num_cards) {
 	assert(SUIT_COUNT * CARD_KIND_COUNT == num_cards);
 	i32 index = 0;
 	
@@ -620,7 +692,7 @@ static void test_deal_for_autocomplete(Card *cards, i32 num_cards) {
 		card->face_up = true;
 		card->suit = (kind % 2) == 0 ? suit_even : suit_odd;
 		card->kind = kind;
-		pile_push(&game.tableau[0], card, true);
+		pile_push(game, &game->tableau[0], card, true);
 	}
 
 	suit_even = SUIT_CLUB;
@@ -631,7 +703,7 @@ static void test_deal_for_autocomplete(Card *cards, i32 num_cards) {
 		card->face_up = true;
 		card->suit = (kind % 2) == 0 ? suit_even : suit_odd;
 		card->kind = kind;
-		pile_push(&game.tableau[1], card, true);
+		pile_push(game, &game->tableau[1], card, true);
 	}
 
 	suit_even = SUIT_HEART;
@@ -642,7 +714,7 @@ static void test_deal_for_autocomplete(Card *cards, i32 num_cards) {
 		card->face_up = true;
 		card->suit = (kind % 2) == 0 ? suit_even : suit_odd;
 		card->kind = kind;
-		pile_push(&game.tableau[2], card, true);
+		pile_push(game, &game->tableau[2], card, true);
 	}
 
 	suit_even = SUIT_SPADE;
@@ -653,11 +725,31 @@ static void test_deal_for_autocomplete(Card *cards, i32 num_cards) {
 		card->face_up = true;
 		card->suit = (kind % 2) == 0 ? suit_even : suit_odd;
 		card->kind = kind;
-		pile_push(&game.tableau[3], card, true);
+		pile_push(game, &game->tableau[3], card, true);
 	}
 }
 
-static void deal_klondike(Card *cards, i32 num_cards) {
+// deals the tableau off the stock, one card every deal_delay
+static void start_deal_sequence(GameState *game) {
+	timeline_clear(game, SEQUENCE_DEAL);
+	TimelinePlan plan;
+	timeline_plan_begin(game, &plan);
+	f32 time = 0;
+	i32 count = ARRAY_COUNT(game->tableau);
+	for (i32 row=0; row<count; ++row)
+	for (i32 i=row; i<count; ++i) {
+		Card *card = pile_pop(game, &game->stock);
+		pile_push(game, &game->tableau[i], card, false);
+		card->face_up = i == row;
+		timeline_plan_step(game, &plan, time, game->deal_duration, EASE_OUT_CUBIC);
+		time += game->deal_delay;
+	}
+	history_begin(game);
+	timeline_plan_end(game, &plan);
+	set_state(game, STATE_DEALING);
+}
+
+static void deal_klondike(GameState *game, Card *cards, i32 num_cards, u32 deal_number) {
 	assert(SUIT_COUNT * CARD_KIND_COUNT == num_cards);
 
 	for (i32 suit=0; suit < SUIT_COUNT; ++suit)
@@ -668,90 +760,102 @@ static void deal_klondike(Card *cards, i32 num_cards) {
 		card->kind = kind;
 	}
 
-	shuffle_deck(cards, num_cards);
+	// the deal number alone decides the shuffle, see solver_deal
+	game->deal_number = deal_number;
+	Pcg32 rng;
+	pcg32_seed(&rng, deal_number);
+	shuffle_deck(cards, num_cards, &rng);
 
 	// put all cards in stock
 	for (i32 i=0; i<num_cards; ++i) {
-		pile_push(&game.stock, &cards[i], true);
+		pile_push(game, &game->stock, &cards[i], true);
 	}
 
-	game.state = STATE_DEALING;
+	start_deal_sequence(game);
 }
 
-static void update_timer_string(f64 seconds_elapsed_f64) {
+static void update_timer_string(GameState *game, f64 seconds_elapsed_f64) {
 	u64 seconds_elapsed = (u64)seconds_elapsed_f64;
 	u64 seconds = seconds_elapsed % 60;
 	u64 minutes_elapsed = seconds_elapsed / 60;
 	u64 minutes = minutes_elapsed % 60;
 	u64 hours = minutes_elapsed / 60;
-	snprintf(game.timer_string, sizeof(game.timer_string), "%02llu:%02llu:%02llu", hours, minutes, seconds);
+	snprintf(game->timer_string, sizeof(game->timer_string), "%02llu:%02llu:%02llu", hours, minutes, seconds);
 }
 
-static void game_reset(void) {
-	game.card_dragging = false;
-	memset(&game.mouse_input, 0, sizeof(game.mouse_input));
-	memset(&game.input, 0, sizeof(game.input));
-	oc_list_init(&game.stock.cards);
-	oc_list_init(&game.waste.cards);
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		oc_list_init(&game.foundations[i].cards);
+static void game_reset_with_deal(GameState *game, u32 deal_number) {
+	telemetry_finish_game(game, TELEMETRY_ABANDONED);
+	game->telemetry_last_move_time = 0;
+
+	game->card_dragging = false;
+	memset(&game->mouse_input, 0, sizeof(game->mouse_input));
+	memset(&game->input, 0, sizeof(game->input));
+	oc_list_init(&game->stock.cards);
+	oc_list_init(&game->waste.cards);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		oc_list_init(&game->foundations[i].cards);
 	}
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		oc_list_init(&game.tableau[i].cards);
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		oc_list_init(&game->tableau[i].cards);
 	}
 
-	game.timer = 0;
-	update_timer_string(game.timer);
+	game->timer = 0;
+	update_timer_string(game, game->timer);
 
-	game.win_foundation_index = 0;
-	game.win_moving_card = NULL;
-	game.win_card_path_index = 0;
+	block_array_release(&game->win_card_path);
+	game->win_flying_count = 0;
 
-	game.undo_stack_index = 0;
-	game.move_count = 0;
-	game.undo_count = 0;
-	update_moves_string();
+	game->temp_undo_stack_index = 0;
+	block_array_release(&game->undo_stack);
+	game->move_count = 0;
+	game->undo_count = 0;
+	game->par.status = PAR_IDLE;
+	update_moves_string(game);
 
 	UpdateScoreParams params = { .kind = SCORE_RESET };
-	update_score(params);
+	update_score(game, params);
 
-	game.deal_countdown = 0;
-	game.deal_tableau_index = 0;
-	game.deal_tableau_remaining = ARRAY_COUNT(game.tableau);
-	game.deal_cards_remaining = 28; // 7+6+5+4+3+2+1
+	block_array_release(&game->notation);
+	deal_klondike(game, game->cards, ARRAY_COUNT(game->cards), deal_number);
+}
 
-	deal_klondike(game.cards, ARRAY_COUNT(game.cards));
+static void game_reset(GameState *game) {
+	u32 deal_number;
+	if (!deal_table_pick(game, game->deal_filter, game->draw_three_mode, &deal_number)) {
+		deal_number = pcg32_next(&game->rng);
+	}
+	game_reset_with_deal(game, deal_number);
 }
 
-static Pile *get_hovered_pile(void) {
-	f32 mx = game.mouse_input.x;
-	f32 my = game.mouse_input.y;
+static Pile *get_hovered_pile(GameState *game) {
+	f32 mx = game->mouse_input.x;
+	f32 my = game->mouse_input.y;
 
-	oc_vec2 pos = game.stock.pos;
-	oc_rect rect = { pos.x, pos.y, game.card_width, game.card_height };
+	oc_vec2 pos = game->stock.pos;
+	oc_rect rect = { pos.x, pos.y, game->card_width, game->card_height };
 	if (point_in_rect(mx, my, rect)) {
-		return &game.stock;
+		return &game->stock;
 	} 
 
-	pos = game.waste.pos;
-	rect = (oc_rect){ pos.x, pos.y, game.card_width, game.card_height };
+	pos = game->waste.pos;
+	rect = (oc_rect){ pos.x, pos.y, game->card_width, game->card_height };
 	if (point_in_rect(mx, my, rect)) {
-		return &game.waste;
+		return &game->waste;
 	} 
 
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		oc_vec2 pos = game.foundations[i].pos;
-		rect = (oc_rect){ pos.x, pos.y, game.card_width, game.card_height };
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		oc_vec2 pos = game->foundations[i].pos;
+		rect = (oc_rect){ pos.x, pos.y, game->card_width, game->card_height };
 		if (point_in_rect(mx, my, rect)) {
-			return &game.foundations[i];
+			return &game->foundations[i];
 		} 
 	}
 
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		pos = game.tableau[i].pos;
-		rect = (oc_rect){ pos.x, pos.y, game.card_width, game.card_height };
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		pos = game->tableau[i].pos;
+		rect = (oc_rect){ pos.x, pos.y, game->card_width, game->card_height };
 		if (point_in_rect(mx, my, rect)) {
-			return &game.tableau[i];
+			return &game->tableau[i];
 		}
 	}
 
@@ -761,43 +865,43 @@ static Pile *get_hovered_pile(void) {
 // returns the card the mouse is currently over
 // if a card is currently being dragged, this card is ignored and the card
 // behind is returned instead
-static Card *get_hovered_card(void) {
-	f32 mx = game.mouse_input.x;
-	f32 my = game.mouse_input.y;
-	f32 y_top_row = game.stock.pos.y;
-	Card *drag_card = game.card_dragging;
+static Card *get_hovered_card(GameState *game) {
+	f32 mx = game->mouse_input.x;
+	f32 my = game->mouse_input.y;
+	f32 y_top_row = game->stock.pos.y;
+	Card *drag_card = game->card_dragging;
 	
 	// if mouse is in row with stock and foundations
-	if (my >= y_top_row && my < y_top_row + game.card_height) {
+	if (my >= y_top_row && my < y_top_row + game->card_height) {
 		// check stock
-		Card *stock_top = oc_list_first_entry(game.stock.cards, Card, node);
+		Card *stock_top = oc_list_first_entry(game->stock.cards, Card, node);
 		bool top_is_drag_card = stock_top && stock_top == drag_card;
-		if (!top_is_drag_card && point_in_card_bounds(mx, my, stock_top)) {
+		if (!top_is_drag_card && point_in_card_bounds(game, mx, my, stock_top)) {
 			return stock_top;
 		} 
 
 		// check waste
-		Card *waste_top = oc_list_first_entry(game.waste.cards, Card, node);
+		Card *waste_top = oc_list_first_entry(game->waste.cards, Card, node);
 		top_is_drag_card = waste_top && waste_top == drag_card;
-		if (!top_is_drag_card && point_in_card_bounds(mx, my, waste_top)) {
+		if (!top_is_drag_card && point_in_card_bounds(game, mx, my, waste_top)) {
 			return waste_top;
 		}
 
 		// check foundations
-		for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-			Card *foundation_top = oc_list_first_entry(game.foundations[i].cards, Card, node);
+		for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+			Card *foundation_top = oc_list_first_entry(game->foundations[i].cards, Card, node);
 			if (foundation_top && foundation_top == drag_card) continue;
-			if (point_in_card_bounds(mx, my, foundation_top)) {
+			if (point_in_card_bounds(game, mx, my, foundation_top)) {
 				return foundation_top;
 			}
 		}
 
 	} else {
 		// check tableau
-		for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-			oc_list_for(game.tableau[i].cards, card, Card, node) {
+		for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+			oc_list_for(game->tableau[i].cards, card, Card, node) {
 				if (card == drag_card) continue;
-				if (point_in_card_bounds(mx, my, card)) {
+				if (point_in_card_bounds(game, mx, my, card)) {
 					return card;
 				}
 			}
@@ -816,11 +920,16 @@ static bool opposite_color_suits(Card *a, Card *b) {
 }
 
 // is it legal to drag this card and those on top of it?
+static bool is_movable_stack(Card *card);
+
+// cards still on their way somewhere can be picked up mid flight, a failed
+// drop sends them on to where they were going, see CardDrag
 static bool can_drag(Card *card) {
-	bool card_in_motion = card->pos.x != card->target_pos.x || card->pos.y != card->target_pos.y;
-	if (card_in_motion) {
-		return false;
-	}
+	return is_movable_stack(card);
+}
+
+// are card and the cards on top of it a face up run of alternating colors
+static bool is_movable_stack(Card *card) {
 	for (oc_list_elt *node = card->node.prev; node; node = node->prev) {
 		Card *prev_card = oc_list_entry(node, Card, node);
 		if (!opposite_color_suits(card, prev_card) || (card->kind - prev_card->kind != 1)) {
@@ -831,13 +940,13 @@ static bool can_drag(Card *card) {
 	return card->face_up;
 }
 
-static bool can_drop_empty_pile(Card *card, Pile *pile) {
+static bool can_drop_empty_pile(GameState *game, Card *card, Pile *pile) {
 	bool result = false;
 	if (oc_list_empty(pile->cards)) {
 		if (pile->kind == PILE_FOUNDATION) {
 			result = card->kind == CARD_ACE;
 		} else if (pile->kind == PILE_TABLEAU) {
-			if (game.draw_three_mode) {
+			if (game->draw_three_mode) {
 				result = card->kind == CARD_KING;
 			} else {
 				result = true;
@@ -866,12 +975,12 @@ static bool can_drop(Card *card, Card *target) {
 
 // checks if card is currently colliding with an empty pile or the top card on
 // the pile and returns true if it is legal to drop card there, otherwise false
-static bool can_drop_card_on_pile(Pile *pile, Card *card) {
+static bool can_drop_card_on_pile(GameState *game, Pile *pile, Card *card) {
 	oc_rect card_rect = {
 		.x = card->pos.x, 
 		.y = card->pos.y,
-		.w = game.card_width,
-		.h = game.card_height 
+		.w = game->card_width,
+		.h = game->card_height 
 	};
 
 	// check empty pile
@@ -879,10 +988,10 @@ static bool can_drop_card_on_pile(Pile *pile, Card *card) {
 		oc_rect pile_rect = {
 			.x = pile->pos.x, 
 			.y = pile->pos.y,
-			.w = game.card_width,
-			.h = game.card_height };
+			.w = game->card_width,
+			.h = game->card_height };
 		if (rect_in_rect(card_rect, pile_rect) &&
-		    can_drop_empty_pile(card, pile))
+		    can_drop_empty_pile(game, card, pile))
 		{
 			return true;
 		}
@@ -893,8 +1002,8 @@ static bool can_drop_card_on_pile(Pile *pile, Card *card) {
 		oc_rect top_rect = {
 			.x = top->pos.x, 
 			.y = top->pos.y,
-			.w = game.card_width,
-			.h = game.card_height 
+			.w = game->card_width,
+			.h = game->card_height 
 		};
 		if (top != card && 
 			rect_in_rect(card_rect, top_rect) &&
@@ -907,39 +1016,37 @@ static bool can_drop_card_on_pile(Pile *pile, Card *card) {
 	return false;
 }
 
-static bool maybe_drop_dragged_card(void) {
-	Card *drag_card = game.card_dragging;
+static bool maybe_drop_dragged_card(GameState *game) {
+	Card *drag_card = game->card_dragging;
 
-	// check foundations
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		Pile *pile = &game.foundations[i]; 
-		if (can_drop_card_on_pile(pile, drag_card)) {
-			update_score_pile_transfer(drag_card->pile, pile);
-			undo_push_pile_transfer(drag_card);
-			pile_transfer(pile, drag_card, false);
-			return true;
+	// check foundations, then tableau
+	Pile *target = NULL;
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations) && !target; ++i) {
+		if (can_drop_card_on_pile(game, &game->foundations[i], drag_card)) {
+			target = &game->foundations[i];
 		}
 	}
-
-	// check tableau
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		Pile *pile = &game.tableau[i];
-		if (can_drop_card_on_pile(pile, drag_card)) {
-			update_score_pile_transfer(drag_card->pile, pile);
-			undo_push_pile_transfer(drag_card);
-			pile_transfer(pile, drag_card, false);
-			return true;
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau) && !target; ++i) {
+		if (can_drop_card_on_pile(game, &game->tableau[i], drag_card)) {
+			target = &game->tableau[i];
 		}
 	}
+	if (!target) {
+		return false;
+	}
 
-	return false;
+	history_resume(game);
+	update_score_pile_transfer(game, drag_card->pile, target);
+	undo_push_pile_transfer(game, drag_card, target);
+	pile_transfer(game, target, drag_card, false);
+	return true;
 }
 
 
-static bool is_game_won(void) {
+static bool is_game_won(GameState *game) {
 	bool win = true;
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		Card *top = pile_peek_top(&game.foundations[i]);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		Card *top = pile_peek_top(&game->foundations[i]);
 		if (!top || top->kind != CARD_KING) {
 			win = false;
 			break;
@@ -948,22 +1055,22 @@ static bool is_game_won(void) {
 	return win;
 }
 
-static bool is_tableau_empty(void) {
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		if (!oc_list_empty(game.tableau[i].cards)) {
+static bool is_tableau_empty(GameState *game) {
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		if (!oc_list_empty(game->tableau[i].cards)) {
 			return false;
 		}
 	}
 	return true;
 }
 
-static bool is_autocomplete_possible(void) {
-	if (!oc_list_empty(game.stock.cards) || !oc_list_empty(game.waste.cards)) {
+static bool is_autocomplete_possible(GameState *game) {
+	if (!oc_list_empty(game->stock.cards) || !oc_list_empty(game->waste.cards)) {
 		return false;
 	}
 
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		Pile *pile = &game.tableau[i];
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		Pile *pile = &game->tableau[i];
 		oc_list_for_reverse(pile->cards, card, Card, node) {
 			if (!card->face_up) {
 				return false;
@@ -978,14 +1085,48 @@ static bool is_autocomplete_possible(void) {
 	return true;
 }
 
-static bool auto_transfer_card_to_foundation(Card *card) {
+// NOTE(shaw): the par is the fewest moves from the deal the search could find
+// with PAR_NODE_LIMIT nodes, see par.c. it is usually the best known win
+// rather than a proven minimum, so a player can beat it, and the moves
+// counter only calls it a par once it is proven
+static void start_par_search(GameState *game) {
+	if (!game->par.table) {
+		par_init(&game->par, PAR_MEMORY_CAP);
+		mem_track(&game->memory[MEM_PAR], game->par.bytes);
+	}
+	SolverState state;
+	solver_deal(&state, game->deal_number, game->draw_three_mode);
+	par_start(&game->par, &state, PAR_NODE_LIMIT);
+}
+
+static void step_par_search(GameState *game) {
+	if (game->par.status == PAR_SEARCHING && par_run(&game->par, PAR_SLICE_SECONDS) == PAR_DONE) {
+		oc_log_info("par %u (%s, at least %u) after %llu nodes in %.0fms\n", game->par.par,
+			game->par.proven ? "proven" : "best found", game->par.lower_bound,
+			(unsigned long long)game->par.nodes, game->par.seconds * 1000.0);
+		update_moves_string(game);
+	}
+}
+
+static void finish_won_game(GameState *game) {
+	UpdateScoreParams params = { .kind = SCORE_TIME_BONUS };
+	update_score(game, params);
+	if (!game->replaying) {
+		save_highscore(game);
+		telemetry_finish_game(game, TELEMETRY_WON);
+		if (game->interactive) start_par_search(game);
+	}
+	set_state(game, STATE_WIN);
+}
+
+static bool auto_transfer_card_to_foundation(GameState *game, Card *card) {
 	if (card->pile->kind == PILE_FOUNDATION || card->pile->kind == PILE_STOCK || card->node.prev != NULL) {
 		return false;
 	}
 
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
 		bool auto_transfer = false;
-		Card *top = pile_peek_top(&game.foundations[i]);
+		Card *top = pile_peek_top(&game->foundations[i]);
 		if (top) {
 			if ((top->suit == card->suit) && (top->kind == card->kind - 1)) {
 				auto_transfer = true;
@@ -995,9 +1136,10 @@ static bool auto_transfer_card_to_foundation(Card *card) {
 		}
 
 		if (auto_transfer) {
-			update_score_pile_transfer(card->pile, &game.foundations[i]);
-			undo_push_pile_transfer(card);
-			pile_transfer(&game.foundations[i], card, false);
+			history_resume(game);
+			update_score_pile_transfer(game, card->pile, &game->foundations[i]);
+			undo_push_pile_transfer(game, card, &game->foundations[i]);
+			pile_transfer(game, &game->foundations[i], card, false);
 			return true;
 		}
 	}
@@ -1005,28 +1147,73 @@ static bool auto_transfer_card_to_foundation(Card *card) {
 	return false;
 }
 
+static void draw_from_stock(GameState *game, bool instant) {
+	i32 cards_to_transfer = game->draw_three_mode ? 3 : 1;
+	for (i32 i=0; i<cards_to_transfer; ++i) {
+		Card *card = pile_peek_top(&game->stock);
+		if (card) {
+			undo_push_pile_transfer(game, card, &game->waste);
+			card->face_up = true;
+			pile_transfer(game, &game->waste, card, instant);
+		}
+	}
+}
+
+// moves the whole waste back onto the stock
+static void recycle_waste(GameState *game, bool instant) {
+	Card *card = pile_peek_top(&game->waste);
+	if (card) {
+		UpdateScoreParams params = { .kind = SCORE_RECYCLE_WASTE };
+		update_score(game, params);
+	}
+	while (card) {
+		undo_push_pile_transfer(game, card, &game->stock);
+		card->face_up = false;
+		pile_transfer(game, &game->stock, card, instant);
+		card = pile_peek_top(&game->waste);
+	}	
+}
+
 // if a card at the top of tableau has been revealed turn it over
-static void reveal_tableau_card(void) {
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		Card *top = pile_peek_top(&game.tableau[i]);
+static void reveal_tableau_card(GameState *game) {
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		Card *top = pile_peek_top(&game->tableau[i]);
 		if (top && !top->face_up) {
 			top->face_up = true;
+			pile_bump_version(game, &game->tableau[i]);
 			UpdateScoreParams params = { .kind = SCORE_REVEAL_TABLEAU };
-			update_score(params);
+			update_score(game, params);
 		}
 	}
 }
 
-static bool step_cards_towards_target(f32 rate) {
+static const char *animation_speed_names[ANIMATION_SPEED_COUNT] = {
+	[ANIMATION_NORMAL] = "Animation: Normal",
+	[ANIMATION_FAST]   = "Animation: Fast",
+	[ANIMATION_OFF]    = "Animation: Off",
+};
+
+// fast runs every animation at twice the speed. with animation off a deal or
+// autocomplete plays out in one step and moved cards land on the next
+static void set_animation_speed(GameState *game, AnimationSpeed speed) {
+	f32 scale = speed == ANIMATION_FAST ? 2.0f : 1.0f;
+	bool off = speed == ANIMATION_OFF;
+	game->animation_speed = speed;
+	game->deal_delay = off ? 0 : DEAL_DELAY / scale;
+	game->deal_duration = off ? 0 : DEAL_DURATION / scale;
+	game->card_animate_speed = off ? 0 : CARD_ANIMATE_SPEED * scale;
+}
+
+static bool step_cards_towards_target(GameState *game, f32 rate) {
 	bool any_card_moved = false;
-	for (i32 i=0; i<ARRAY_COUNT(game.cards); ++i) {
-		Card *card = &game.cards[i];
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		Card *card = &game->cards[i];
 		if (card->pos.x != card->target_pos.x || card->pos.y != card->target_pos.y) {
-			if (vec2_dist(card->pos, card->target_pos) < 1) {
-				card->pos = card->target_pos;
+			if (rate <= 0 || vec2_dist(card->pos, card->target_pos) < 1) {
+				card->pos = card->prev_pos = card->target_pos;
 			} else {
-				card->pos.x += (card->target_pos.x - card->pos.x) * rate * game.dt;
-				card->pos.y += (card->target_pos.y - card->pos.y) * rate * game.dt;
+				card->pos.x += (card->target_pos.x - card->pos.x) * rate * game->dt;
+				card->pos.y += (card->target_pos.y - card->pos.y) * rate * game->dt;
 				any_card_moved = true;
 			}
 		}
@@ -1034,373 +1221,754 @@ static bool step_cards_towards_target(f32 rate) {
 	return any_card_moved;
 }
 
-static inline void append_win_card_path(Card *card) {
-	if (game.win_card_path_index < ARRAY_COUNT(game.win_card_path)) {
-		game.win_card_path[game.win_card_path_index++] = (CardPath){
-			.suit = card->suit,	
-			.kind = card->kind,	
-			.pos = card->pos,
-		};
-	} else {
-		oc_log_error("too many card positions in win_card_path: %d\n", game.win_card_path_index);
-		game.win_card_path_index = 0;
+static inline void append_win_card_path(GameState *game, Card *card) {
+	if (game->win_card_path.count >= WIN_CARD_PATH_MAX) {
+		oc_log_error("too many card positions in win_card_path: %d\n", game->win_card_path.count);
+		game->win_card_path.count = 0;
 	}
+	CardPath *path = block_array_push(&game->win_card_path);
+	*path = (CardPath){
+		.suit = card->suit,
+		.kind = card->kind,
+		.pos = card->pos,
+	};
 }
 
-static void solitaire_update_win(void) {
-	Card *card = game.win_moving_card;
-	bool launch_next_card = !card 
-		|| (card->pos.x + game.card_width < 0)
-		|| (card->pos.x > game.frame_size.x);
-
-	if (launch_next_card) {
-		card = pile_pop(&game.foundations[game.win_foundation_index]);
-		game.win_foundation_index = (game.win_foundation_index + 1) % ARRAY_COUNT(game.foundations);
-		if (card) {
-			card->vel.y = rand_f32() * 300.0f - 400.0f;
-			f32 rand_val = rand_f32();
-			f32 dir = rand_val > 0.5f ? -1.0f : 1.0f;
-			card->vel.x = (rand_val * 420.0f + 45.0f) * dir;
+static void win_launch_card(GameState *game, Card *card, oc_vec2 velocity) {
+	assert(game->win_flying_count < WIN_MAX_FLYING_CARDS);
+	i32 i = game->win_flying_count++;
+	game->win_flying_cards[i] = card;
+	game->win_pos_x[i] = card->pos.x;
+	game->win_pos_y[i] = card->pos.y;
+	game->win_vel_x[i] = velocity.x;
+	game->win_vel_y[i] = velocity.y;
+}
+
+// the last card is swapped into the hole so the arrays stay packed
+static void win_retire_card(GameState *game, Card *card) {
+	for (i32 i=0; i<game->win_flying_count; ++i) {
+		if (game->win_flying_cards[i] == card) {
+			i32 last = --game->win_flying_count;
+			game->win_flying_cards[i] = game->win_flying_cards[last];
+			game->win_pos_x[i] = game->win_pos_x[last];
+			game->win_pos_y[i] = game->win_pos_y[last];
+			game->win_vel_x[i] = game->win_vel_x[last];
+			game->win_vel_y[i] = game->win_vel_y[last];
+			return;
 		}
-		game.win_moving_card = card;
 	}
+}
 
-	// tick launched card
-	if (card) {
-		card->vel.y += GRAVITY * game.dt;
-		card->pos.x += card->vel.x * game.dt;
-		card->pos.y += card->vel.y * game.dt;
-		if (card->pos.y + game.card_height >= game.frame_size.y) {
-			card->pos.y = game.frame_size.y - game.card_height;
-			if (card->vel.y > 0) {
-				card->vel.y *= -0.88f;
-			} 
+// advances every flying card by one fixed step. kept free of calls and
+// early outs so the compiler can vectorize it (simd128 when building wasm
+// with -msimd128)
+static void win_physics_step(GameState *game, f32 step, f32 floor_y) {
+	i32 count = game->win_flying_count;
+	f32 *restrict pos_x = game->win_pos_x;
+	f32 *restrict pos_y = game->win_pos_y;
+	f32 *restrict vel_x = game->win_vel_x;
+	f32 *restrict vel_y = game->win_vel_y;
+	for (i32 i=0; i<count; ++i) {
+		vel_y[i] += GRAVITY * step;
+		pos_x[i] += vel_x[i] * step;
+		pos_y[i] += vel_y[i] * step;
+		bool hit_floor = pos_y[i] >= floor_y;
+		bool bounce = hit_floor && vel_y[i] > 0;
+		pos_y[i] = hit_floor ? floor_y : pos_y[i];
+		vel_y[i] = bounce ? vel_y[i] * -0.88f : vel_y[i];
+	}
+}
+
+// how many steps of win_physics_step a card launched from pos flies before
+// it leaves the screen horizontally or runs out of lifetime
+static i32 win_flight_steps(GameState *game, oc_vec2 pos, oc_vec2 vel, f32 floor_y) {
+	f32 step = WIN_PHYSICS_STEP;
+	i32 steps = 0;
+	for (f32 lifetime=0; lifetime < WIN_CARD_MAX_LIFETIME; lifetime += step) {
+		vel.y += GRAVITY * step;
+		pos.x += vel.x * step;
+		pos.y += vel.y * step;
+		if (pos.y >= floor_y) {
+			pos.y = floor_y;
+			if (vel.y > 0) vel.y *= -0.88f;
 		}
-		append_win_card_path(card);
-	}
-}
-
-static void solitaire_update_autocomplete(void) {
-	bool tableau_empty = is_tableau_empty();
-
-	if (!tableau_empty && game.deal_countdown <= 0) {
-		bool card_transferred = false;
-		for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-			if (card_transferred) break;
-			Card *tableau_top = pile_peek_top(&game.tableau[i]);
-			if (!tableau_top) continue;
-			for (i32 j=0; j<ARRAY_COUNT(game.foundations); ++j) {
-				if (card_transferred) break;
-				Pile *foundation_pile = &game.foundations[j];
-				Card *foundation_top = pile_peek_top(foundation_pile);
-				if (foundation_top) {
-					if (tableau_top->suit == foundation_top->suit &&
-						tableau_top->kind == foundation_top->kind + 1)
-					{
-						update_score_pile_transfer(tableau_top->pile, foundation_pile);
-						pile_transfer(foundation_pile, tableau_top, false);
-						card_transferred = true;
-					}
-				} else if (tableau_top->kind == CARD_ACE){
-					update_score_pile_transfer(tableau_top->pile, foundation_pile);
-					pile_transfer(foundation_pile, tableau_top, false);
-					card_transferred = true;
-				}
+		++steps;
+		if (pos.x + game->card_width < 0 || pos.x > game->frame_size.x) break;
+	}
+	return steps;
+}
+
+// NOTE(shaw): cards leave the foundations round robin, one every
+// win_launch_interval while fewer than win_max_flying are in the air. every
+// flight is worked out here with the same fixed steps the animation runs, so
+// the plan knows when each card lands or leaves the screen and frees its
+// slot. the timeline launches and retires the cards, win_physics_step moves
+// the ones in the air
+static void start_win_sequence(GameState *game) {
+	timeline_clear(game, SEQUENCE_WIN);
+	f32 step = WIN_PHYSICS_STEP;
+	f32 floor_y = game->frame_size.y - game->card_height;
+	i32 max_flying = game->win_max_flying;
+	if (max_flying < 1) max_flying = 1;
+	if (max_flying > WIN_MAX_FLYING_CARDS) max_flying = WIN_MAX_FLYING_CARDS;
+
+	Card *next[ARRAY_COUNT(game->foundations)];
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		next[i] = pile_peek_top(&game->foundations[i]);
+	}
+	i32 foundation = 0;
+	i32 landing_step[WIN_MAX_FLYING_CARDS];
+	i32 flying = 0;
+	f32 launch_countdown = 0;
+
+	for (i32 s=1; ; ++s) {
+		for (i32 i=0; i<flying;) {
+			if (landing_step[i] <= s) {
+				landing_step[i] = landing_step[--flying];
+			} else {
+				++i;
 			}
 		}
-		assert(card_transferred);
-		game.deal_countdown += game.deal_delay;
-	} else {
-		game.deal_countdown -= game.dt;
-	}
 
-	bool any_card_moved = step_cards_towards_target(game.deal_speed);
+		launch_countdown -= step;
+		if (launch_countdown > 0 || flying == max_flying) continue;
 
-	if (tableau_empty && !any_card_moved) {
-		UpdateScoreParams params = { .kind = SCORE_TIME_BONUS };
-		update_score(params);
-		save_highscore();
-		game.state = STATE_WIN;
+		Card *card = NULL;
+		for (i32 tries=0; tries<ARRAY_COUNT(next) && !card; ++tries) {
+			card = next[foundation];
+			if (card) {
+				next[foundation] = oc_list_next_entry(game->foundations[foundation].cards, card, Card, node);
+			}
+			foundation = (foundation + 1) % ARRAY_COUNT(next);
+		}
+		if (!card) break;
+
+		oc_vec2 velocity;
+		velocity.y = rand_f32(&game->rng) * 300.0f - 400.0f;
+		f32 rand_val = rand_f32(&game->rng);
+		f32 dir = rand_val > 0.5f ? -1.0f : 1.0f;
+		velocity.x = (rand_val * 420.0f + 45.0f) * dir;
+
+		i32 steps = win_flight_steps(game, card->pos, velocity, floor_y);
+		TimelineItem *item = timeline_push(game, TIMELINE_LAUNCH, card, s * step, steps * step, EASE_LINEAR);
+		item->to = velocity;
+		landing_step[flying++] = s + steps;
+
+		launch_countdown += game->win_launch_interval;
+		if (launch_countdown < 0) launch_countdown = 0;
+	}
+}
+
+// the win animation runs on the fixed simulation step so launch cadence,
+// bounces and the trail left behind look the same regardless of frame rate.
+// it is planned on its first step, so anything that sets STATE_WIN gets it
+static void solitaire_update_win(GameState *game) {
+	if (game->timeline.sequence != SEQUENCE_WIN) {
+		start_win_sequence(game);
+	}
+	timeline_update(game, game->dt);
+
+	win_physics_step(game, WIN_PHYSICS_STEP, game->frame_size.y - game->card_height);
+	for (i32 i=0; i<game->win_flying_count; ++i) {
+		Card *card = game->win_flying_cards[i];
+		card->pos.x = game->win_pos_x[i];
+		card->pos.y = game->win_pos_y[i];
+		append_win_card_path(game, card);
+	}
+}
+
+// moves the first tableau top card that fits onto a foundation
+static bool autocomplete_step(GameState *game, bool instant) {
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		Card *tableau_top = pile_peek_top(&game->tableau[i]);
+		if (!tableau_top) continue;
+		for (i32 j=0; j<ARRAY_COUNT(game->foundations); ++j) {
+			Pile *foundation_pile = &game->foundations[j];
+			Card *foundation_top = pile_peek_top(foundation_pile);
+			bool fits = foundation_top
+				? tableau_top->suit == foundation_top->suit && tableau_top->kind == foundation_top->kind + 1
+				: tableau_top->kind == CARD_ACE;
+			if (fits) {
+				update_score_pile_transfer(game, tableau_top->pile, foundation_pile);
+				pile_transfer(game, foundation_pile, tableau_top, instant);
+				return true;
+			}
+		}
 	}
+	return false;
 }
 
-static void solitaire_update_dealing(void) {
-	if (game.deal_cards_remaining > 0 && game.deal_countdown <= 0) {
-		Card *card = pile_pop(&game.stock);
-		--game.deal_cards_remaining;
-		i32 i = game.deal_tableau_index;
-		i32 remaining = game.deal_tableau_remaining;
-		i32 count = ARRAY_COUNT(game.tableau);
-
-		pile_push(&game.tableau[i], card, false);
-		if (i == count - remaining) {
-			card->face_up = true;
+// plays the next move of a proven solution the way a player would make it,
+// so it is scored, undoable and recorded like any other move
+static void proven_autocomplete_step(GameState *game) {
+	SolverMove move = game->autocomplete_solver.path[game->autocomplete_next_move++];
+	if (move.from == SOLVER_PILE_STOCK) {
+		draw_from_stock(game, false);
+	} else if (move.to == SOLVER_PILE_STOCK) {
+		recycle_waste(game, false);
+	} else {
+		Pile *from = move.from >= SOLVER_PILE_TABLEAU ? &game->tableau[move.from - SOLVER_PILE_TABLEAU]
+		           : move.from == SOLVER_PILE_WASTE   ? &game->waste
+		           : solver_game_foundation(game, move.from - SOLVER_PILE_FOUNDATION);
+		Pile *to = move.to >= SOLVER_PILE_TABLEAU ? &game->tableau[move.to - SOLVER_PILE_TABLEAU]
+		         : solver_game_foundation(game, move.to - SOLVER_PILE_FOUNDATION);
+		Card *card = pile_peek_top(from);
+		for (i32 i=1; i<move.count; ++i) {
+			card = oc_list_next_entry(from->cards, card, Card, node);
 		}
-
-		if (i == count - 1) {
-			--game.deal_tableau_remaining;
-			game.deal_tableau_index = count - game.deal_tableau_remaining;
+		update_score_pile_transfer(game, from, to);
+		undo_push_pile_transfer(game, card, to);
+		pile_transfer(game, to, card, false);
+		reveal_tableau_card(game);
+	}
+	commit_move(game);
+}
+
+// plays the proven solution, or tableau to foundation moves when proven is
+// false, one move every deal_delay. cards still landing from the move that
+// started it carry on from where they are
+static void start_autocomplete_sequence(GameState *game, bool proven) {
+	timeline_clear(game, SEQUENCE_AUTOCOMPLETE);
+	TimelinePlan plan;
+	timeline_plan_begin(game, &plan);
+	f32 time = 0;
+	timeline_plan_step(game, &plan, time, game->deal_duration, EASE_OUT_CUBIC);
+	for (;;) {
+		if (proven) {
+			if (game->autocomplete_next_move == game->autocomplete_solver.path_length) break;
+			proven_autocomplete_step(game);
 		} else {
-			++game.deal_tableau_index;
+			if (is_tableau_empty(game) || !autocomplete_step(game, false)) break;
 		}
-		game.deal_countdown += game.deal_delay;
-	} else {
-		game.deal_countdown -= game.dt;
+		time += game->deal_delay;
+		timeline_plan_step(game, &plan, time, game->deal_duration, EASE_IN_OUT_CUBIC);
 	}
+	timeline_plan_end(game, &plan);
+	set_state(game, STATE_AUTOCOMPLETE);
+}
 
-	bool any_card_moved = step_cards_towards_target(game.deal_speed);
-	
-	if (game.deal_cards_remaining == 0 && !any_card_moved) {
-		game.state = STATE_PLAY;
+// NOTE(shaw): once no tableau card is face down every card is known and a
+// short search can often prove the rest of the game, well before the board
+// is sorted enough for is_autocomplete_possible. the node and time budgets
+// keep a failed search inside a frame, it simply runs again after the next move
+static void maybe_start_proven_autocomplete(GameState *game) {
+	if (game->state != STATE_PLAY || is_game_won(game)) {
+		return;
+	}
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		oc_list_for(game->tableau[i].cards, card, Card, node) {
+			if (!card->face_up) return;
+		}
+	}
+
+	Solver *solver = &game->autocomplete_solver;
+	if (!solver->table) {
+		oc_arena_init(&game->autocomplete_solver_arena);
+		solver_init(solver, &game->autocomplete_solver_arena, AUTOCOMPLETE_PROOF_NODES);
+		solver->time_limit = AUTOCOMPLETE_PROOF_SECONDS;
+		mem_track(&game->memory[MEM_SOLVER], solver->bytes);
+	}
+
+	SolverState state;
+	solver_from_game(game, &state);
+	if (solver_solve(solver, &state) == SOLVER_WON) {
+		oc_log_info("autocompleting, win proven in %u moves after %u nodes\n", solver->path_length, solver->nodes);
+		game->autocomplete_next_move = 0;
+		start_autocomplete_sequence(game, true);
 	}
 }
 
-static void solitaire_update_show_rules(void) {
-	if (pressed(game.mouse_input.left)) {
-		game.state = game.restore_state;
+static void solitaire_update_autocomplete(GameState *game) {
+	if (timeline_update(game, game->dt)) {
+		finish_won_game(game);
 	}
 }
 
-static void solitaire_update_select_card_back(void) {
+static void solitaire_update_dealing(GameState *game) {
+	if (timeline_update(game, game->dt)) {
+		set_state(game, STATE_PLAY);
+	}
+}
+
+static void solitaire_input_show_rules(GameState *game) {
+	if (pressed(game->mouse_input.left)) {
+		set_state(game, game->restore_state);
+	}
+}
+
+static void solitaire_input_select_card_back(GameState *game) {
 	// NOTE(shaw): the ui handles transition out of STATE_SELECT_CARD_BACK
 
-	if (!game.menu_card_backs_draw_box) {
+	if (!game->menu_card_backs_draw_box) {
 		return;
 	}
-	oc_rect draw_box = game.menu_card_backs_draw_box->rect;
+	oc_rect draw_box = game->menu_card_backs_draw_box->rect;
 	
-	if (pressed(game.mouse_input.left)) {
-		i32 count_first_row = ARRAY_COUNT(game.card_backs) / 2;
+	if (pressed(game->mouse_input.left)) {
+		i32 count_first_row = ARRAY_COUNT(game->card_backs) / 2;
 
-		for (i32 i=0; i<ARRAY_COUNT(game.card_backs); ++i) {
+		for (i32 i=0; i<ARRAY_COUNT(game->card_backs); ++i) {
 			f32 x = 0, y = 0;
 			if (i < count_first_row) {
-				x = draw_box.x + (i * (game.card_width + game.card_margin_x));
+				x = draw_box.x + (i * (game->card_width + game->card_margin_x));
 				y = draw_box.y;
 			} else {
-				x = draw_box.x + ((i - count_first_row) * (game.card_width + game.card_margin_x));
-				y = draw_box.y + game.card_height + game.card_margin_x;
+				x = draw_box.x + ((i - count_first_row) * (game->card_width + game->card_margin_x));
+				y = draw_box.y + game->card_height + game->card_margin_x;
 			}
-			oc_rect hitbox = { x, y, game.card_width, game.card_height };
+			oc_rect hitbox = { x, y, game->card_width, game->card_height };
 
-			if (point_in_rect(game.mouse_input.x, game.mouse_input.y, hitbox)) {
-				game.selected_card_back = i;
+			if (point_in_rect(game->mouse_input.x, game->mouse_input.y, hitbox)) {
+				game->selected_card_back = i;
 				break;
 			}
 		}
 	}
 }
 
-static void solitaire_update_play(void) {
-	step_cards_towards_target(game.card_animate_speed);
+static void move_dragged_cards_to(GameState *game, f32 x, f32 y) {
+	if (game->card_dragging) {
+		for (oc_list_elt *node = &game->card_dragging->node; node; node = node->prev) {
+			Card *card = oc_list_entry(node, Card, node);
+			CardDrag *drag = card_drag(game, card);
+			card->target_pos.x = x - drag->offset.x;
+			card->target_pos.y = y - drag->offset.y;
+			// NOTE(shaw): it is important to set both pos and target_pos here
+			// so that card drops are accurate. prev_pos is set as well so the
+			// dragged stack is drawn exactly under the mouse, not interpolated
+			card->pos = card->prev_pos = card->target_pos;
+		}
+	}
+}
+
+// where the dragged stack is shown, optionally pushed ahead along the mouse's
+// recent velocity to hide some of the input to display latency. the velocity
+// only changes on mouse moves, so the lead shrinks with the time since the
+// last one and a stopped mouse has the stack back under it within the horizon
+static oc_vec2 drag_display_pos(GameState *game, f32 x, f32 y) {
+	f32 lead = game->drag_prediction;
+	if (lead > 0) {
+		f32 since_move = (f32)(oc_clock_time(OC_CLOCK_MONOTONIC) - game->input_last_move_time);
+		lead = since_move < lead ? lead - since_move : 0;
+	}
+	return (oc_vec2){
+		x + game->drag_velocity.x * lead,
+		y + game->drag_velocity.y * lead,
+	};
+}
 
+static void solitaire_input_play(GameState *game) {
 	// freeze user input dealing with gameplay while menu is open
-	if (game.menu_opened) return;
+	if (game->menu_opened) return;
+
+	// a release drops the cards where the mouse was when it happened, with
+	// no prediction applied
+	move_dragged_cards_to(game, game->mouse_input.x, game->mouse_input.y);
+
+	Card *hovered_card = get_hovered_card(game);
 
-	Card *hovered_card = get_hovered_card();
+	if (history_bar_visible(game) && !game->card_dragging) {
+		oc_rect bar = history_bar_rect(game);
+		if (pressed(game->mouse_input.left) && point_in_rect(game->mouse_input.x, game->mouse_input.y, bar)) {
+			game->history.scrubbing = true;
+			history_scrub_to_x(game, game->mouse_input.x);
+			return;
+		}
+		if (pressed(game->input.arrow_left)) {
+			history_scrub(game, game->history.cursor - 1);
+		} else if (pressed(game->input.arrow_right)) {
+			history_scrub(game, game->history.cursor + 1);
+		}
+	}
+	if (game->history.scrubbing) {
+		if (released(game->mouse_input.left)) {
+			game->history.scrubbing = false;
+		}
+		return;
+	}
 
-	if (pressed(game.mouse_input.left)) {
+	if (pressed(game->mouse_input.left)) {
 		if (hovered_card) {
 			// start dragging card
 			if (can_drag(hovered_card)) {
 				// store pos and drag offset for all cards being dragged together
 				for (oc_list_elt *node = &hovered_card->node; node; node = node->prev) {
 					Card *card = oc_list_entry(node, Card, node);
-					card->pos_before_drag = card->pos;
-					card->drag_offset.x = game.mouse_input.x - card->pos.x;
-					card->drag_offset.y = game.mouse_input.y - card->pos.y;
+					CardDrag *drag = card_drag(game, card);
+					drag->pos_before_drag = card->pos;
+					drag->target_before_drag = card->target_pos;
+					drag->offset.x = game->mouse_input.x - card->pos.x;
+					drag->offset.y = game->mouse_input.y - card->pos.y;
 				}
-				game.card_dragging = hovered_card;
+				game->card_dragging = hovered_card;
 			}
 
 			// if stock clicked, move cards to waste
-			if (hovered_card == oc_list_first_entry(game.stock.cards, Card, node)) {
-				i32 cards_to_transfer = game.draw_three_mode ? 3 : 1;
-				for (i32 i=0; i<cards_to_transfer; ++i) {
-					Card *card = pile_peek_top(&game.stock);
-					if (card) {
-						undo_push_pile_transfer(card);
-						card->face_up = true;
-						pile_transfer(&game.waste, card, false);
-					}
-				}
+			if (hovered_card == oc_list_first_entry(game->stock.cards, Card, node)) {
+				history_resume(game);
+				draw_from_stock(game, false);
 			}
 
 		} else {
 			// if empty stock clicked, move all waste to stock
-			if (oc_list_empty(game.stock.cards)) {
-				oc_rect stock_rect = { game.stock.pos.x, game.stock.pos.y, game.card_width, game.card_height };
-				if (point_in_rect(game.mouse_input.x, game.mouse_input.y, stock_rect)) {
-					Card *card = pile_peek_top(&game.waste);
-					if (card) {
-						UpdateScoreParams params = { .kind = SCORE_RECYCLE_WASTE };
-						update_score(params);
-					}
-					while (card) {
-						undo_push_pile_transfer(card);
-						card->face_up = false;
-						pile_transfer(&game.stock, card, false);
-						card = pile_peek_top(&game.waste);
-					}	
+			if (oc_list_empty(game->stock.cards)) {
+				oc_rect stock_rect = { game->stock.pos.x, game->stock.pos.y, game->card_width, game->card_height };
+				if (point_in_rect(game->mouse_input.x, game->mouse_input.y, stock_rect) && !oc_list_empty(game->waste.cards)) {
+					history_resume(game);
+					recycle_waste(game, false);
 				}
 			}
 		}
 
-	} else if (released(game.mouse_input.left)) {
-		if (game.card_dragging) {
+	} else if (released(game->mouse_input.left)) {
+		if (game->card_dragging) {
 			bool move_success = false; // default to false
-			f32 drag_dist = vec2_dist(game.card_dragging->pos, game.card_dragging->pos_before_drag);
+			f32 drag_dist = vec2_dist(game->card_dragging->pos, card_drag(game, game->card_dragging)->pos_before_drag);
 			bool is_card_clicked = drag_dist <= MAX_DIST_CONSIDERED_CLICK;
 
 			if (is_card_clicked) {
-				move_success = auto_transfer_card_to_foundation(game.card_dragging);
+				move_success = auto_transfer_card_to_foundation(game, game->card_dragging);
 			} else {
-				move_success = maybe_drop_dragged_card();
+				move_success = maybe_drop_dragged_card(game);
 			}
 
 			if (move_success) {
-				reveal_tableau_card();
-
-				if (is_autocomplete_possible()) {
+				reveal_tableau_card(game);
+
+				// a won board is autocompleted too, with nothing left to
+				// move it just lets the last card land before the win. the
+				// drop is committed first, planning the autocomplete moves
+				// cards and the drop is recorded from the pile it landed on
+				if (is_autocomplete_possible(game)) {
+					commit_move(game);
 					oc_log_info("autocompleting");
-					game.deal_countdown = game.deal_delay;
-					game.state = STATE_AUTOCOMPLETE;
-				}
-
-				if (is_game_won()) {
-					UpdateScoreParams params = { .kind = SCORE_TIME_BONUS };
-					update_score(params);
-					save_highscore();
-					game.state = STATE_WIN;
+					start_autocomplete_sequence(game, false);
 				}
 			} else {
 				// return cards to previous position
-				for (oc_list_elt *node = &game.card_dragging->node; node; node = node->prev) {
+				for (oc_list_elt *node = &game->card_dragging->node; node; node = node->prev) {
 					Card *card = oc_list_entry(node, Card, node);
-					card->target_pos = card->pos_before_drag;
+					card->target_pos = card_drag(game, card)->target_before_drag;
 				}
 			}
 	
-			game.card_dragging = NULL;
+			game->card_dragging = NULL;
 		}
 
-	} else if (pressed(game.mouse_input.right)) {
-		game.mouse_pos_on_mouse_right_down = (oc_vec2){ game.mouse_input.x, game.mouse_input.y };
+	} else if (pressed(game->mouse_input.right)) {
+		game->mouse_pos_on_mouse_right_down = (oc_vec2){ game->mouse_input.x, game->mouse_input.y };
 
-	} else if (released(game.mouse_input.right)) {
+	} else if (released(game->mouse_input.right)) {
 		if (hovered_card) {
-			f32 d = vec2_dist(game.mouse_pos_on_mouse_right_down, (oc_vec2){game.mouse_input.x, game.mouse_input.y});
+			f32 d = vec2_dist(game->mouse_pos_on_mouse_right_down, (oc_vec2){game->mouse_input.x, game->mouse_input.y});
 			bool is_card_right_clicked = d <= MAX_DIST_CONSIDERED_CLICK;
 			if (is_card_right_clicked) {
-				bool did_transfer = auto_transfer_card_to_foundation(hovered_card);
+				bool did_transfer = auto_transfer_card_to_foundation(game, hovered_card);
 				if (did_transfer) {
-					reveal_tableau_card();
+					reveal_tableau_card(game);
 				}
 			}
 		}
-	} else if (pressed(game.input.u)) {
-		undo_move();
+	} else if (pressed(game->input.u)) {
+		history_resume(game);
+		undo_move(game);
 	}
 
-	// move cards being dragged
-	if (game.card_dragging) {
-		for (oc_list_elt *node = &game.card_dragging->node; node; node = node->prev) {
-			Card *card = oc_list_entry(node, Card, node);
-			card->target_pos.x = game.mouse_input.x - card->drag_offset.x;
-			card->target_pos.y = game.mouse_input.y - card->drag_offset.y;
-			// NOTE(shaw): it is important to set both pos and target_pos here
-			// so that card drops are accurate. 
-			card->pos = card->target_pos; 
+	// the drop was committed above. autocomplete's transfers are not a move
+	// of their own and stay out of the undo stack and the record, the same
+	// as when a record is replayed
+	if (game->state == STATE_AUTOCOMPLETE) return;
+
+	bool move_committed = game->temp_undo_stack_index > 0;
+	commit_move(game);
+	if (move_committed) {
+		maybe_start_proven_autocomplete(game);
+	}
+}
+
+static void solitaire_update_play(GameState *game) {
+	step_cards_towards_target(game, game->card_animate_speed);
+
+	if (game->menu_opened) return;
+	if (game->history.scrubbing) {
+		history_scrub_to_x(game, game->mouse_input.x);
+		return;
+	}
+	oc_vec2 pos = drag_display_pos(game, game->mouse_input.x, game->mouse_input.y);
+	move_dragged_cards_to(game, pos.x, pos.y);
+}
+
+static void end_frame_input(GameState *game) {
+	game->mouse_input.left.was_down = game->mouse_input.left.down;
+	game->mouse_input.right.was_down = game->mouse_input.right.down;
+	game->input.r.was_down = game->input.r.down;
+	game->input.u.was_down = game->input.u.down;
+	game->input.m.was_down = game->input.m.down;
+	game->input.l.was_down = game->input.l.down;
+	game->input.t.was_down = game->input.t.down;
+	game->input.d.was_down = game->input.d.down;
+	game->input.arrow_left.was_down = game->input.arrow_left.down;
+	game->input.arrow_right.was_down = game->input.arrow_right.down;
+	game->input.num1.was_down = game->input.num1.down;
+	game->input.num2.was_down = game->input.num2.down;
+	game->input.num3.was_down = game->input.num3.down;
+	game->input.num4.was_down = game->input.num4.down;
+	game->input.num5.was_down = game->input.num5.down;
+	game->input.num6.was_down = game->input.num6.down;
+	game->input.num7.was_down = game->input.num7.down;
+	game->input.num8.was_down = game->input.num8.down;
+	game->input.num9.was_down = game->input.num9.down;
+	game->input.num0.was_down = game->input.num0.down;
+}
+
+static DigitalInput *key_input(GameState *game, oc_key_code key) {
+	switch (key) {
+	case OC_KEY_R: return &game->input.r;
+	case OC_KEY_U: return &game->input.u;
+	case OC_KEY_M: return &game->input.m;
+	case OC_KEY_L: return &game->input.l;
+	case OC_KEY_T: return &game->input.t;
+	case OC_KEY_D: return &game->input.d;
+	case OC_KEY_LEFT:  return &game->input.arrow_left;
+	case OC_KEY_RIGHT: return &game->input.arrow_right;
+	case OC_KEY_1: return &game->input.num1;
+	case OC_KEY_2: return &game->input.num2;
+	case OC_KEY_3: return &game->input.num3;
+	case OC_KEY_4: return &game->input.num4;
+	case OC_KEY_5: return &game->input.num5;
+	case OC_KEY_6: return &game->input.num6;
+	case OC_KEY_7: return &game->input.num7;
+	case OC_KEY_8: return &game->input.num8;
+	case OC_KEY_9: return &game->input.num9;
+	case OC_KEY_0: return &game->input.num0;
+	default:       return NULL;
+	}
+}
+
+static void input_queue_push(GameState *game, InputEvent event) {
+	// consecutive moves collapse into one so a burst of them can't crowd
+	// out the button and key events the queue is there to keep
+	if (event.kind == INPUT_EVENT_MOUSE_MOVE && game->input_queue_count > 0) {
+		i32 last = (game->input_queue_head + game->input_queue_count - 1) % INPUT_QUEUE_MAX;
+		InputEvent *prev = &game->input_queue[last];
+		if (prev->kind == INPUT_EVENT_MOUSE_MOVE) {
+			event.dx += prev->dx;
+			event.dy += prev->dy;
+			*prev = event;
+			return;
 		}
 	}
+	if (game->input_queue_count == INPUT_QUEUE_MAX) {
+		oc_log_error("input queue full, dropping event\n");
+		return;
+	}
+	i32 tail = (game->input_queue_head + game->input_queue_count) % INPUT_QUEUE_MAX;
+	game->input_queue[tail] = event;
+	++game->input_queue_count;
+}
 
-	commit_move();
+static bool input_queue_pop(GameState *game, InputEvent *event) {
+	if (game->input_queue_count == 0) {
+		return false;
+	}
+	*event = game->input_queue[game->input_queue_head];
+	game->input_queue_head = (game->input_queue_head + 1) % INPUT_QUEUE_MAX;
+	--game->input_queue_count;
+	return true;
 }
 
+static void apply_input_event(GameState *game, InputEvent *event) {
+	game->mouse_input.x = event->x;
+	game->mouse_input.y = event->y;
+	game->mouse_input.deltaX = event->dx;
+	game->mouse_input.deltaY = event->dy;
+
+	switch (event->kind) {
+	case INPUT_EVENT_MOUSE_DOWN:
+	case INPUT_EVENT_MOUSE_UP: {
+		bool down = event->kind == INPUT_EVENT_MOUSE_DOWN;
+		if (event->code == OC_MOUSE_LEFT) {
+			game->mouse_input.left.down = down;
+		} else if (event->code == OC_MOUSE_RIGHT) {
+			game->mouse_input.right.down = down;
+		}
+		break;
+	}
+	case INPUT_EVENT_KEY_DOWN:
+	case INPUT_EVENT_KEY_UP: {
+		DigitalInput *input = key_input(game, event->code);
+		if (input) {
+			input->down = event->kind == INPUT_EVENT_KEY_DOWN;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+// handles one button or key event, pressed() and released() see only the
+// edge that event caused
+static void solitaire_handle_input(GameState *game) {
+	switch (game->state) {
+	case STATE_PLAY:
+		solitaire_input_play(game);
+		break;
+	case STATE_DEALING:
+	case STATE_AUTOCOMPLETE:
+		// a click skips to the end of the sequence, which the state's update
+		// finishes this same step. the press is used up so its release does
+		// nothing once play starts
+		if (!game->menu_opened && (pressed(game->mouse_input.left) || pressed(game->mouse_input.right))) {
+			timeline_fast_forward(game);
+			game->mouse_input.left.down = false;
+			game->mouse_input.right.down = false;
+		}
+		break;
+	case STATE_SHOW_RULES:
+		solitaire_input_show_rules(game);
+		break;
+	case STATE_SELECT_CARD_BACK:
+		solitaire_input_select_card_back(game);
+		break;
+	default:
+		break;
+	}
 
-static void end_frame_input(void) {
-	game.mouse_input.left.was_down = game.mouse_input.left.down;
-	game.mouse_input.right.was_down = game.mouse_input.right.down;
-	game.input.r.was_down = game.input.r.down;
-	game.input.u.was_down = game.input.u.down;
-	game.input.num1.was_down = game.input.num1.down;
-	game.input.num2.was_down = game.input.num2.down;
-	game.input.num3.was_down = game.input.num3.down;
-	game.input.num4.was_down = game.input.num4.down;
-	game.input.num5.was_down = game.input.num5.down;
-	game.input.num6.was_down = game.input.num6.down;
-	game.input.num7.was_down = game.input.num7.down;
-	game.input.num8.was_down = game.input.num8.down;
-	game.input.num9.was_down = game.input.num9.down;
-	game.input.num0.was_down = game.input.num0.down;
+	if (pressed(game->input.num1)) {
+		game->selected_card_back = 0;
+	} else if (pressed(game->input.num2)) {
+		game->selected_card_back = 1;
+	} else if (pressed(game->input.num3)) {
+		game->selected_card_back = 2;
+	} else if (pressed(game->input.num4)) {
+		game->selected_card_back = 3;
+	} else if (pressed(game->input.num5)) {
+		game->selected_card_back = 4;
+	} else if (pressed(game->input.num6)) {
+		game->selected_card_back = 5;
+	} else if (pressed(game->input.num7)) {
+		game->selected_card_back = 6;
+	} else if (pressed(game->input.num8)) {
+		game->selected_card_back = 7;
+	} else if (pressed(game->input.num9)) {
+		game->selected_card_back = 8;
+	} else if (pressed(game->input.num0)) {
+		game->selected_card_back = 9;
+	}
+
+	if (pressed(game->input.r)) {
+		game_reset(game);
+	}
+
+	if (pressed(game->input.m)) {
+		mem_report(game);
+	}
+
+	if (pressed(game->input.l)) {
+		latency_report(game);
+	}
+
+	// the record holds the frame drawn before this step
+	if (pressed(game->input.d)) {
+		draw_record_log_stats(game);
+		draw_record_dump(game, "draw_frame.jsonl");
+	}
+
+	if (pressed(game->input.t)) {
+		if (game->trace.enabled) {
+			trace_stop(game, "trace.json");
+		} else {
+			trace_start(game);
+		}
+	}
+
+	end_frame_input(game);
 }
 
-static void solitaire_update(void) {
-	if (game.state == STATE_PLAY || game.state == STATE_AUTOCOMPLETE) {
-		game.timer += game.dt;
-		update_timer_string(game.timer);
+static void solitaire_update(GameState *game) {
+	trace_begin(game, "solitaire_update");
+	if (game->state == STATE_PLAY || game->state == STATE_AUTOCOMPLETE) {
+		game->timer += game->dt;
+		update_timer_string(game, game->timer);
 	}
 
-	switch (game.state) {
+	// NOTE(shaw): events are handled one at a time in the order they arrived
+	// so a press and release landing in the same step are both seen, each at
+	// the position where it happened
+	InputEvent event;
+	while (input_queue_pop(game, &event)) {
+		apply_input_event(game, &event);
+		latency_note_input(game, event.time);
+		bool mouse_button = event.kind == INPUT_EVENT_MOUSE_DOWN || event.kind == INPUT_EVENT_MOUSE_UP;
+		if (mouse_button && game->input_swallow_click) {
+			// the button state follows the event but no edge is left for the
+			// board to see
+			game->mouse_input.left.was_down = game->mouse_input.left.down;
+			game->mouse_input.right.was_down = game->mouse_input.right.down;
+		} else if (event.kind != INPUT_EVENT_MOUSE_MOVE) {
+			solitaire_handle_input(game);
+		}
+	}
+	game->input_swallow_click = false;
+
+	switch (game->state) {
 	case STATE_DEALING:
-		solitaire_update_dealing();
+		trace_begin(game, "solitaire_update_dealing");
+		solitaire_update_dealing(game);
+		trace_end(game, "solitaire_update_dealing");
 		break;
 	case STATE_PLAY:
-		solitaire_update_play();
+		trace_begin(game, "solitaire_update_play");
+		solitaire_update_play(game);
+		trace_end(game, "solitaire_update_play");
 		break;
 	case STATE_SHOW_RULES:
-		solitaire_update_show_rules();
-		break;
 	case STATE_SELECT_CARD_BACK:
-		solitaire_update_select_card_back();
+	case STATE_SHOW_STATISTICS:
 		break;
 	case STATE_AUTOCOMPLETE:
-		solitaire_update_autocomplete();
+		trace_begin(game, "solitaire_update_autocomplete");
+		solitaire_update_autocomplete(game);
+		trace_end(game, "solitaire_update_autocomplete");
 		break;
 	case STATE_WIN:
-		solitaire_update_win();
+		trace_begin(game, "solitaire_update_win");
+		solitaire_update_win(game);
+		trace_end(game, "solitaire_update_win");
 		break;
 	default: 
 		assert(0);
 		break;
 	}
 
-	if (pressed(game.input.num1)) {
-		game.selected_card_back = 0;
-	} else if (pressed(game.input.num2)) {
-		game.selected_card_back = 1;
-	} else if (pressed(game.input.num3)) {
-		game.selected_card_back = 2;
-	} else if (pressed(game.input.num4)) {
-		game.selected_card_back = 3;
-	} else if (pressed(game.input.num5)) {
-		game.selected_card_back = 4;
-	} else if (pressed(game.input.num6)) {
-		game.selected_card_back = 5;
-	} else if (pressed(game.input.num7)) {
-		game.selected_card_back = 6;
-	} else if (pressed(game.input.num8)) {
-		game.selected_card_back = 7;
-	} else if (pressed(game.input.num9)) {
-		game.selected_card_back = 8;
-	} else if (pressed(game.input.num0)) {
-		game.selected_card_back = 9;
-	}
+	step_par_search(game);
+	trace_end(game, "solitaire_update");
+}
 
-	if (pressed(game.input.r)) {
-		game_reset();
+static void set_restore_state(GameState *game) {
+	if (game->state != STATE_SHOW_RULES && game->state != STATE_SELECT_CARD_BACK && game->state != STATE_SHOW_STATISTICS) {
+		game->restore_state = game->state;
 	}
+}
 
-	end_frame_input();
+// NOTE(shaw): the ui sees a click as it happens but the game only handles it
+// once its queued events come up in the next simulation step. when the ui
+// uses a click, its queued mouse button events are swallowed there so they
+// can't also reach the board or the screen the click just opened
+static void swallow_ui_click(GameState *game) {
+	game->input_swallow_click = true;
 }
 
-static void set_restore_state(void) {
-	if (game.state != STATE_SHOW_RULES && game.state != STATE_SELECT_CARD_BACK) {
-		game.restore_state = game.state;
+static bool solitaire_menu_button(GameState *game, const char *name, f32 width) {
+	bool pressed = oc_ui_menu_button_fixed_width(name, width).pressed;
+	if (pressed) {
+		swallow_ui_click(game);
 	}
+	return pressed;
 }
 
-static void do_card_back_menu(void) {
+static void do_card_back_menu(GameState *game) {
 	oc_ui_panel("main panel", OC_UI_FLAG_NONE)
 	{
 		oc_ui_style_next(&(oc_ui_style){ 
@@ -1425,13 +1993,13 @@ static void do_card_back_menu(void) {
 					.size.width = { OC_UI_SIZE_CHILDREN },
 					.size.height = { OC_UI_SIZE_CHILDREN },
 					.layout.axis = OC_UI_AXIS_Y,
-					.layout.margin.x = game.menu_card_backs_margin,
-					.layout.margin.y = game.menu_card_backs_margin,
+					.layout.margin.x = game->menu_card_backs_margin,
+					.layout.margin.y = game->menu_card_backs_margin,
 					.layout.spacing = 24,
-					.bgColor = game.ui.theme->bg1,
-					.borderColor = game.ui.theme->border,
+					.bgColor = ui_context.theme->bg1,
+					.borderColor = ui_context.theme->border,
 					.borderSize = 1,
-					.roundness = game.ui.theme->roundnessSmall },
+					.roundness = ui_context.theme->roundnessSmall },
 					OC_UI_STYLE_SIZE
 					| OC_UI_STYLE_LAYOUT_AXIS
 					| OC_UI_STYLE_LAYOUT_MARGINS
@@ -1467,24 +2035,25 @@ static void do_card_back_menu(void) {
 			oc_ui_box_begin("contents", OC_UI_FLAG_NONE);
 
 			// box for drawing card backs into
-			i32 cards_per_row = ARRAY_COUNT(game.card_backs) - (ARRAY_COUNT(game.card_backs) / 2);
-			f32 row_width = (cards_per_row * game.card_width) + ((cards_per_row - 1) * game.card_margin_x);
-			f32 total_height = (2 * game.card_height) + game.card_margin_x;
+			i32 cards_per_row = ARRAY_COUNT(game->card_backs) - (ARRAY_COUNT(game->card_backs) / 2);
+			f32 row_width = (cards_per_row * game->card_width) + ((cards_per_row - 1) * game->card_margin_x);
+			f32 total_height = (2 * game->card_height) + game->card_margin_x;
 			oc_ui_style_next(&(oc_ui_style){ 
 					.size.width = { OC_UI_SIZE_PIXELS, row_width},
 					.size.height = { OC_UI_SIZE_PIXELS, total_height } },
 					OC_UI_STYLE_SIZE);
 			oc_ui_box_begin("space to draw cards", OC_UI_FLAG_NONE);
 
-			game.menu_card_backs_draw_box = oc_ui_box_top();
+			game->menu_card_backs_draw_box = oc_ui_box_top();
 			// draw code will draw card backs here and update code will handle selection
 			// since orca doesn't seem to have image buttons
 
 			oc_ui_box_end(); // space to draw cards
 
-			oc_ui_style_next(&(oc_ui_style){ .color = game.ui.theme->white }, OC_UI_STYLE_COLOR);
+			oc_ui_style_next(&(oc_ui_style){ .color = ui_context.theme->white }, OC_UI_STYLE_COLOR);
 			if(oc_ui_button("OK").clicked) {
-				game.state = game.restore_state;
+				swallow_ui_click(game);
+				set_state(game, game->restore_state);
 			}
 
 			oc_ui_box_end(); // contents
@@ -1493,12 +2062,71 @@ static void do_card_back_menu(void) {
 	}
 }
 
-static void solitaire_menu(void) {
+static void do_statistics_menu(GameState *game) {
+	oc_ui_panel("main panel", OC_UI_FLAG_NONE)
+	{
+		oc_ui_style_next(&(oc_ui_style){ 
+				.size.width = { OC_UI_SIZE_PARENT, 1 },
+				.size.height = { OC_UI_SIZE_PARENT, 1, 1 },
+				.layout.axis = OC_UI_AXIS_Y,
+				.layout.align.x = OC_UI_ALIGN_CENTER,
+				.layout.align.y = OC_UI_ALIGN_CENTER },
+				OC_UI_STYLE_SIZE
+				| OC_UI_STYLE_LAYOUT_AXIS
+				| OC_UI_STYLE_LAYOUT_ALIGN_X
+				| OC_UI_STYLE_LAYOUT_ALIGN_Y);
+
+		oc_ui_container("statistics", OC_UI_FLAG_NONE)
+		{
+			oc_ui_style_next(&(oc_ui_style){ 
+					.size.width = { OC_UI_SIZE_CHILDREN },
+					.size.height = { OC_UI_SIZE_CHILDREN },
+					.layout.axis = OC_UI_AXIS_Y,
+					.layout.align.x = OC_UI_ALIGN_CENTER,
+					.layout.margin.x = 32,
+					.layout.margin.y = 24,
+					.layout.spacing = 12,
+					.bgColor = ui_context.theme->bg1,
+					.borderColor = ui_context.theme->border,
+					.borderSize = 1,
+					.roundness = ui_context.theme->roundnessSmall },
+					OC_UI_STYLE_SIZE
+					| OC_UI_STYLE_LAYOUT_AXIS
+					| OC_UI_STYLE_LAYOUT_ALIGN_X
+					| OC_UI_STYLE_LAYOUT_MARGINS
+					| OC_UI_STYLE_LAYOUT_SPACING
+					| OC_UI_STYLE_BG_COLOR
+					| OC_UI_STYLE_BORDER_COLOR
+					| OC_UI_STYLE_BORDER_SIZE
+					| OC_UI_STYLE_ROUNDNESS);
+
+			oc_ui_box_begin("Statistics", OC_UI_FLAG_DRAW_BACKGROUND | OC_UI_FLAG_DRAW_BORDER);
+
+			oc_ui_style_next(&(oc_ui_style){ .fontSize = 18 }, OC_UI_STYLE_FONT_SIZE);
+			oc_ui_label("Statistics");
+
+			for (i32 i=0; i<ARRAY_COUNT(game->statistics_strings); ++i) {
+				oc_ui_label(game->statistics_strings[i]);
+			}
+
+			oc_ui_style_next(&(oc_ui_style){ .color = ui_context.theme->white }, OC_UI_STYLE_COLOR);
+			if(oc_ui_button("OK").clicked) {
+				swallow_ui_click(game);
+				set_state(game, game->restore_state);
+			}
+
+			oc_ui_box_end(); // Statistics
+		}
+	}
+}
+
+static void solitaire_menu(GameState *game) {
+	trace_begin(game, "solitaire_menu");
 	oc_ui_box *menu = NULL;
 
-	oc_ui_style style = { .font = game.font, .bgColor = game.menu_bg_color };
+	oc_ui_style style = { .font = game->font, .bgColor = game->menu_bg_color };
 	oc_ui_style_mask style_mask = OC_UI_STYLE_FONT | OC_UI_STYLE_BG_COLOR;
-	oc_ui_frame(game.frame_size, &style, style_mask) 
+	oc_ui_frame(game->frame_size, &style, style_mask) 
 	{
 		oc_ui_menu_bar("menu_bar") 
 		{
@@ -1518,35 +2146,68 @@ static void solitaire_menu(void) {
 				f32 button_width = 185;
 				menu = oc_ui_box_top();
 
-				if (oc_ui_menu_button_fixed_width("New Game", button_width).pressed) {
-					game_reset();
+				if (solitaire_menu_button(game, "New Game", button_width)) {
+					game_reset(game);
 				}
 
-				if (oc_ui_menu_button_fixed_width("Undo", button_width).pressed) {
-					if (game.state == STATE_PLAY) {
-						undo_move();
+				if (solitaire_menu_button(game, "Undo", button_width)) {
+					if (game->state == STATE_PLAY) {
+						history_resume(game);
+						undo_move(game);
 					}
 				}
 
 				{ // game mode buttons: draw 1 or 3
-					const char *game_mode_text = game.draw_three_mode 
+					const char *game_mode_text = game->draw_three_mode 
 						? "Switch Game Mode: Turn 1"
 						: "Switch Game Mode: Turn 3";
-					if (oc_ui_menu_button_fixed_width(game_mode_text, button_width).pressed) {
-						game.draw_three_mode = !game.draw_three_mode;
-						game_reset();
+					if (solitaire_menu_button(game, game_mode_text, button_width)) {
+						game->draw_three_mode = !game->draw_three_mode;
+						game_reset(game);
+					}
+				}
+
+				{ // deal filter: any, solvable, easy, medium, hard
+					if (solitaire_menu_button(game, deal_filter_names[game->deal_filter], button_width)) {
+						game->deal_filter = (game->deal_filter + 1) % DEAL_FILTER_COUNT;
+						game_reset(game);
+					}
+				}
+
+				{
+					if (solitaire_menu_button(game, animation_speed_names[game->animation_speed], button_width)) {
+						set_animation_speed(game, (game->animation_speed + 1) % ANIMATION_SPEED_COUNT);
+					}
+				}
+
+				{
+					const char *prediction_text = game->drag_prediction > 0
+						? "Drag Prediction: On"
+						: "Drag Prediction: Off";
+					if (solitaire_menu_button(game, prediction_text, button_width)) {
+						game->drag_prediction = game->drag_prediction > 0 ? 0 : DRAG_PREDICTION_HORIZON;
 					}
 				}
 				
-				if (oc_ui_menu_button_fixed_width("How to Play", button_width).pressed) {
-					set_restore_state();
-					game.state = STATE_SHOW_RULES;
-					game.mouse_input.left.down = false;
+				if (solitaire_menu_button(game, "Export Game", button_width)) {
+					notation_export_to_file(game);
 				}
-				if (oc_ui_menu_button_fixed_width("Select Card Back", button_width).pressed) {
-					set_restore_state();
-					game.state = STATE_SELECT_CARD_BACK;
-					game.mouse_input.left.down = false;
+				if (solitaire_menu_button(game, "Import Game", button_width)) {
+					notation_import_from_file(game);
+				}
+
+				if (solitaire_menu_button(game, "How to Play", button_width)) {
+					set_restore_state(game);
+					set_state(game, STATE_SHOW_RULES);
+				}
+				if (solitaire_menu_button(game, "Select Card Back", button_width)) {
+					set_restore_state(game);
+					set_state(game, STATE_SELECT_CARD_BACK);
+				}
+				if (solitaire_menu_button(game, "Statistics", button_width)) {
+					set_restore_state(game);
+					update_statistics_strings(game);
+					set_state(game, STATE_SHOW_STATISTICS);
 				}
 				oc_ui_menu_end();
 			}
@@ -1564,7 +2225,7 @@ static void solitaire_menu(void) {
 				| OC_UI_STYLE_LAYOUT_ALIGN_Y);
 			oc_ui_container("menu bar middle", OC_UI_FLAG_NONE)
 			{
-				oc_ui_label(game.highscore_string);
+				oc_ui_label(game->highscore_string);
 			}
 
 			// Score and Timer
@@ -1583,36 +2244,83 @@ static void solitaire_menu(void) {
 			oc_ui_container("menu bar right", OC_UI_FLAG_NONE)
 			{
 				oc_ui_style_next(&(oc_ui_style){ .layout.margin.x = 15 }, OC_UI_STYLE_LAYOUT_MARGIN_X);
-				oc_ui_label(game.score_string);
+				oc_ui_label(game->score_string);
 
 				oc_ui_style_next(&(oc_ui_style){ .layout.margin.x = 15 }, OC_UI_STYLE_LAYOUT_MARGIN_X);
-				oc_ui_label(game.moves_string);
+				oc_ui_label(game->moves_string);
 
 				oc_ui_style_next(&(oc_ui_style){ .layout.margin.x = 15 }, OC_UI_STYLE_LAYOUT_MARGIN_X);
-				oc_ui_label(game.timer_string);
+				oc_ui_label(game->timer_string);
 			}
 		}
 
-		if (game.state == STATE_SELECT_CARD_BACK) {
-			do_card_back_menu();
+		if (game->state == STATE_SELECT_CARD_BACK) {
+			do_card_back_menu(game);
+		} else if (game->state == STATE_SHOW_STATISTICS) {
+			do_statistics_menu(game);
 		}
 	}
 
 	assert(menu);
-	game.menu_opened = !oc_ui_box_closed(menu);
+	game->menu_opened = !oc_ui_box_closed(menu);
+	trace_end(game, "solitaire_menu");
+}
+
+// sets up a board with nothing dealt yet, laid out for the default window.
+// images, fonts and the ui are only set up for orca_game, see oc_on_init
+static void game_init(GameState *game, u64 seed) {
+	pcg32_seed(&game->rng, seed);
+	game->draw_three_mode = true;
+
+	game->timer = 0;
+	update_timer_string(game, game->timer);
+
+	update_moves_string(game);
+
+	UpdateScoreParams params = { .kind = SCORE_RESET };
+	update_score(game, params);
+
+	set_sizes_based_on_viewport(game, GAME_DEFAULT_WIDTH, GAME_DEFAULT_HEIGHT);
+
+	block_array_init(&game->undo_stack, &game->memory[MEM_UNDO_STACK], sizeof(UndoInfo), UNDO_STACK_BLOCK);
+	block_array_init(&game->win_card_path, &game->memory[MEM_WIN_CARD_PATH], sizeof(CardPath), WIN_CARD_PATH_BLOCK);
+	block_array_init(&game->telemetry_think_times, &game->memory[MEM_TELEMETRY], sizeof(f32), TELEMETRY_THINK_BLOCK);
+	block_array_init(&game->notation, &game->memory[MEM_NOTATION], sizeof(NotationMove), NOTATION_BLOCK);
+	block_array_init(&game->timeline.items, &game->memory[MEM_TIMELINE], sizeof(TimelineItem), TIMELINE_BLOCK);
+	block_array_init(&game->history.positions, &game->memory[MEM_HISTORY], sizeof(HistoryPosition), HISTORY_POSITION_BLOCK);
+	block_array_init(&game->history.changes, &game->memory[MEM_HISTORY], sizeof(HistoryChange), HISTORY_CHANGE_BLOCK);
+	block_array_init(&game->history.keyframes, &game->memory[MEM_HISTORY], sizeof(HistoryKeyframe), HISTORY_KEYFRAME_BLOCK);
+	block_array_init(&game->draw_record, &game->memory[MEM_DRAW_RECORD], sizeof(DrawCommand), DRAW_RECORD_BLOCK);
+	game->history.enabled = true;
+
+	game->stock.kind = PILE_STOCK;
+	game->waste.kind = PILE_WASTE;
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		game->foundations[i].kind = PILE_FOUNDATION;
+	}
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		game->tableau[i].kind = PILE_TABLEAU;
+	}
+
+	set_animation_speed(game, ANIMATION_NORMAL);
+
+	game->win_launch_interval = 0.25f;
+	game->win_max_flying = 6;
 }
 
+// the board the orca entry points play
+static GameState orca_game;
+
 ORCA_EXPORT void oc_on_init(void) {
+	GameState *game = &orca_game;
 	// initialize random number generator
 	f64 ftime = oc_clock_time(OC_CLOCK_MONOTONIC);
 	u64 time = *((u64*)&ftime);
-	pcg32_init(time);
+	game_init(game, time);
 
     oc_window_set_title(OC_STR8("Solitaire"));
-    game.surface = oc_surface_canvas();
-    game.canvas = oc_canvas_create();
-
-	game.draw_three_mode = true;
+    game->surface = oc_surface_canvas();
+    game->canvas = oc_canvas_create();
 
     oc_unicode_range ranges[5] = {
         OC_UNICODE_BASIC_LATIN,
@@ -1621,141 +2329,160 @@ ORCA_EXPORT void oc_on_init(void) {
         OC_UNICODE_LATIN_EXTENDED_B,
         OC_UNICODE_SPECIALS,
     };
-	game.font = oc_font_create_from_path(OC_STR8("segoeui.ttf"), 5, ranges);
+	game->font = oc_font_create_from_path(OC_STR8("segoeui.ttf"), 5, ranges);
 
-	game.bg_color = (oc_color){ 10.0f/255.0f, 31.0f/255.0f, 72.0f/255.0f, 1 };
-	game.menu_bg_color = (oc_color){ 12.0f/255.0f, 41.0f/255.0f, 80.0f/255.0f, 1 };
-	game.menu_card_backs_margin = 25;
+	game->bg_color = (oc_color){ 10.0f/255.0f, 31.0f/255.0f, 72.0f/255.0f, 1 };
+	game->menu_bg_color = (oc_color){ 12.0f/255.0f, 41.0f/255.0f, 80.0f/255.0f, 1 };
+	game->menu_card_backs_margin = 25;
 
-	game.timer = 0;
-	update_timer_string(game.timer);
+	game->interactive = true;
+	load_highscore(game);
 
-	update_moves_string();
+	oc_window_set_size((oc_vec2){ GAME_DEFAULT_WIDTH, GAME_DEFAULT_HEIGHT });
 
-	UpdateScoreParams params = { .kind = SCORE_RESET };
-	update_score(params);
-	load_highscore();
+	oc_ui_init(&ui_context);
 
-	oc_vec2 viewport_size = { 1000, 775 };
-	set_sizes_based_on_viewport(viewport_size.x, viewport_size.y);
-	oc_window_set_size(viewport_size);
+	game->telemetry_enabled = true;
 
-	oc_ui_init(&game.ui);
+	load_images(game);
+	update_empty_pile_images(game);
+	game->selected_card_back = 0;
 
-	load_images();
-	game.selected_card_back = 0;
+    game->last_timestamp = oc_clock_time(OC_CLOCK_MONOTONIC);
 
-	game.stock.kind = PILE_STOCK;
-	game.waste.kind = PILE_WASTE;
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		game.foundations[i].kind = PILE_FOUNDATION;
-	}
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		game.tableau[i].kind = PILE_TABLEAU;
-	}
-
-    game.last_timestamp = oc_clock_time(OC_CLOCK_DATE);
-
-	game.deal_countdown = 0;
-	game.deal_delay = 0.1;
-	game.deal_tableau_index = 0;
-	game.deal_tableau_remaining = ARRAY_COUNT(game.tableau);
-	game.deal_cards_remaining = 28; // 7+6+5+4+3+2+1
-
-	game.deal_speed = 10;
-	game.card_animate_speed = 25;
-	deal_klondike(game.cards, ARRAY_COUNT(game.cards));
+	deal_klondike(game, game->cards, ARRAY_COUNT(game->cards), pcg32_next(&game->rng));
 }
 
 ORCA_EXPORT void oc_on_resize(u32 width, u32 height) {
+	GameState *game = &orca_game;
 	oc_log_info("width=%lu height=%lu", width, height);
 
-	set_sizes_based_on_viewport(width, height);
+	set_sizes_based_on_viewport(game, width, height);
+	update_empty_pile_images(game);
+	game->static_layer_valid = false;
 
-	position_all_cards_on_pile(&game.stock, false);
-	position_all_cards_on_pile(&game.waste, false);
-	for (i32 i=0; i<ARRAY_COUNT(game.foundations); ++i) {
-		position_all_cards_on_pile(&game.foundations[i], false);
+	// moves planned for the old layout would end in the wrong places
+	if (game->timeline.sequence != SEQUENCE_WIN) {
+		timeline_fast_forward(game);
 	}
-	for (i32 i=0; i<ARRAY_COUNT(game.tableau); ++i) {
-		position_all_cards_on_pile(&game.tableau[i], false);
+
+	position_all_cards_on_pile(game, &game->stock, false);
+	position_all_cards_on_pile(game, &game->waste, false);
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		position_all_cards_on_pile(game, &game->foundations[i], false);
+	}
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		position_all_cards_on_pile(game, &game->tableau[i], false);
 	}
 }
 
-ORCA_EXPORT void oc_on_key_down(oc_scan_code scan, oc_key_code key) {
-	switch (key) {
-	case OC_KEY_R: game.input.r.down = true;    break;
-	case OC_KEY_U: game.input.u.down = true;    break;
-	case OC_KEY_1: game.input.num1.down = true; break;
-	case OC_KEY_2: game.input.num2.down = true; break;
-	case OC_KEY_3: game.input.num3.down = true; break;
-	case OC_KEY_4: game.input.num4.down = true; break;
-	case OC_KEY_5: game.input.num5.down = true; break;
-	case OC_KEY_6: game.input.num6.down = true; break;
-	case OC_KEY_7: game.input.num7.down = true; break;
-	case OC_KEY_8: game.input.num8.down = true; break;
-	case OC_KEY_9: game.input.num9.down = true; break;
-	case OC_KEY_0: game.input.num0.down = true; break;
-	default:
-		break;
-	}
+static void queue_input_event(GameState *game, InputEventKind kind, i32 code) {
+	InputEvent event = {
+		.time = oc_clock_time(OC_CLOCK_MONOTONIC),
+		.x = game->input_mouse_pos.x,
+		.y = game->input_mouse_pos.y,
+		.code = code,
+		.kind = kind,
+	};
+	input_queue_push(game, event);
+}
 
+ORCA_EXPORT void oc_on_key_down(oc_scan_code scan, oc_key_code key) {
+	GameState *game = &orca_game;
+	queue_input_event(game, INPUT_EVENT_KEY_DOWN, key);
 }
 
 ORCA_EXPORT void oc_on_key_up(oc_scan_code scan, oc_key_code key) {
-	switch (key) {
-	case OC_KEY_R: game.input.r.down = false;    break;
-	case OC_KEY_U: game.input.u.down = false;    break;
-	case OC_KEY_1: game.input.num1.down = false; break;
-	case OC_KEY_2: game.input.num2.down = false; break;
-	case OC_KEY_3: game.input.num3.down = false; break;
-	case OC_KEY_4: game.input.num4.down = false; break;
-	case OC_KEY_5: game.input.num5.down = false; break;
-	case OC_KEY_6: game.input.num6.down = false; break;
-	case OC_KEY_7: game.input.num7.down = false; break;
-	case OC_KEY_8: game.input.num8.down = false; break;
-	case OC_KEY_9: game.input.num9.down = false; break;
-	case OC_KEY_0: game.input.num0.down = false; break;
-	default:
-		break;
-	}
+	GameState *game = &orca_game;
+	queue_input_event(game, INPUT_EVENT_KEY_UP, key);
 }
 
 ORCA_EXPORT void oc_on_mouse_down(int button) {
-	if (button == OC_MOUSE_LEFT) {
-		game.mouse_input.left.down = true;
-	} else if (button == OC_MOUSE_RIGHT) {
-		game.mouse_input.right.down = true;
-	}
+	GameState *game = &orca_game;
+	queue_input_event(game, INPUT_EVENT_MOUSE_DOWN, button);
 }
 
 ORCA_EXPORT void oc_on_mouse_up(int button) {
-	if (button == OC_MOUSE_LEFT) {
-		game.mouse_input.left.down = false;
-	} else if (button == OC_MOUSE_RIGHT) {
-		game.mouse_input.right.down = false;
-	}
+	GameState *game = &orca_game;
+	queue_input_event(game, INPUT_EVENT_MOUSE_UP, button);
 }
 
 ORCA_EXPORT void oc_on_mouse_move(float x, float y, float dx, float dy) {
-    game.mouse_input.x = x;
-    game.mouse_input.y = y;
-    game.mouse_input.deltaX = dx;
-    game.mouse_input.deltaY = dy;
+	GameState *game = &orca_game;
+	f64 time = oc_clock_time(OC_CLOCK_MONOTONIC);
+	game->input_mouse_pos = (oc_vec2){ x, y };
+
+	f64 since_last_move = time - game->input_last_move_time;
+	game->input_last_move_time = time;
+	if (since_last_move > 0 && since_last_move < 0.1) {
+		game->drag_velocity.x = 0.5f * game->drag_velocity.x + 0.5f * (f32)(dx / since_last_move);
+		game->drag_velocity.y = 0.5f * game->drag_velocity.y + 0.5f * (f32)(dy / since_last_move);
+	} else {
+		game->drag_velocity = (oc_vec2){0};
+	}
+
+	// NOTE(shaw): the dragged stack follows the mouse right away instead of
+	// waiting for the next simulation step, which may not run before the next
+	// present. the queued event still goes through the usual handling
+	if (game->state == STATE_PLAY && game->card_dragging && !game->menu_opened) {
+		oc_vec2 pos = drag_display_pos(game, x, y);
+		move_dragged_cards_to(game, pos.x, pos.y);
+		latency_note_input(game, time);
+	}
+
+	InputEvent event = {
+		.time = time,
+		.x = x,
+		.y = y,
+		.dx = dx,
+		.dy = dy,
+		.kind = INPUT_EVENT_MOUSE_MOVE,
+	};
+	input_queue_push(game, event);
 }
 
 ORCA_EXPORT void oc_on_raw_event(oc_event* event) {
     oc_ui_process_event(event);
 }
 
-ORCA_EXPORT void oc_on_frame_refresh(void) {
-    f64 timestamp = oc_clock_time(OC_CLOCK_DATE);
-	game.dt = timestamp - game.last_timestamp;
-	game.last_timestamp = timestamp;
+// advances the game by exactly one SIM_STEP
+static void solitaire_simulate_step(GameState *game) {
+	game->dt = SIM_STEP;
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		game->cards[i].prev_pos = game->cards[i].pos;
+	}
+	solitaire_update(game);
+}
 
-	solitaire_menu();
-	solitaire_update();
-	solitaire_draw();
+// the simulation always advances in steps of SIM_STEP seconds, driven by the
+// monotonic clock. rendering happens once per frame and interpolates cards
+// between the last two simulation states using the leftover time.
+ORCA_EXPORT void oc_on_frame_refresh(void) {
+	GameState *game = &orca_game;
+	trace_begin(game, "oc_on_frame_refresh");
+    f64 timestamp = oc_clock_time(OC_CLOCK_MONOTONIC);
+	f64 frame_time = timestamp - game->last_timestamp;
+	game->last_timestamp = timestamp;
+	if (frame_time > SIM_MAX_FRAME_TIME) frame_time = SIM_MAX_FRAME_TIME;
+	if (frame_time < 0) frame_time = 0;
+	game->sim_accumulator += frame_time;
+
+	solitaire_menu(game);
+
+	i32 steps = 0;
+	while (game->sim_accumulator >= SIM_STEP && steps < SIM_MAX_STEPS_PER_FRAME) {
+		solitaire_simulate_step(game);
+		game->sim_accumulator -= SIM_STEP;
+		++steps;
+	}
+	// too far behind to catch up, drop the remainder instead of spiraling
+	if (steps == SIM_MAX_STEPS_PER_FRAME && game->sim_accumulator >= SIM_STEP) {
+		game->sim_accumulator = 0;
+	}
+	game->sim_alpha = (f32)(game->sim_accumulator / SIM_STEP);
+
+	solitaire_draw(game);
+	trace_end(game, "oc_on_frame_refresh");
 }
 
 
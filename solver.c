@@ -0,0 +1,546 @@
+//------------------------------------------------------------------------------
+// klondike solver
+//------------------------------------------------------------------------------
+// NOTE(shaw): depth first search over SolverState with a visited set. the
+// rules are the game's own: draw 1 or 3 with unlimited recycles, cards come
+// back off the foundations, and in turn 1 any card may go on an empty tableau
+// pile while turn 3 only takes kings there.
+//
+// a few moves are never branched on. a card goes to its foundation as soon as
+// nothing could still want to sit on it, and a run is only split when the card
+// it uncovers goes straight to a foundation. that keeps the tree small, every
+// move in a solution is still a legal game move so a win is always real, but
+// a loss only means none was found under those restrictions.
+
+#define SOLVER_PILE_STOCK 0
+#define SOLVER_PILE_WASTE 1
+#define SOLVER_PILE_FOUNDATION 2
+#define SOLVER_PILE_TABLEAU 6
+
+static inline u8 solver_card_suit(u8 card) { return card / CARD_KIND_COUNT; }
+static inline u8 solver_card_kind(u8 card) { return card % CARD_KIND_COUNT; }
+
+static inline bool solver_card_red(u8 card) {
+	u8 suit = solver_card_suit(card);
+	return suit == SUIT_DIAMOND || suit == SUIT_HEART;
+}
+
+static inline bool solver_fits_on(u8 card, u8 target) {
+	return solver_card_red(card) != solver_card_red(target) &&
+	       solver_card_kind(card) + 1 == solver_card_kind(target);
+}
+
+static inline bool solver_fits_foundation(SolverState *s, u8 card) {
+	return s->foundation[solver_card_suit(card)] == solver_card_kind(card);
+}
+
+static inline u8 solver_tableau_top(SolverState *s, i32 i) {
+	return s->tableau[i][s->tableau_count[i] - 1];
+}
+
+// the same shuffle and deal as deal_klondike, on a private random stream
+static void solver_deal(SolverState *s, u32 deal_number, bool draw_three) {
+	u8 cards[SUIT_COUNT * CARD_KIND_COUNT];
+	for (i32 i=0; i<ARRAY_COUNT(cards); ++i) {
+		cards[i] = (u8)i;
+	}
+
+	Pcg32 rng;
+	pcg32_seed(&rng, deal_number);
+	for (i32 i=ARRAY_COUNT(cards)-1; i > 0; --i) {
+		i32 j = (i32)(pcg32_next(&rng) % (u32)(i + 1));
+		u8 tmp = cards[i];
+		cards[i] = cards[j];
+		cards[j] = tmp;
+	}
+
+	memset(s, 0, sizeof(*s));
+	s->draw_three = draw_three;
+
+	// the stock is cards[0] at the bottom to cards[51] on top, dealing pops it
+	i32 top = ARRAY_COUNT(cards) - 1;
+	for (i32 row=0; row < 7; ++row)
+	for (i32 i=row; i < 7; ++i) {
+		s->tableau[i][s->tableau_count[i]++] = cards[top--];
+	}
+	for (i32 i=0; i<7; ++i) {
+		s->tableau_hidden[i] = (u8)i;
+	}
+
+	s->talon_count = (u8)(top + 1);
+	for (i32 i=0; i<s->talon_count; ++i) {
+		s->talon[i] = cards[top - i];
+	}
+}
+
+static bool solver_is_won(SolverState *s) {
+	return s->foundation[0] + s->foundation[1] + s->foundation[2] + s->foundation[3] == SUIT_COUNT * CARD_KIND_COUNT;
+}
+
+// the talon is waste then stock: talon[waste_count-1] is the top of the waste
+// and talon[waste_count] the top of the stock, so drawing only moves the split
+// and recycling the waste sets it back to zero
+static void solver_apply(SolverState *s, SolverMove move) {
+	if (move.from == SOLVER_PILE_STOCK) {
+		i32 waste_count = s->waste_count + (s->draw_three ? 3 : 1);
+		s->waste_count = (u8)(waste_count < s->talon_count ? waste_count : s->talon_count);
+		return;
+	}
+	if (move.to == SOLVER_PILE_STOCK) {
+		s->waste_count = 0;
+		return;
+	}
+
+	u8 moved[CARD_KIND_COUNT];
+	u8 count = move.count;
+	if (move.from == SOLVER_PILE_WASTE) {
+		moved[0] = s->talon[s->waste_count - 1];
+		memmove(&s->talon[s->waste_count - 1], &s->talon[s->waste_count], s->talon_count - s->waste_count);
+		--s->talon_count;
+		--s->waste_count;
+	} else if (move.from < SOLVER_PILE_TABLEAU) {
+		i32 suit = move.from - SOLVER_PILE_FOUNDATION;
+		moved[0] = (u8)(suit * CARD_KIND_COUNT + --s->foundation[suit]);
+	} else {
+		i32 i = move.from - SOLVER_PILE_TABLEAU;
+		s->tableau_count[i] -= count;
+		memcpy(moved, &s->tableau[i][s->tableau_count[i]], count);
+		if (s->tableau_hidden[i] > 0 && s->tableau_hidden[i] == s->tableau_count[i]) {
+			--s->tableau_hidden[i];
+		}
+	}
+
+	if (move.to < SOLVER_PILE_TABLEAU) {
+		++s->foundation[solver_card_suit(moved[0])];
+	} else {
+		i32 i = move.to - SOLVER_PILE_TABLEAU;
+		memcpy(&s->tableau[i][s->tableau_count[i]], moved, count);
+		s->tableau_count[i] += count;
+	}
+}
+
+// a card can go up for good once no card that could be put on it still needs
+// a home: both foundations of the other color hold the card below it and the
+// other foundation of its color isn't far behind
+static bool solver_is_safe_to_foundation(SolverState *s, u8 card) {
+	u8 kind = solver_card_kind(card);
+	if (kind <= CARD_ACE + 1) {
+		return true;
+	}
+	bool red = solver_card_red(card);
+	for (i32 suit=0; suit < SUIT_COUNT; ++suit) {
+		bool suit_red = suit == SUIT_DIAMOND || suit == SUIT_HEART;
+		if (suit == solver_card_suit(card)) continue;
+		u8 needed = suit_red == red ? kind - 1 : kind;
+		if (s->foundation[suit] < needed) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// plays safe foundation moves until there are none, appending them to path
+static void solver_apply_safe_moves(SolverState *s, SolverMove *path, u32 *path_length) {
+	for (bool moved = true; moved; ) {
+		moved = false;
+		if (s->waste_count > 0) {
+			u8 card = s->talon[s->waste_count - 1];
+			if (solver_fits_foundation(s, card) && solver_is_safe_to_foundation(s, card)) {
+				SolverMove move = { SOLVER_PILE_WASTE, SOLVER_PILE_FOUNDATION + solver_card_suit(card), 1 };
+				solver_apply(s, move);
+				if (*path_length < SOLVER_MAX_PATH) path[(*path_length)++] = move;
+				moved = true;
+			}
+		}
+		for (i32 i=0; i<7; ++i) {
+			if (s->tableau_count[i] == 0) continue;
+			u8 card = solver_tableau_top(s, i);
+			if (solver_fits_foundation(s, card) && solver_is_safe_to_foundation(s, card)) {
+				SolverMove move = { SOLVER_PILE_TABLEAU + i, SOLVER_PILE_FOUNDATION + solver_card_suit(card), 1 };
+				solver_apply(s, move);
+				if (*path_length < SOLVER_MAX_PATH) path[(*path_length)++] = move;
+				moved = true;
+			}
+		}
+	}
+}
+
+// with the talon gone and every tableau card face up the rest always plays
+// out: the lowest card left is on top of its pile and its foundation is ready
+static bool solver_is_trivially_won(SolverState *s) {
+	if (s->talon_count > 0) {
+		return false;
+	}
+	for (i32 i=0; i<7; ++i) {
+		if (s->tableau_hidden[i] > 0) return false;
+	}
+	return true;
+}
+
+static void solver_play_out(SolverState *s, SolverMove *path, u32 *path_length) {
+	while (!solver_is_won(s)) {
+		for (i32 i=0; i<7; ++i) {
+			if (s->tableau_count[i] == 0) continue;
+			u8 card = solver_tableau_top(s, i);
+			if (solver_fits_foundation(s, card)) {
+				SolverMove move = { SOLVER_PILE_TABLEAU + i, SOLVER_PILE_FOUNDATION + solver_card_suit(card), 1 };
+				solver_apply(s, move);
+				if (*path_length < SOLVER_MAX_PATH) path[(*path_length)++] = move;
+			}
+		}
+	}
+}
+
+static void solver_add_move(SolverFrame *frame, u8 from, u8 to, u8 count, u8 priority) {
+	if (frame->move_count < SOLVER_MAX_MOVES) {
+		frame->moves[frame->move_count++] = (SolverMove){ from, to, count, priority };
+	}
+}
+
+// all moves worth trying from frame->state, best first
+static void solver_generate_moves(SolverFrame *frame) {
+	SolverState *s = &frame->state;
+	frame->move_count = 0;
+	frame->next_move = 0;
+
+	i32 first_empty = -1;
+	for (i32 i=0; i<7; ++i) {
+		if (s->tableau_count[i] == 0) {
+			first_empty = i;
+			break;
+		}
+	}
+
+	// waste top
+	if (s->waste_count > 0) {
+		u8 card = s->talon[s->waste_count - 1];
+		if (solver_fits_foundation(s, card)) {
+			solver_add_move(frame, SOLVER_PILE_WASTE, SOLVER_PILE_FOUNDATION + solver_card_suit(card), 1, 6);
+		}
+		for (i32 j=0; j<7; ++j) {
+			if (s->tableau_count[j] > 0 && solver_fits_on(card, solver_tableau_top(s, j))) {
+				solver_add_move(frame, SOLVER_PILE_WASTE, SOLVER_PILE_TABLEAU + j, 1, 4);
+			}
+		}
+		if (first_empty >= 0 && (!s->draw_three || solver_card_kind(card) == CARD_KING)) {
+			solver_add_move(frame, SOLVER_PILE_WASTE, SOLVER_PILE_TABLEAU + first_empty, 1, 3);
+		}
+	}
+
+	for (i32 i=0; i<7; ++i) {
+		i32 count = s->tableau_count[i];
+		if (count == 0) continue;
+		u8 *pile = s->tableau[i];
+		i32 hidden = s->tableau_hidden[i];
+		u8 reveal_bonus = hidden > 0 ? 1 : 0;
+
+		// top card to its foundation
+		u8 top = pile[count - 1];
+		if (solver_fits_foundation(s, top)) {
+			bool reveals = count - 1 == hidden;
+			solver_add_move(frame, SOLVER_PILE_TABLEAU + i, SOLVER_PILE_FOUNDATION + solver_card_suit(top), 1, reveals ? 7 : 6);
+		}
+
+		// runs onto other piles, whole face up part or split just above a
+		// card that can then go to its foundation
+		for (i32 start=hidden; start < count; ++start) {
+			u8 card = pile[start];
+			u8 moved = (u8)(count - start);
+			bool whole = start == hidden;
+			if (!whole && !solver_fits_foundation(s, pile[start - 1])) {
+				continue;
+			}
+			for (i32 j=0; j<7; ++j) {
+				if (j == i || s->tableau_count[j] == 0) continue;
+				if (solver_fits_on(card, solver_tableau_top(s, j))) {
+					u8 priority = whole ? (u8)(4 + reveal_bonus) : 2;
+					solver_add_move(frame, SOLVER_PILE_TABLEAU + i, SOLVER_PILE_TABLEAU + j, moved, priority);
+				}
+			}
+			// a run already at the bottom of its pile gains nothing on an empty one
+			if (first_empty >= 0 && start > 0 && (!s->draw_three || solver_card_kind(card) == CARD_KING)) {
+				u8 priority = whole ? (u8)(3 + reveal_bonus) : 2;
+				solver_add_move(frame, SOLVER_PILE_TABLEAU + i, SOLVER_PILE_TABLEAU + first_empty, moved, priority);
+			}
+		}
+	}
+
+	// stock
+	if (s->waste_count < s->talon_count) {
+		solver_add_move(frame, SOLVER_PILE_STOCK, SOLVER_PILE_WASTE, 1, 1);
+	} else if (s->waste_count > 0) {
+		solver_add_move(frame, SOLVER_PILE_WASTE, SOLVER_PILE_STOCK, 0, 1);
+	}
+
+	// foundation tops back down
+	for (i32 suit=0; suit < SUIT_COUNT; ++suit) {
+		if (s->foundation[suit] < 2) continue;
+		u8 card = (u8)(suit * CARD_KIND_COUNT + s->foundation[suit] - 1);
+		for (i32 j=0; j<7; ++j) {
+			if (s->tableau_count[j] > 0 && solver_fits_on(card, solver_tableau_top(s, j))) {
+				solver_add_move(frame, SOLVER_PILE_FOUNDATION + suit, SOLVER_PILE_TABLEAU + j, 1, 0);
+			}
+		}
+	}
+
+	// stable insertion sort, highest priority first
+	for (i32 i=1; i<frame->move_count; ++i) {
+		SolverMove move = frame->moves[i];
+		i32 j = i;
+		while (j > 0 && frame->moves[j - 1].priority < move.priority) {
+			frame->moves[j] = frame->moves[j - 1];
+			--j;
+		}
+		frame->moves[j] = move;
+	}
+}
+
+static inline u64 solver_mix(u64 x) {
+	x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27; x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+// tableau piles are hashed on their own and summed, so boards that only
+// differ in which column holds which pile count as one
+static u64 solver_hash(SolverState *s) {
+	u64 hash = 0;
+	for (i32 i=0; i<7; ++i) {
+		u64 pile = 0x9e3779b97f4a7c15ull + s->tableau_hidden[i];
+		for (i32 k=0; k<s->tableau_count[i]; ++k) {
+			pile = (pile ^ s->tableau[i][k]) * 0x100000001b3ull;
+		}
+		hash += solver_mix(pile);
+	}
+	u64 talon = 0xcbf29ce484222325ull + s->waste_count;
+	for (i32 k=0; k<s->talon_count; ++k) {
+		talon = (talon ^ s->talon[k]) * 0x100000001b3ull;
+	}
+	hash += solver_mix(talon ^ ((u64)s->foundation[0] << 40 | (u64)s->foundation[1] << 48 | (u64)s->foundation[2] << 56)) +
+	        solver_mix((u64)s->foundation[3] + 0x51);
+	return hash | 1; // zero marks an empty slot
+}
+
+// NOTE(shaw): a visited state is marked dead once everything below it has
+// been searched. it is only dead for good if nothing below it was cut off for
+// being on the current path or dead only because of such a cut, then it can't
+// reach a win from anywhere and may go in the shared table other searches read
+#define SOLVER_IN_PROGRESS 1
+#define SOLVER_DEAD_ON_PATH 2
+#define SOLVER_DEAD 3
+#define SOLVER_STATUS_MASK 3ull
+#define SOLVER_NO_SLOT 0xffffffff
+#define SOLVER_SHARED_PROBES 16
+
+typedef enum {
+	SOLVER_VISIT_NEW,
+	SOLVER_VISIT_DEAD,    // seen and dead for good
+	SOLVER_VISIT_ON_PATH, // seen, but the answer depended on the path
+} SolverVisit;
+
+static bool solver_shared_contains(SolverSharedTable *shared, u64 key) {
+	u32 slot = (u32)(key >> 2) & shared->mask;
+	for (i32 probe=0; probe < SOLVER_SHARED_PROBES; ++probe) {
+		u64 entry = __atomic_load_n(&shared->slots[slot], __ATOMIC_RELAXED);
+		if (entry == key) return true;
+		if (entry == 0) return false;
+		slot = (slot + 1) & shared->mask;
+	}
+	return false;
+}
+
+// lock free, a full neighbourhood just drops the entry
+static void solver_shared_insert(SolverSharedTable *shared, u64 key) {
+	u32 slot = (u32)(key >> 2) & shared->mask;
+	for (i32 probe=0; probe < SOLVER_SHARED_PROBES; ++probe) {
+		u64 expected = 0;
+		if (__atomic_compare_exchange_n(&shared->slots[slot], &expected, key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ||
+		    expected == key)
+		{
+			return;
+		}
+		slot = (slot + 1) & shared->mask;
+	}
+}
+
+static SolverVisit solver_visit(Solver *solver, SolverState *s, u32 *slot_out) {
+	u64 key = solver_hash(s) & ~SOLVER_STATUS_MASK;
+	*slot_out = SOLVER_NO_SLOT;
+	if (solver->shared && solver_shared_contains(solver->shared, key | SOLVER_DEAD)) {
+		return SOLVER_VISIT_DEAD;
+	}
+
+	u32 slot = (u32)(key >> 2) & solver->table_mask;
+	while (solver->table[slot]) {
+		if ((solver->table[slot] & ~SOLVER_STATUS_MASK) == key) {
+			return (solver->table[slot] & SOLVER_STATUS_MASK) == SOLVER_DEAD ? SOLVER_VISIT_DEAD : SOLVER_VISIT_ON_PATH;
+		}
+		slot = (slot + 1) & solver->table_mask;
+	}
+	// past three quarters full the table stops remembering, the search is
+	// still correct but may revisit states
+	if (solver->table_count < solver->table_mask / 4 * 3) {
+		solver->table[slot] = key | SOLVER_IN_PROGRESS;
+		++solver->table_count;
+		*slot_out = slot;
+	}
+	return SOLVER_VISIT_NEW;
+}
+
+static void solver_init(Solver *solver, oc_arena *arena, u32 node_limit) {
+	memset(solver, 0, sizeof(*solver));
+	solver->node_limit = node_limit;
+	u32 table_size = 1024;
+	while (table_size < 2 * node_limit && table_size < (1u << 26)) {
+		table_size *= 2;
+	}
+	solver->table_mask = table_size - 1;
+	solver->table = oc_arena_push_array(arena, u64, table_size);
+	solver->frames = oc_arena_push_array(arena, SolverFrame, SOLVER_MAX_DEPTH);
+	solver->path = oc_arena_push_array(arena, SolverMove, SOLVER_MAX_PATH);
+	solver->bytes = table_size * sizeof(u64) + SOLVER_MAX_DEPTH * sizeof(SolverFrame) + SOLVER_MAX_PATH * sizeof(SolverMove);
+}
+
+static void solver_begin(Solver *solver, SolverState *start) {
+	memset(solver->table, 0, ((u64)solver->table_mask + 1) * sizeof(u64));
+	solver->table_count = 0;
+	solver->nodes = 0;
+	solver->max_depth = 0;
+	solver->hit_limit = false;
+	solver->path_length = 0;
+	solver->deadline = solver->time_limit > 0 ? oc_clock_time(OC_CLOCK_MONOTONIC) + solver->time_limit : 0;
+	solver->frames[0].state = *start;
+	solver->depth = 0;
+	solver->entering = true;
+}
+
+// searches from where solver_begin or the last call left off for up to
+// seconds, or to the end when seconds is zero. SOLVER_SEARCHING when the
+// time ran out first
+static SolverResult solver_continue(Solver *solver, f64 seconds) {
+	f64 deadline = solver->deadline;
+	f64 slice_deadline = seconds > 0 ? oc_clock_time(OC_CLOCK_MONOTONIC) + seconds : 0;
+	i32 depth = solver->depth;
+	bool entering = solver->entering;
+
+	for (u32 step=1;; ++step) {
+		if (slice_deadline > 0 && (step & 255) == 0 && oc_clock_time(OC_CLOCK_MONOTONIC) > slice_deadline) {
+			solver->depth = depth;
+			solver->entering = entering;
+			return SOLVER_SEARCHING;
+		}
+		SolverFrame *frame = &solver->frames[depth];
+		if (entering) {
+			entering = false;
+			solver_apply_safe_moves(&frame->state, solver->path, &solver->path_length);
+			frame->path_start = (u16)solver->path_length;
+			frame->on_path = false;
+			if (solver_is_trivially_won(&frame->state)) {
+				solver_play_out(&frame->state, solver->path, &solver->path_length);
+				return solver->path_length <= SOLVER_MAX_PATH ? SOLVER_WON : SOLVER_UNKNOWN;
+			}
+			SolverVisit visit = solver_visit(solver, &frame->state, &frame->table_slot);
+			if (visit != SOLVER_VISIT_NEW) {
+				frame->move_count = frame->next_move = 0;
+				frame->on_path = visit == SOLVER_VISIT_ON_PATH;
+			} else {
+				if ((solver->nodes & 255) == 0) {
+					bool out_of_time = deadline > 0 && oc_clock_time(OC_CLOCK_MONOTONIC) > deadline;
+					bool stopped = solver->should_stop && solver->should_stop(solver->user);
+					if (out_of_time || stopped) {
+						solver->hit_limit = true;
+						return SOLVER_UNKNOWN;
+					}
+				}
+				if (++solver->nodes >= solver->node_limit) {
+					solver->hit_limit = true;
+					return SOLVER_UNKNOWN;
+				}
+				solver_generate_moves(frame);
+			}
+		}
+
+		if (frame->next_move == frame->move_count || depth + 1 == SOLVER_MAX_DEPTH || solver->path_length + 1 >= SOLVER_MAX_PATH) {
+			if (frame->next_move < frame->move_count) {
+				solver->hit_limit = true;
+				frame->on_path = true; // not searched to the end, so not dead for good
+			}
+			if (frame->table_slot != SOLVER_NO_SLOT) {
+				u64 *entry = &solver->table[frame->table_slot];
+				u64 status = frame->on_path ? SOLVER_DEAD_ON_PATH : SOLVER_DEAD;
+				*entry = (*entry & ~SOLVER_STATUS_MASK) | status;
+				if (status == SOLVER_DEAD && solver->shared) {
+					solver_shared_insert(solver->shared, *entry);
+				}
+			}
+			if (depth == 0) {
+				return solver->hit_limit ? SOLVER_UNKNOWN : SOLVER_LOST;
+			}
+			--depth;
+			solver->frames[depth].on_path |= frame->on_path;
+			continue;
+		}
+
+		SolverMove move = frame->moves[frame->next_move++];
+		SolverFrame *next = &solver->frames[depth + 1];
+		next->state = frame->state;
+		solver_apply(&next->state, move);
+		solver->path_length = frame->path_start;
+		solver->path[solver->path_length++] = move;
+		++depth;
+		if ((u32)depth > solver->max_depth) solver->max_depth = (u32)depth;
+		entering = true;
+	}
+}
+
+static SolverResult solver_solve(Solver *solver, SolverState *start) {
+	solver_begin(solver, start);
+	return solver_continue(solver, 0);
+}
+
+//------------------------------------------------------------------------------
+// game board glue
+//------------------------------------------------------------------------------
+static void solver_from_game(GameState *game, SolverState *s) {
+	memset(s, 0, sizeof(*s));
+	s->draw_three = game->draw_three_mode;
+
+	for (i32 i=0; i<ARRAY_COUNT(game->tableau); ++i) {
+		oc_list_for_reverse(game->tableau[i].cards, card, Card, node) {
+			s->tableau[i][s->tableau_count[i]++] = card->suit * CARD_KIND_COUNT + card->kind;
+			s->tableau_hidden[i] += !card->face_up;
+		}
+	}
+
+	oc_list_for_reverse(game->waste.cards, card, Card, node) {
+		s->talon[s->talon_count++] = card->suit * CARD_KIND_COUNT + card->kind;
+	}
+	s->waste_count = s->talon_count;
+	oc_list_for(game->stock.cards, card, Card, node) {
+		s->talon[s->talon_count++] = card->suit * CARD_KIND_COUNT + card->kind;
+	}
+
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		Card *top = oc_list_first_entry(game->foundations[i].cards, Card, node);
+		if (top) {
+			s->foundation[top->suit] = top->kind + 1;
+		}
+	}
+}
+
+// the game foundation a solver foundation move means: the one holding the
+// suit, or for an ace the first empty one
+static Pile *solver_game_foundation(GameState *game, u8 suit) {
+	Pile *empty = NULL;
+	for (i32 i=0; i<ARRAY_COUNT(game->foundations); ++i) {
+		Card *top = oc_list_first_entry(game->foundations[i].cards, Card, node);
+		if (top && top->suit == suit) {
+			return &game->foundations[i];
+		}
+		if (!top && !empty) {
+			empty = &game->foundations[i];
+		}
+	}
+	return empty;
+}
@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+// per game telemetry
+//------------------------------------------------------------------------------
+// NOTE(shaw): the log is columnar, every TelemetryRecord field is appended to
+// its own file of fixed width values. aggregates only read the columns they
+// need straight into typed arrays, so a scan over thousands of games touches a
+// few bytes per game and never parses a record. per move think times are
+// variable length, they go to their own column and records point into it.
+
+typedef struct {
+	const char *path;
+	u32 offset;
+	u32 size;
+} TelemetryColumn;
+
+#define TELEMETRY_COLUMN(id, name, field) \
+	[id] = { "telemetry_" name ".col", offsetof(TelemetryRecord, field), sizeof(((TelemetryRecord*)0)->field) }
+
+static TelemetryColumn telemetry_columns[TELEMETRY_COLUMN_COUNT] = {
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_DEAL,            "deal",            deal_number),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_DRAW_THREE,      "draw_three",      draw_three),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_OUTCOME,         "outcome",         outcome),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_MOVE_COUNT,      "move_count",      move_count),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_UNDO_COUNT,      "undo_count",      undo_count),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_THINK_COUNT,     "think_count",     think_count),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_SCORE,           "score",           score),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_TIME,            "time",            time),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_FIRST_MOVE_TIME, "first_move_time", first_move_time),
+	TELEMETRY_COLUMN(TELEMETRY_COLUMN_THINK_OFFSET,    "think_offset",    think_offset),
+};
+
+static const char *telemetry_think_path = "telemetry_think.col";
+
+static u64 telemetry_file_size(const char *path) {
+	oc_file file = oc_file_open(OC_STR8(path), OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		return 0;
+	}
+	u64 size = oc_file_size(file);
+	oc_file_close(file);
+	return size;
+}
+
+static bool telemetry_append(const char *path, void *data, u64 size) {
+	oc_file file = oc_file_open(OC_STR8(path), OC_FILE_ACCESS_WRITE, OC_FILE_OPEN_APPEND | OC_FILE_OPEN_CREATE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_error("Could not open file %s\n", path);
+		return false;
+	}
+	u64 bytes_written = oc_file_write(file, size, (char*)data);
+	oc_file_close(file);
+	return bytes_written == size;
+}
+
+// a crash between column appends can leave columns of different lengths, the
+// shortest one decides how many complete records there are
+static u32 telemetry_record_count(void) {
+	u64 count = UINT32_MAX;
+	for (i32 i=0; i<TELEMETRY_COLUMN_COUNT; ++i) {
+		u64 column_count = telemetry_file_size(telemetry_columns[i].path) / telemetry_columns[i].size;
+		if (column_count < count) count = column_count;
+	}
+	return (u32)count;
+}
+
+static void telemetry_note_move(GameState *game) {
+	f32 think_time = (f32)(game->timer - game->telemetry_last_move_time);
+	if (!game->telemetry_game_open) {
+		game->telemetry_game_open = true;
+		game->telemetry_first_move_time = think_time;
+	}
+	game->telemetry_last_move_time = game->timer;
+
+	// past the cap moves are still counted, only their think times are dropped
+	f32 *slot = block_array_push(&game->telemetry_think_times);
+	if (slot) *slot = think_time;
+}
+
+static void telemetry_finish_game(GameState *game, TelemetryOutcome outcome) {
+	if (!game->telemetry_game_open) {
+		return;
+	}
+	game->telemetry_game_open = false;
+
+	if (game->telemetry_enabled) {
+		BlockArray *think = &game->telemetry_think_times;
+		TelemetryRecord record = {
+			.deal_number = game->deal_number,
+			.draw_three = game->draw_three_mode,
+			.outcome = outcome,
+			.move_count = (u16)game->move_count,
+			.undo_count = (u16)game->undo_count,
+			.think_count = (u16)think->count,
+			.score = game->score,
+			.time = (f32)game->timer,
+			.first_move_time = game->telemetry_first_move_time,
+			.think_offset = (u32)(telemetry_file_size(telemetry_think_path) / sizeof(f32)),
+		};
+
+		for (i32 block=0, first=0; first < think->count; ++block, first += think->block_items) {
+			i32 count = think->count - first;
+			if (count > (i32)think->block_items) count = think->block_items;
+			telemetry_append(telemetry_think_path, think->blocks[block], count * sizeof(f32));
+		}
+		for (i32 i=0; i<TELEMETRY_COLUMN_COUNT; ++i) {
+			TelemetryColumn *column = &telemetry_columns[i];
+			if (!telemetry_append(column->path, (u8*)&record + column->offset, column->size)) {
+				oc_log_error("Failed to append to %s\n", column->path);
+			}
+		}
+	}
+
+	block_array_release(&game->telemetry_think_times);
+}
+
+typedef struct {
+	u32 games;
+	u32 wins;
+	f32 median_win_time;
+	u64 moves;
+	u64 undos;
+	u32 games_with_undo;
+} TelemetryStats;
+
+static oc_file telemetry_open_column(TelemetryColumnId id) {
+	return oc_file_open(OC_STR8(telemetry_columns[id].path), OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+}
+
+// one pass over the outcome, time, move and undo columns, a chunk of each at a
+// time. the median comes from a histogram of whole seconds so no times are kept
+static TelemetryStats telemetry_compute_stats(void) {
+	TelemetryStats stats = {0};
+	u32 count = telemetry_record_count();
+	if (count == 0) {
+		return stats;
+	}
+
+	oc_file outcome_file = telemetry_open_column(TELEMETRY_COLUMN_OUTCOME);
+	oc_file time_file = telemetry_open_column(TELEMETRY_COLUMN_TIME);
+	oc_file moves_file = telemetry_open_column(TELEMETRY_COLUMN_MOVE_COUNT);
+	oc_file undos_file = telemetry_open_column(TELEMETRY_COLUMN_UNDO_COUNT);
+
+	oc_arena_scope scratch = oc_scratch_begin();
+	u32 *histogram = oc_arena_push_array(scratch.arena, u32, TELEMETRY_MEDIAN_MAX_SECONDS + 1);
+	memset(histogram, 0, (TELEMETRY_MEDIAN_MAX_SECONDS + 1) * sizeof(u32));
+	u8 *outcomes = oc_arena_push_array(scratch.arena, u8, TELEMETRY_SCAN_CHUNK);
+	f32 *times = oc_arena_push_array(scratch.arena, f32, TELEMETRY_SCAN_CHUNK);
+	u16 *moves = oc_arena_push_array(scratch.arena, u16, TELEMETRY_SCAN_CHUNK);
+	u16 *undos = oc_arena_push_array(scratch.arena, u16, TELEMETRY_SCAN_CHUNK);
+
+	for (u32 first=0; first < count; first += TELEMETRY_SCAN_CHUNK) {
+		u32 n = count - first;
+		if (n > TELEMETRY_SCAN_CHUNK) n = TELEMETRY_SCAN_CHUNK;
+		oc_file_read(outcome_file, n * sizeof(u8), (char*)outcomes);
+		oc_file_read(time_file, n * sizeof(f32), (char*)times);
+		oc_file_read(moves_file, n * sizeof(u16), (char*)moves);
+		oc_file_read(undos_file, n * sizeof(u16), (char*)undos);
+
+		for (u32 i=0; i<n; ++i) {
+			stats.moves += moves[i];
+			stats.undos += undos[i];
+			stats.games_with_undo += undos[i] > 0;
+			if (outcomes[i] == TELEMETRY_WON) {
+				u32 seconds = times[i] > 0 ? (u32)times[i] : 0;
+				if (seconds > TELEMETRY_MEDIAN_MAX_SECONDS) seconds = TELEMETRY_MEDIAN_MAX_SECONDS;
+				++histogram[seconds];
+				++stats.wins;
+			}
+		}
+	}
+	stats.games = count;
+
+	if (stats.wins > 0) {
+		u32 seen = 0;
+		for (u32 seconds=0; seconds <= TELEMETRY_MEDIAN_MAX_SECONDS; ++seconds) {
+			seen += histogram[seconds];
+			if (2 * seen >= stats.wins) {
+				stats.median_win_time = (f32)seconds;
+				break;
+			}
+		}
+	}
+
+	oc_scratch_end(scratch);
+	oc_file_close(outcome_file);
+	oc_file_close(time_file);
+	oc_file_close(moves_file);
+	oc_file_close(undos_file);
+	return stats;
+}
+
+static void update_statistics_strings(GameState *game) {
+	TelemetryStats stats = telemetry_compute_stats();
+	f32 win_rate = stats.games ? 100.0f * stats.wins / stats.games : 0;
+	f32 undo_rate = stats.moves ? 100.0f * (f32)stats.undos / (f32)stats.moves : 0;
+	u32 median = (u32)stats.median_win_time;
+
+	snprintf(game->statistics_strings[0], sizeof(game->statistics_strings[0]), "Games Played: %u", stats.games);
+	snprintf(game->statistics_strings[1], sizeof(game->statistics_strings[1]), "Win Rate: %.1f%%", win_rate);
+	snprintf(game->statistics_strings[2], sizeof(game->statistics_strings[2]), "Median Win Time: %02u:%02u", median / 60, median % 60);
+	snprintf(game->statistics_strings[3], sizeof(game->statistics_strings[3]), "Undos per 100 Moves: %.1f", undo_rate);
+	snprintf(game->statistics_strings[4], sizeof(game->statistics_strings[4]), "Games with an Undo: %u", stats.games_with_undo);
+}
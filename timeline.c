@@ -0,0 +1,199 @@
+//------------------------------------------------------------------------------
+// timeline: planned card animations
+//------------------------------------------------------------------------------
+// NOTE(shaw): dealing, autocomplete and the win animation are each planned
+// once, up front, as a list of timed items in order of start. planning plays
+// the game logic straight through (cards are dealt, autocomplete moves are
+// made and scored) and records where every card ends up after each step, so
+// the timeline only carries the cards there over time. timeline_update runs
+// every started item in one pass a step and timeline_fast_forward jumps to
+// the end in one pass over the items.
+//
+// a move takes the card from wherever it is when it starts, so moves of one
+// card can overlap: a later move takes over from the earlier one mid flight.
+
+static void pile_bump_version(GameState *game, Pile *pile);
+static Card *pile_pop(GameState *game, Pile *pile);
+static Card *pile_peek_top(Pile *pile);
+static void win_launch_card(GameState *game, Card *card, oc_vec2 velocity);
+static void win_retire_card(GameState *game, Card *card);
+
+static f32 ease(Ease ease, f32 t) {
+	switch (ease) {
+	case EASE_OUT_CUBIC: {
+		f32 u = 1 - t;
+		return 1 - u*u*u;
+	}
+	case EASE_IN_OUT_CUBIC: {
+		f32 u = 1 - t;
+		return t < 0.5f ? 4*t*t*t : 1 - 4*u*u*u;
+	}
+	default:
+		return t;
+	}
+}
+
+static void timeline_clear(GameState *game, TimelineSequence sequence) {
+	Timeline *timeline = &game->timeline;
+	timeline->sequence = sequence;
+	timeline->items.count = 0;
+	timeline->first_running = 0;
+	timeline->next_start = 0;
+	timeline->time = 0;
+	timeline->end_time = 0;
+	for (i32 i=0; i<ARRAY_COUNT(timeline->card_move); ++i) {
+		timeline->card_move[i] = -1;
+	}
+}
+
+static TimelineItem *timeline_push(GameState *game, TimelineItemKind kind, Card *card, f32 start, f32 duration, Ease ease) {
+	Timeline *timeline = &game->timeline;
+	assert(timeline->items.count == 0 || start >= ((TimelineItem*)block_array_get(&timeline->items, timeline->items.count - 1))->start);
+	TimelineItem *item = block_array_push(&timeline->items);
+	assert(item);
+	*item = (TimelineItem){
+		.start = start,
+		.duration = duration,
+		.kind = kind,
+		.ease = ease,
+		.card = (u8)(card - game->cards),
+	};
+	if (start + duration > timeline->end_time) {
+		timeline->end_time = start + duration;
+	}
+	return item;
+}
+
+//------------------------------------------------------------------------------
+// planning
+//------------------------------------------------------------------------------
+// cards are where they are drawn when planning begins. between steps the
+// caller moves cards with instant false, which only sets target_pos, then
+// timeline_plan_step turns every change since the last step into items
+static void timeline_plan_begin(GameState *game, TimelinePlan *plan) {
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		plan->pos[i] = game->cards[i].pos;
+		plan->face_up[i] = plan->start_face_up[i] = game->cards[i].face_up;
+	}
+}
+
+static void timeline_plan_step(GameState *game, TimelinePlan *plan, f32 start, f32 duration, Ease ease) {
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		Card *card = &game->cards[i];
+		if (card->face_up != plan->face_up[i]) {
+			TimelineItem *item = timeline_push(game, TIMELINE_FLIP, card, start, 0, EASE_LINEAR);
+			item->face_up = plan->face_up[i] = card->face_up;
+		}
+		if (card->target_pos.x != plan->pos[i].x || card->target_pos.y != plan->pos[i].y) {
+			TimelineItem *item = timeline_push(game, TIMELINE_MOVE, card, start, duration, ease);
+			item->to = plan->pos[i] = card->target_pos;
+		}
+	}
+}
+
+// the cards show the faces they had when planning began until their flips start
+static void timeline_plan_end(GameState *game, TimelinePlan *plan) {
+	for (i32 i=0; i<ARRAY_COUNT(game->cards); ++i) {
+		game->cards[i].face_up = plan->start_face_up[i];
+	}
+}
+
+//------------------------------------------------------------------------------
+// playing
+//------------------------------------------------------------------------------
+static void timeline_start_item(GameState *game, TimelineItem *item, i32 index) {
+	Card *card = &game->cards[item->card];
+	switch (item->kind) {
+	case TIMELINE_MOVE: {
+		i32 *latest = &game->timeline.card_move[item->card];
+		if (*latest >= 0) {
+			TimelineItem *earlier = block_array_get(&game->timeline.items, *latest);
+			earlier->done = true;
+		}
+		*latest = index;
+		item->from = card->pos;
+		break;
+	}
+	case TIMELINE_FLIP:
+		card->face_up = item->face_up;
+		if (card->pile) pile_bump_version(game, card->pile);
+		item->done = true;
+		break;
+	case TIMELINE_LAUNCH:
+		assert(card->pile && pile_peek_top(card->pile) == card);
+		pile_pop(game, card->pile);
+		win_launch_card(game, card, item->to);
+		break;
+	default:
+		assert(0);
+		break;
+	}
+}
+
+static void timeline_finish_item(GameState *game, TimelineItem *item) {
+	Card *card = &game->cards[item->card];
+	if (item->kind == TIMELINE_MOVE) {
+		card->pos = item->to;
+	} else if (item->kind == TIMELINE_LAUNCH) {
+		win_retire_card(game, card);
+	}
+	item->done = true;
+}
+
+// advances the timeline by dt, true once every item is done
+static bool timeline_update(GameState *game, f64 dt) {
+	Timeline *timeline = &game->timeline;
+	BlockArray *items = &timeline->items;
+	timeline->time += dt;
+	f64 now = timeline->time + TIMELINE_EPSILON;
+
+	// items run in order of start, so one that ends now is finished before
+	// one that starts now, and a move taking over a card starts from where
+	// the earlier move left it this step
+	for (i32 i=timeline->first_running; i<items->count; ++i) {
+		TimelineItem *item = block_array_get(items, i);
+		if (i == timeline->next_start) {
+			if (item->start > now) break;
+			timeline_start_item(game, item, i);
+			++timeline->next_start;
+		}
+		if (item->done) continue;
+		f32 t = item->duration > 0 ? (f32)((now - item->start) / item->duration) : 1;
+		if (t >= 1) {
+			timeline_finish_item(game, item);
+		} else if (item->kind == TIMELINE_MOVE) {
+			f32 e = ease(item->ease, t);
+			Card *card = &game->cards[item->card];
+			card->pos.x = item->from.x + (item->to.x - item->from.x) * e;
+			card->pos.y = item->from.y + (item->to.y - item->from.y) * e;
+		}
+	}
+
+	while (timeline->first_running < timeline->next_start &&
+	       ((TimelineItem*)block_array_get(items, timeline->first_running))->done)
+	{
+		++timeline->first_running;
+	}
+	return timeline->first_running == items->count;
+}
+
+// puts every card where the sequence leaves it
+static void timeline_fast_forward(GameState *game) {
+	Timeline *timeline = &game->timeline;
+	BlockArray *items = &timeline->items;
+	for (i32 i=timeline->first_running; i<items->count; ++i) {
+		TimelineItem *item = block_array_get(items, i);
+		if (i >= timeline->next_start) {
+			timeline_start_item(game, item, i);
+		}
+		if (!item->done) {
+			timeline_finish_item(game, item);
+			Card *card = &game->cards[item->card];
+			card->prev_pos = card->pos;
+		}
+	}
+	timeline->first_running = timeline->next_start = items->count;
+	if (timeline->time < timeline->end_time) {
+		timeline->time = timeline->end_time;
+	}
+}
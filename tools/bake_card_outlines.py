@@ -0,0 +1,171 @@
+"""
+Bakes the thin dark outline that used to be stroked around every card at
+draw time directly into the card art, so drawing a card is a single image
+draw. Works on the indexed PNGs in data/ without any third party modules:
+the outline is alpha blended over each pixel the way the old stroke was drawn
+over the card, keeping the pixel's own alpha, so transparent corners stay
+see-through and whatever the card overlaps still shows under them. Blended
+colours that aren't opaque get palette entries of their own where the palette
+has room, counting entries only the border used, every other colour maps to
+the closest palette entry by premultiplied RGBA. Images that were already
+baked carry a tEXt marker and are skipped.
+
+usage: python tools/bake_card_outlines.py [data_dir]
+"""
+import os
+import struct
+import sys
+import zlib
+
+CARD_W, CARD_H = 280, 390
+OUTLINE_RGBA = (0.1, 0.1, 0.1, 0.69)  # matches the old oc_rectangle_stroke color
+OUTLINE_PX = 3                         # ~1px once cards are scaled down on screen
+MARKER = b"solitaire\x00card outline baked"
+
+
+def read_png(path):
+    data = open(path, "rb").read()
+    assert data[:8] == b"\x89PNG\r\n\x1a\n", path
+    chunks, i = [], 8
+    while i < len(data):
+        n, kind = struct.unpack(">I4s", data[i:i + 8])
+        chunks.append((kind, data[i + 8:i + 8 + n]))
+        i += 12 + n
+    return chunks
+
+
+def chunk(kind, body):
+    crc = zlib.crc32(kind + body) & 0xffffffff
+    return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", crc)
+
+
+def unfilter(raw, w, h):
+    stride = w
+    rows, prev, i = [], bytearray(stride), 0
+    for _ in range(h):
+        f = raw[i]; i += 1
+        line = bytearray(raw[i:i + stride]); i += stride
+        for x in range(stride):
+            a = line[x - 1] if x else 0
+            b = prev[x]
+            c = prev[x - 1] if x else 0
+            if f == 1: line[x] = (line[x] + a) & 255
+            elif f == 2: line[x] = (line[x] + b) & 255
+            elif f == 3: line[x] = (line[x] + ((a + b) >> 1)) & 255
+            elif f == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pr = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[x] = (line[x] + pr) & 255
+        rows.append(line)
+        prev = line
+    return rows
+
+
+def bake(path):
+    chunks = read_png(path)
+    if any(k == b"tEXt" and body == MARKER for k, body in chunks):
+        print("skip (already baked)", path)
+        return
+    ihdr = next(body for k, body in chunks if k == b"IHDR")
+    w, h, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", ihdr)
+    assert depth == 8 and color_type == 3 and interlace == 0, path
+    plte = next(body for k, body in chunks if k == b"PLTE")
+    trns = next((body for k, body in chunks if k == b"tRNS"), b"")
+    palette = [tuple(plte[i:i + 3]) for i in range(0, len(plte), 3)]
+    alpha = [trns[i] if i < len(trns) else 255 for i in range(len(palette))]
+    rows = unfilter(zlib.decompress(b"".join(body for k, body in chunks if k == b"IDAT")), w, h)
+
+    def in_border(x, y):
+        x, y = x % CARD_W, y % CARD_H
+        return min(x, y, CARD_W - 1 - x, CARD_H - 1 - y) < OUTLINE_PX
+
+    # the outline drawn over an entry, straight alpha like the palette
+    ow = OUTLINE_RGBA[3]
+    def blend(idx):
+        a = alpha[idx] / 255
+        out_a = ow + a * (1 - ow)
+        rgb = tuple(int(round((OUTLINE_RGBA[c] * 255 * ow + palette[idx][c] * a * (1 - ow)) / out_a)) for c in range(3))
+        return rgb + (int(round(out_a * 255)),)
+
+    def premultiplied(rgba):
+        return tuple(rgba[c] * rgba[3] / 255 for c in range(3)) + (rgba[3],)
+
+    def distance(i, rgba):
+        p, q = premultiplied(palette[i] + (alpha[i],)), premultiplied(rgba)
+        return sum((p[c] - q[c]) ** 2 for c in range(4))
+
+    inside = set()
+    for y in range(h):
+        for x in range(w):
+            if not in_border(x, y):
+                inside.add(rows[y][x])
+    free = [i for i in range(256) if i not in inside]
+
+    targets = {}
+    for y in range(h):
+        for x in range(w):
+            if in_border(x, y):
+                idx = rows[y][x]
+                if idx not in targets:
+                    targets[idx] = blend(idx)
+
+    # an entry is free when no pixel uses it once the border is rewritten,
+    # so the opaque blends are matched first and keep theirs
+    mapping = {}
+    def nearest(rgba):
+        return min((i for i in range(len(palette)) if i in inside or i in mapping.values()),
+                   key=lambda i: distance(i, rgba))
+    for idx, rgba in targets.items():
+        if rgba[3] == 255:
+            mapping[idx] = nearest(rgba)
+    free = [i for i in free if i not in mapping.values()]
+    # the see-through blends with the worst match get the free entries
+    semi = sorted((idx for idx, rgba in targets.items() if rgba[3] < 255),
+                  key=lambda idx: -distance(nearest(targets[idx]), targets[idx]))
+    for idx in semi:
+        if free and distance(nearest(targets[idx]), targets[idx]) > 0:
+            slot = free.pop(0)
+            while slot >= len(palette):
+                palette.append((0, 0, 0))
+                alpha.append(255)
+            palette[slot], alpha[slot] = targets[idx][:3], targets[idx][3]
+            mapping[idx] = slot
+        else:
+            mapping[idx] = nearest(targets[idx])
+
+    for y in range(h):
+        for x in range(w):
+            if in_border(x, y):
+                rows[y][x] = mapping[rows[y][x]]
+
+    plte = b"".join(bytes(rgb) for rgb in palette)
+    last_see_through = max((i for i in range(len(palette)) if alpha[i] < 255), default=-1)
+    trns = bytes(alpha[:last_see_through + 1])
+
+    raw = b"".join(b"\x00" + bytes(r) for r in rows)
+    out = b"\x89PNG\r\n\x1a\n"
+    for k, body in chunks:
+        if k in (b"IDAT", b"tRNS"):
+            continue
+        if k == b"PLTE":
+            body = plte
+        out += chunk(k, body) if k != b"IEND" else b""
+        if k == b"PLTE" and trns:
+            out += chunk(b"tRNS", trns)
+    out += chunk(b"tEXt", MARKER)
+    out += chunk(b"IDAT", zlib.compress(raw, 9))
+    out += chunk(b"IEND", b"")
+    open(path, "wb").write(out)
+    print("baked", path)
+
+
+def main():
+    data_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "..", "data")
+    names = ["classic_13x4x280x390.png"] + ["Card-Back-%02d.png" % i for i in range(10)]
+    for name in names:
+        bake(os.path.join(data_dir, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------
+// trace: frame phases and game events for a trace viewer
+//------------------------------------------------------------------------------
+// NOTE(shaw): the T key starts recording and pressing it again writes
+// trace.json, which chrome://tracing or ui.perfetto.dev opens. events go into
+// a ring of TRACE_EVENT_MAX allocated the first time tracing starts, so
+// recording never allocates and a long session keeps its last few seconds.
+// event names are string literals and only their pointers are stored.
+//
+// with tracing off every trace call is one branch on game->trace.enabled.
+
+static void trace_push(GameState *game, TracePhase phase, const char *name, i32 value) {
+	Trace *trace = &game->trace;
+	TraceEvent *event = &trace->events[trace->count++ % TRACE_EVENT_MAX];
+	event->time = oc_clock_time(OC_CLOCK_MONOTONIC);
+	event->name = name;
+	event->value = value;
+	event->phase = (u8)phase;
+}
+
+static inline void trace_begin(GameState *game, const char *name) {
+	if (game->trace.enabled) trace_push(game, TRACE_BEGIN, name, 0);
+}
+
+static inline void trace_end(GameState *game, const char *name) {
+	if (game->trace.enabled) trace_push(game, TRACE_END, name, 0);
+}
+
+static inline void trace_instant(GameState *game, const char *name, i32 value) {
+	if (game->trace.enabled) trace_push(game, TRACE_INSTANT, name, value);
+}
+
+static void trace_start(GameState *game) {
+	Trace *trace = &game->trace;
+	if (!trace->events) {
+		oc_arena_init(&trace->arena);
+		trace->events = oc_arena_push_array(&trace->arena, TraceEvent, TRACE_EVENT_MAX);
+		mem_track(&game->memory[MEM_TRACE], TRACE_EVENT_MAX * sizeof(TraceEvent));
+	}
+	trace->count = 0;
+	trace->start_time = oc_clock_time(OC_CLOCK_MONOTONIC);
+	trace->enabled = true;
+	oc_log_info("tracing started\n");
+}
+
+typedef struct {
+	oc_file file;
+	char *buffer;
+	u64 used;
+	bool failed;
+} TraceWriter;
+
+static void trace_writer_flush(TraceWriter *writer) {
+	if (writer->used && oc_file_write(writer->file, writer->used, writer->buffer) != writer->used) {
+		writer->failed = true;
+	}
+	writer->used = 0;
+}
+
+// room for one event at the end of the buffer, flushing first if needed
+static char *trace_writer_reserve(TraceWriter *writer) {
+	if (TRACE_WRITE_CHUNK - writer->used < TRACE_EVENT_TEXT_MAX) {
+		trace_writer_flush(writer);
+	}
+	return writer->buffer + writer->used;
+}
+
+static void trace_write_event(TraceWriter *writer, Trace *trace, const char *name, char phase, f64 time, i32 value, bool first) {
+	char *at = trace_writer_reserve(writer);
+	f64 ts = (time - trace->start_time) * 1e6;
+	i32 len = phase == 'i'
+		? snprintf(at, TRACE_EVENT_TEXT_MAX, "%s\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"value\":%d}}",
+			first ? "" : ",", name, ts, value)
+		: snprintf(at, TRACE_EVENT_TEXT_MAX, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}",
+			first ? "" : ",", name, phase, ts);
+	if (len > 0) writer->used += len < TRACE_EVENT_TEXT_MAX ? len : TRACE_EVENT_TEXT_MAX - 1;
+}
+
+// writes the events in the ring as chrome trace event json. once the ring has
+// wrapped its oldest events can end spans that began before them, those ends
+// are dropped, and spans still open are closed at the time of the export
+static bool trace_export(GameState *game, const char *path) {
+	Trace *trace = &game->trace;
+	oc_file file = oc_file_open(OC_STR8(path), OC_FILE_ACCESS_WRITE, OC_FILE_OPEN_CREATE | OC_FILE_OPEN_TRUNCATE);
+	if (oc_file_last_error(file) != OC_IO_OK) {
+		oc_log_error("Could not open file %s\n", path);
+		return false;
+	}
+
+	oc_arena_scope scratch = oc_scratch_begin();
+	TraceWriter writer = { .file = file, .buffer = oc_arena_push_array(scratch.arena, char, TRACE_WRITE_CHUNK) };
+	writer.used = snprintf(writer.buffer, TRACE_WRITE_CHUNK, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	const char *open[TRACE_MAX_DEPTH];
+	i32 depth = 0;
+	bool first = true;
+	u64 oldest = trace->count > TRACE_EVENT_MAX ? trace->count - TRACE_EVENT_MAX : 0;
+	for (u64 i=oldest; i<trace->count; ++i) {
+		TraceEvent *event = &trace->events[i % TRACE_EVENT_MAX];
+		switch (event->phase) {
+		case TRACE_BEGIN:
+			if (depth < TRACE_MAX_DEPTH) open[depth] = event->name;
+			++depth;
+			trace_write_event(&writer, trace, event->name, 'B', event->time, 0, first);
+			break;
+		case TRACE_END:
+			if (depth == 0) continue;
+			--depth;
+			trace_write_event(&writer, trace, event->name, 'E', event->time, 0, first);
+			break;
+		case TRACE_INSTANT:
+			trace_write_event(&writer, trace, event->name, 'i', event->time, event->value, first);
+			break;
+		}
+		first = false;
+	}
+
+	f64 now = oc_clock_time(OC_CLOCK_MONOTONIC);
+	for (; depth > 0; --depth) {
+		const char *name = depth <= TRACE_MAX_DEPTH ? open[depth - 1] : "";
+		trace_write_event(&writer, trace, name, 'E', now, 0, first);
+		first = false;
+	}
+	char *end = trace_writer_reserve(&writer);
+	writer.used += snprintf(end, TRACE_EVENT_TEXT_MAX, "\n]}\n");
+	trace_writer_flush(&writer);
+
+	oc_scratch_end(scratch);
+	oc_file_close(file);
+	if (writer.failed) {
+		oc_log_error("Failed to write trace to %s\n", path);
+	}
+	return !writer.failed;
+}
+
+static void trace_stop(GameState *game, const char *path) {
+	Trace *trace = &game->trace;
+	if (!trace->enabled) return;
+	trace->enabled = false;
+	u64 kept = trace->count < TRACE_EVENT_MAX ? trace->count : TRACE_EVENT_MAX;
+	if (trace_export(game, path)) {
+		oc_log_info("wrote %llu of %llu trace events to %s\n", (unsigned long long)kept, (unsigned long long)trace->count, path);
+	}
+}
@@ -0,0 +1,93 @@
+// Batch verifier for game records.
+//
+// Builds natively against headless/orca.h like bench.c. Reads a file with one
+// record per line in the notation described in notation.c, replays each one
+// from its deal and writes one JSON object per record with the recomputed
+// score and whether the record was legal and its claimed score matched. The
+// time bonus of a won game is given on its own, it rests on the record's timer
+// and not on the moves, see notation.c.
+// Throughput goes to stderr.
+//
+// usage: verify records.txt [output.jsonl]
+
+#include "solitaire.c"
+
+static f64 verify_now(void) {
+	return oc_clock_time(OC_CLOCK_MONOTONIC);
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: verify records.txt [output.jsonl]\n");
+		return 1;
+	}
+	FILE *in = fopen(argv[1], "rb");
+	if (!in) {
+		fprintf(stderr, "could not open %s\n", argv[1]);
+		return 1;
+	}
+	FILE *out = stdout;
+	if (argc > 2) {
+		out = fopen(argv[2], "w");
+		if (!out) {
+			fprintf(stderr, "could not open %s\n", argv[2]);
+			return 1;
+		}
+	}
+
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char *text = malloc(size + 1);
+	size = (long)fread(text, 1, size, in);
+	text[size] = 0;
+	fclose(in);
+
+	headless.log_info = false;
+	oc_on_init();
+	GameState *game = &orca_game;
+	game->telemetry_enabled = false;
+	game->history.enabled = false;
+
+	u64 records = 0, rejected = 0, moves = 0;
+	f64 start = verify_now();
+	for (char *line = text, *end = text + size; line < end; ) {
+		char *line_end = memchr(line, '\n', end - line);
+		if (!line_end) line_end = end;
+		char *next = line_end + 1;
+		while (line_end > line && (line_end[-1] == '\r' || line_end[-1] == ' ')) --line_end;
+		if (line_end == line || *line == '#') {
+			line = next;
+			continue;
+		}
+
+		ReplayResult result = notation_replay(game, line, line_end - line);
+		fprintf(out, "{\"record\":%llu,\"ok\":%s,\"deal\":%u,\"score\":%d,\"moves\":%d,\"undos\":%d,\"won\":%s",
+			records, result.ok ? "true" : "false", game->deal_number, game->score,
+			game->move_count, game->undo_count, game->state == STATE_WIN ? "true" : "false");
+		if (game->state == STATE_WIN) {
+			fprintf(out, ",\"time_bonus\":%d", result.time_bonus);
+		}
+		if (result.has_claimed_score) {
+			fprintf(out, ",\"claimed_score\":%d", result.claimed_score);
+		}
+		if (!result.ok) {
+			fprintf(out, ",\"error\":\"%s\",\"token\":%d", result.error, result.error_token);
+		}
+		fprintf(out, "}\n");
+
+		++records;
+		rejected += !result.ok;
+		moves += game->move_count;
+		line = next;
+	}
+	f64 seconds = verify_now() - start;
+
+	fprintf(stderr, "%llu records, %llu rejected, %llu moves in %.3fs (%.0f records/s, %.0f moves/s)\n",
+		records, rejected, moves, seconds,
+		seconds > 0 ? records / seconds : 0, seconds > 0 ? moves / seconds : 0);
+
+	if (out != stdout) fclose(out);
+	free(text);
+	return rejected > 0;
+}